@@ -1,6 +1,7 @@
 #include "../src/meshoptimizer.h"
 
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
@@ -529,6 +530,33 @@ void simplifySloppy(const Mesh& mesh, float threshold = 0.2f)
 	    (end - start) * 1000);
 }
 
+void simplifyStream(const Mesh& mesh, float threshold = 0.2f)
+{
+	Mesh lod;
+
+	double start = timestamp();
+
+	size_t target_index_count = size_t(mesh.indices.size() * threshold);
+	float target_error = 1e-2f;
+	float result_error = 0;
+
+	// streaming simplification requires spatially coherent input; chunks are ~1/8 of the mesh to exercise multiple passes
+	lod.indices.resize(mesh.indices.size());
+	meshopt_spatialSortTriangles(&lod.indices[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex));
+
+	size_t chunk_index_count = (mesh.indices.size() / 8 + 2) / 3 * 3;
+
+	lod.indices.resize(meshopt_simplifyStream(&lod.indices[0], &lod.indices[0], lod.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), NULL, 0, NULL, 0, NULL, target_index_count, target_error, 0, chunk_index_count, &result_error));
+
+	double end = timestamp();
+
+	printf("%-9s: %d triangles => %d triangles (%.2f%% deviation) in %.2f msec\n",
+	    "SimplifyO",
+	    int(mesh.indices.size() / 3), int(lod.indices.size() / 3),
+	    result_error * 100,
+	    (end - start) * 1000);
+}
+
 void simplifyPoints(const Mesh& mesh, float threshold = 0.2f)
 {
 	double start = timestamp();
@@ -929,7 +957,7 @@ static int follow(int* parents, int index)
 	return index;
 }
 
-void meshlets(const Mesh& mesh, bool scan)
+void meshlets(const Mesh& mesh, bool scan, bool parallel = false)
 {
 	const size_t max_vertices = 64;
 	const size_t max_triangles = 124; // NVidia-recommended 126, rounded down to a multiple of 4
@@ -937,13 +965,15 @@ void meshlets(const Mesh& mesh, bool scan)
 
 	// note: input mesh is assumed to be optimized for vertex cache and vertex fetch
 	double start = timestamp();
-	size_t max_meshlets = meshopt_buildMeshletsBound(mesh.indices.size(), max_vertices, max_triangles);
+	size_t max_meshlets = parallel ? meshopt_buildMeshletsParallelBound(mesh.indices.size(), max_vertices, max_triangles) : meshopt_buildMeshletsBound(mesh.indices.size(), max_vertices, max_triangles);
 	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
 	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
 	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
 
 	if (scan)
 		meshlets.resize(meshopt_buildMeshletsScan(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), mesh.vertices.size(), max_vertices, max_triangles));
+	else if (parallel)
+		meshlets.resize(meshopt_buildMeshletsParallel(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, cone_weight, NULL, NULL));
 	else
 		meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, cone_weight));
 
@@ -1002,7 +1032,7 @@ void meshlets(const Mesh& mesh, bool scan)
 	avg_triangles /= double(meshlets.size());
 
 	printf("Meshlets%c: %d meshlets (avg vertices %.1f, avg triangles %.1f, not full %d, not connected %d) in %.2f msec\n",
-	    scan ? 'S' : ' ',
+	    scan ? 'S' : parallel ? 'P' : ' ',
 	    int(meshlets.size()), avg_vertices, avg_triangles, int(not_full), int(not_connected), (end - start) * 1000);
 
 	float camera[3] = {100, 100, 100};
@@ -1015,6 +1045,7 @@ void meshlets(const Mesh& mesh, bool scan)
 	size_t accepted_s8 = 0;
 
 	std::vector<float> radii(meshlets.size());
+	std::vector<meshopt_Bounds> meshlet_bounds(meshlets.size());
 
 	double startc = timestamp();
 	for (size_t i = 0; i < meshlets.size(); ++i)
@@ -1024,6 +1055,7 @@ void meshlets(const Mesh& mesh, bool scan)
 		meshopt_Bounds bounds = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset], m.triangle_count, &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex));
 
 		radii[i] = bounds.radius;
+		meshlet_bounds[i] = bounds;
 
 		// trivial accept: we can't ever backface cull this meshlet
 		accepted += (bounds.cone_cutoff >= 1);
@@ -1082,6 +1114,156 @@ void meshlets(const Mesh& mesh, bool scan)
 	    int(rejected_alt_s8), double(rejected_alt_s8) / double(meshlets.size()) * 100,
 	    int(accepted_s8), double(accepted_s8) / double(meshlets.size()) * 100,
 	    (endc - startc) * 1000);
+
+	std::vector<unsigned int> visible(meshlets.size());
+
+	double startv = timestamp();
+	size_t rejected_batch = meshlets.size() - meshopt_cullMeshlets(&visible[0], &meshlet_bounds[0], meshlet_bounds.size(), NULL, 0, camera, NULL);
+	double endv = timestamp();
+
+	printf("ConeCullB: rejected center %d (%.1f%%) in %.2f msec\n",
+	    int(rejected_batch), double(rejected_batch) / double(meshlets.size()) * 100,
+	    (endv - startv) * 1000);
+}
+
+void meshletsSpatial(const Mesh& mesh)
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 124;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(mesh.indices.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+	std::vector<float> meshlet_boxes(max_meshlets * 6);
+
+	double start = timestamp();
+	meshlets.resize(meshopt_buildMeshletsSpatial(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &meshlet_boxes[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles));
+	double end = timestamp();
+
+	double area = 0;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const float* b = &meshlet_boxes[i * 6];
+		area += 2 * ((b[3] - b[0]) * (b[4] - b[1]) + (b[4] - b[1]) * (b[5] - b[2]) + (b[5] - b[2]) * (b[3] - b[0]));
+	}
+
+	// compare against regular meshlets built without cone weighting
+	std::vector<meshopt_Meshlet> base(max_meshlets);
+	base.resize(meshopt_buildMeshlets(&base[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, 0.f));
+
+	double base_area = 0;
+
+	for (size_t i = 0; i < base.size(); ++i)
+	{
+		const meshopt_Meshlet& m = base[i];
+
+		float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+		{
+			const Vertex& v = mesh.vertices[meshlet_vertices[m.vertex_offset + j]];
+			float p[3] = {v.px, v.py, v.pz};
+
+			for (int k = 0; k < 3; ++k)
+			{
+				bmin[k] = p[k] < bmin[k] ? p[k] : bmin[k];
+				bmax[k] = p[k] > bmax[k] ? p[k] : bmax[k];
+			}
+		}
+
+		base_area += 2 * ((bmax[0] - bmin[0]) * (bmax[1] - bmin[1]) + (bmax[1] - bmin[1]) * (bmax[2] - bmin[2]) + (bmax[2] - bmin[2]) * (bmax[0] - bmin[0]));
+	}
+
+	printf("MeshletsB: %d meshlets, box area %.3f (%.1f%% of regular, %d meshlets) in %.2f msec\n",
+	    int(meshlets.size()), area, base_area == 0 ? 0.0 : area / base_area * 100, int(base.size()), (end - start) * 1000);
+}
+
+void meshletPages(const Mesh& mesh)
+{
+	const size_t max_vertices = 64;
+	const size_t max_triangles = 124;
+	const size_t page_size = 4096;
+	const int bits = 12;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(mesh.indices.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, 0.f));
+
+	size_t page_count = meshopt_packMeshletPagesBound(&meshlets[0], meshlets.size(), page_size, bits);
+	std::vector<unsigned char> pages(page_count * page_size);
+	std::vector<meshopt_MeshletPage> directory(page_count);
+
+	double start = timestamp();
+	meshopt_packMeshletPages(&pages[0], &directory[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), page_size, bits);
+	double end = timestamp();
+
+	// unpacked meshlets reference float3 positions through 32-bit vertex indices
+	size_t raw_size = meshlets.size() * sizeof(meshopt_Meshlet);
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+		raw_size += meshlets[i].vertex_count * (sizeof(unsigned int) + sizeof(float) * 3) + meshlets[i].triangle_count * 3;
+
+	printf("MeshletPg: %d meshlets in %d pages, %.1f KB (%.1f%% of unpacked) in %.2f msec\n",
+	    int(meshlets.size()), int(page_count), double(pages.size()) / 1024, double(pages.size()) / double(raw_size) * 100, (end - start) * 1000);
+}
+
+void bvh(const Mesh& mesh)
+{
+	const size_t max_leaf_size = 4;
+
+	size_t primitive_count = mesh.indices.size() / 3;
+
+	std::vector<meshopt_BvhNode> nodes(meshopt_buildBvhBound(primitive_count));
+	std::vector<unsigned int> primitive_indices(primitive_count);
+
+	double start = timestamp();
+	nodes.resize(meshopt_buildBvhTriangles(&nodes[0], &primitive_indices[0], &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_leaf_size, NULL, NULL));
+	double end = timestamp();
+
+	// SAH cost relative to the root box: each node costs one traversal step, and each leaf primitive costs one intersection
+	float rmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+	float rmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+	for (int j = 0; j < 4; ++j)
+		if (nodes[0].children[j] != ~0u)
+		{
+			float cmin[3] = {nodes[0].min_x[j], nodes[0].min_y[j], nodes[0].min_z[j]};
+			float cmax[3] = {nodes[0].max_x[j], nodes[0].max_y[j], nodes[0].max_z[j]};
+
+			for (int k = 0; k < 3; ++k)
+			{
+				rmin[k] = cmin[k] < rmin[k] ? cmin[k] : rmin[k];
+				rmax[k] = cmax[k] > rmax[k] ? cmax[k] : rmax[k];
+			}
+		}
+
+	double root_area = (rmax[0] - rmin[0]) * (rmax[1] - rmin[1]) + (rmax[1] - rmin[1]) * (rmax[2] - rmin[2]) + (rmax[2] - rmin[2]) * (rmax[0] - rmin[0]);
+	double cost = 0;
+	size_t leaves = 0;
+
+	for (size_t i = 0; i < nodes.size(); ++i)
+		for (int j = 0; j < 4; ++j)
+		{
+			const meshopt_BvhNode& node = nodes[i];
+
+			if (node.children[j] == ~0u)
+				continue;
+
+			float sx = node.max_x[j] - node.min_x[j], sy = node.max_y[j] - node.min_y[j], sz = node.max_z[j] - node.min_z[j];
+			double area = sx * sy + sy * sz + sz * sx;
+
+			cost += area * (node.counts[j] ? double(node.counts[j]) : 1.0);
+			leaves += node.counts[j] > 0;
+		}
+
+	printf("BVH      : %d nodes, %d leaves, SAH cost %.1f in %.2f msec\n",
+	    int(nodes.size()), int(leaves), root_area == 0 ? 0.0 : cost / root_area, (end - start) * 1000);
 }
 
 void spatialSort(const Mesh& mesh)
@@ -1203,6 +1385,37 @@ void provoking(const Mesh& mesh)
 	    int(mesh.indices.size() / 3), int(pcount), double(pcount) / double(bestv) * 100.0 - 100.0, (end - start) * 1000);
 }
 
+void clusterHierarchy(const Mesh& mesh)
+{
+	const size_t max_vertices = 192;
+	const size_t max_triangles = 128;
+
+	double start = timestamp();
+
+	size_t max_clusters = meshopt_buildClusterHierarchyBound(mesh.indices.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Cluster> clusters(max_clusters);
+	std::vector<unsigned int> cluster_indices(mesh.indices.size() * 20 / 3);
+	std::vector<meshopt_ClusterGroup> groups(max_clusters / 2);
+	std::vector<unsigned int> group_clusters(max_clusters);
+	size_t group_count = 0;
+
+	clusters.resize(meshopt_buildClusterHierarchy(&clusters[0], &cluster_indices[0], &groups[0], &group_clusters[0], &group_count, clusters.size(), cluster_indices.size(), &mesh.indices[0], mesh.indices.size(), &mesh.vertices[0].px, mesh.vertices.size(), sizeof(Vertex), max_vertices, max_triangles, NULL, NULL));
+
+	double end = timestamp();
+
+	unsigned int depth = 0;
+	size_t coarse_triangles = 0;
+
+	for (size_t i = 0; i < clusters.size(); ++i)
+	{
+		depth = std::max(depth, clusters[i].depth);
+		coarse_triangles += clusters[i].group == ~0u ? clusters[i].index_count / 3 : 0;
+	}
+
+	printf("Hierarchy: %d clusters, %d groups, %d levels, coarsest %d triangles in %.2f msec\n",
+	    int(clusters.size()), int(group_count), int(depth + 1), int(coarse_triangles), (end - start) * 1000);
+}
+
 void nanite(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices); // nanite.cpp
 
 bool loadMesh(Mesh& mesh, const char* path)
@@ -1353,7 +1566,11 @@ void process(const char* path)
 	stripify(copystrip, true, 'S');
 
 	meshlets(copy, false);
+	meshlets(copy, false, true);
 	meshlets(copy, true);
+	meshletsSpatial(copy);
+	meshletPages(copy);
+	bvh(copy);
 
 	shadow(copy);
 	tessellationAdjacency(copy);
@@ -1374,6 +1591,7 @@ void process(const char* path)
 	simplify(mesh);
 	simplifyAttr(mesh);
 	simplifySloppy(mesh);
+	simplifyStream(mesh);
 	simplifyComplete(mesh);
 	simplifyPoints(mesh);
 	simplifyClusters(mesh);
@@ -1401,6 +1619,7 @@ void processNanite(const char* path)
 		return;
 
 	nanite(mesh.vertices, mesh.indices);
+	clusterHierarchy(mesh);
 }
 
 int main(int argc, char** argv)
@@ -358,7 +358,7 @@ static std::vector<std::vector<int> > partitionMetis(const std::vector<Cluster>&
 }
 #endif
 
-static std::vector<std::vector<int> > partition(const std::vector<Cluster>& clusters, const std::vector<int>& pending)
+static std::vector<std::vector<int> > partition(const std::vector<Cluster>& clusters, const std::vector<int>& pending, size_t vertex_count)
 {
 #ifdef METIS
 	static const char* metis = getenv("METIS");
@@ -366,34 +366,34 @@ static std::vector<std::vector<int> > partition(const std::vector<Cluster>& clus
 		return partitionMetis(clusters, pending);
 #endif
 
-	std::vector<std::vector<int> > result;
-
-	size_t last_indices = 0;
+	std::vector<unsigned int> cluster_indices;
+	std::vector<unsigned int> cluster_counts(pending.size());
 
-	// rough merge; while clusters are approximately spatially ordered, this should use a proper partitioning algorithm
 	for (size_t i = 0; i < pending.size(); ++i)
 	{
-		if (result.empty() || last_indices + clusters[pending[i]].indices.size() > kClusterSize * 4 * 3)
-		{
-			result.push_back(std::vector<int>());
-			last_indices = 0;
-		}
-
-		result.back().push_back(pending[i]);
-		last_indices += clusters[pending[i]].indices.size();
+		cluster_indices.insert(cluster_indices.end(), clusters[pending[i]].indices.begin(), clusters[pending[i]].indices.end());
+		cluster_counts[i] = unsigned(clusters[pending[i]].indices.size());
 	}
 
+	std::vector<unsigned int> cluster_part(pending.size());
+	size_t partition_count = meshopt_partitionClusters(&cluster_part[0], &cluster_indices[0], cluster_indices.size(), &cluster_counts[0], pending.size(), vertex_count, 4, NULL, NULL);
+
+	std::vector<std::vector<int> > result(partition_count);
+
+	for (size_t i = 0; i < pending.size(); ++i)
+		result[cluster_part[i]].push_back(pending[i]);
+
 	return result;
 }
 
-static std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t target_count, float* error = NULL)
+static std::vector<unsigned int> simplify(meshopt_SimplifierContext* context, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, size_t target_count, float* error = NULL)
 {
 	if (target_count > indices.size())
 		return indices;
 
 	std::vector<unsigned int> lod(indices.size());
 	unsigned int options = meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute;
-	lod.resize(meshopt_simplify(&lod[0], &indices[0], indices.size(), &vertices[0].px, vertices.size(), sizeof(Vertex), target_count, FLT_MAX, options, error));
+	lod.resize(meshopt_simplifyWithContext(context, &lod[0], &indices[0], indices.size(), &vertices[0].px, vertices.size(), sizeof(Vertex), NULL, 0, NULL, 0, NULL, target_count, FLT_MAX, options, error));
 
 	return lod;
 }
@@ -432,10 +432,13 @@ void nanite(const std::vector<Vertex>& vertices, const std::vector<unsigned int>
 
 	int depth = 0;
 
+	// all groups are simplified through the same context to reuse scratch memory
+	meshopt_SimplifierContext* context = meshopt_createSimplifierContext();
+
 	// merge and simplify clusters until we can't merge anymore
 	while (pending.size() > 1)
 	{
-		std::vector<std::vector<int> > groups = partition(clusters, pending);
+		std::vector<std::vector<int> > groups = partition(clusters, pending, vertices.size());
 		pending.clear();
 
 		std::vector<int> retry;
@@ -479,7 +482,7 @@ void nanite(const std::vector<Vertex>& vertices, const std::vector<unsigned int>
 				dumpObj("group", merged);
 
 			float error = 0.f;
-			std::vector<unsigned int> simplified = simplify(vertices, merged, kClusterSize * 2 * 3, &error);
+			std::vector<unsigned int> simplified = simplify(context, vertices, merged, kClusterSize * 2 * 3, &error);
 			if (simplified.size() > merged.size() * 0.85f || simplified.size() > kClusterSize * 3 * 3)
 			{
 #if TRACE
@@ -536,6 +539,8 @@ void nanite(const std::vector<Vertex>& vertices, const std::vector<unsigned int>
 		pending.insert(pending.end(), retry.begin(), retry.end());
 	}
 
+	meshopt_destroySimplifierContext(context);
+
 	size_t lowest_triangles = 0;
 	for (size_t i = 0; i < clusters.size(); ++i)
 		if (clusters[i].parent.error == FLT_MAX)
@@ -1,10 +1,12 @@
 #include "../src/meshoptimizer.h"
 
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <vector>
 
 // This file uses assert() to verify algorithm correctness
@@ -844,6 +846,1410 @@ static void clusterBoundsDegenerate()
 	assert(bounds2.center[2] - bounds2.radius <= 0 && bounds2.center[2] + bounds2.radius >= 1);
 }
 
+static void clusterBoundsLargeMeshlet()
+{
+	// 8-bit local indices can address 256 vertices, which exceeds builder limits but is valid input for bounds
+	float vb[256 * 3];
+	unsigned int meshlet_vertices[256];
+
+	for (unsigned int i = 0; i < 256; ++i)
+	{
+		float a = float(i) / 256.f * 6.2831853f;
+
+		vb[i * 3 + 0] = cosf(a);
+		vb[i * 3 + 1] = sinf(a);
+		vb[i * 3 + 2] = 0.f;
+
+		meshlet_vertices[i] = 255 - i;
+	}
+
+	unsigned char meshlet_triangles[254 * 3];
+	unsigned int indices[254 * 3];
+
+	for (unsigned int i = 0; i < 254; ++i)
+	{
+		meshlet_triangles[i * 3 + 0] = 0;
+		meshlet_triangles[i * 3 + 1] = (unsigned char)(i + 1);
+		meshlet_triangles[i * 3 + 2] = (unsigned char)(i + 2);
+	}
+
+	for (unsigned int i = 0; i < 254 * 3; ++i)
+		indices[i] = meshlet_vertices[meshlet_triangles[i]];
+
+	meshopt_Bounds bounds = meshopt_computeMeshletBounds(meshlet_vertices, meshlet_triangles, 254, vb, 256, 12);
+	meshopt_Bounds expected = meshopt_computeClusterBounds(indices, 254 * 3, vb, 256, 12);
+
+	assert(bounds.radius >= 0.999f && bounds.radius < 1.1f);
+	assert(memcmp(&bounds, &expected, sizeof(meshopt_Bounds)) == 0);
+
+	meshopt_Meshlet meshlet = {0, 0, 256, 254};
+	meshopt_Bounds batch;
+	meshopt_computeMeshletBoundsBatch(&batch, &meshlet, 1, meshlet_vertices, meshlet_triangles, vb, 256, 12, NULL, NULL);
+
+	assert(memcmp(&batch, &expected, sizeof(meshopt_Bounds)) == 0);
+}
+
+static void reverseScheduler(void* scheduler_context, void (*task)(void*, size_t), void* task_context, size_t count)
+{
+	int* calls = static_cast<int*>(scheduler_context);
+	*calls += 1;
+
+	// tasks can run in any order; running them in reverse validates that the results don't depend on the order
+	for (size_t i = count; i > 0; --i)
+		task(task_context, i - 1);
+}
+
+// (N+1)^2 vertices on a flat grid with N^2 quads, 2 triangles each; tests displace the vertices as needed
+static void makeGrid(std::vector<float>& vb, std::vector<unsigned int>& ib, size_t N)
+{
+	vb.resize((N + 1) * (N + 1) * 3);
+	ib.clear();
+
+	for (size_t y = 0; y <= N; ++y)
+		for (size_t x = 0; x <= N; ++x)
+		{
+			vb[(y * (N + 1) + x) * 3 + 0] = float(x);
+			vb[(y * (N + 1) + x) * 3 + 1] = float(y);
+			vb[(y * (N + 1) + x) * 3 + 2] = 0.f;
+		}
+
+	for (size_t y = 0; y < N; ++y)
+		for (size_t x = 0; x < N; ++x)
+		{
+			unsigned int v0 = unsigned(y * (N + 1) + x), v1 = v0 + 1, v2 = v0 + unsigned(N + 1), v3 = v2 + 1;
+			unsigned int tri[6] = {v0, v1, v3, v0, v3, v2};
+			ib.insert(ib.end(), tri, tri + 6);
+		}
+}
+
+template <typename T>
+static bool equalPrefix(const std::vector<T>& lhs, const std::vector<T>& rhs, size_t count)
+{
+	return count <= lhs.size() && count <= rhs.size() && (count == 0 || memcmp(&lhs[0], &rhs[0], count * sizeof(T)) == 0);
+}
+
+static void computeMeshletBoundsBatch()
+{
+	const size_t N = 130;
+
+	// (N+1)^2 vertices on a sphere, with a few degenerate triangles at the poles
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+	{
+		float u = vb[i] / float(N) * 6.2831853f, v = vb[i + 1] / float(N) * 3.1415926f;
+
+		vb[i + 0] = sinf(v) * cosf(u);
+		vb[i + 1] = sinf(v) * sinf(u);
+		vb[i + 2] = cosf(v);
+	}
+
+	const size_t max_vertices = 64, max_triangles = 124;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.f));
+
+	// tasks process 256 meshlets each; we need several tasks with a partial last one
+	assert(meshlets.size() > 256 && meshlets.size() % 256 != 0);
+
+	std::vector<meshopt_Bounds> bounds(meshlets.size());
+	meshopt_computeMeshletBoundsBatch(&bounds[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], &vb[0], vb.size() / 3, sizeof(float) * 3, NULL, NULL);
+
+	// results are identical to computing bounds for each meshlet separately
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		meshopt_Bounds expected = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset], m.triangle_count, &vb[0], vb.size() / 3, sizeof(float) * 3);
+
+		assert(memcmp(&bounds[i], &expected, sizeof(meshopt_Bounds)) == 0);
+	}
+
+	// results don't depend on the task order
+	std::vector<meshopt_Bounds> bounds2(meshlets.size());
+	int calls = 0;
+
+	meshopt_computeMeshletBoundsBatch(&bounds2[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], &vb[0], vb.size() / 3, sizeof(float) * 3, reverseScheduler, &calls);
+	assert(calls == 1 && equalPrefix(bounds, bounds2, bounds.size()));
+}
+
+static void cullMeshlets()
+{
+	// spheres along x axis, with cones alternating between facing the camera and facing away
+	std::vector<meshopt_Bounds> bounds(103);
+
+	for (size_t i = 0; i < bounds.size(); ++i)
+	{
+		meshopt_Bounds& b = bounds[i];
+		memset(&b, 0, sizeof(b));
+
+		b.center[0] = float(i) - 50.f;
+		b.center[2] = 10.f;
+		b.radius = 0.75f;
+		b.cone_axis[2] = (i % 3 == 0) ? 1.f : -1.f;
+		b.cone_cutoff = (i % 5 == 0) ? 1.f : 0.5f;
+	}
+
+	// planes x >= -20 and x <= 30.5
+	float planes[8] = {1, 0, 0, 20, -1, 0, 0, 30.5f};
+	float camera[3] = {0, 0, 0};
+
+	std::vector<unsigned int> visible(bounds.size());
+
+	// no tests: everything is visible
+	assert(meshopt_cullMeshlets(&visible[0], &bounds[0], bounds.size(), NULL, 0, NULL, NULL) == bounds.size());
+	assert(visible[0] == 0 && visible[bounds.size() - 1] == bounds.size() - 1);
+
+	size_t count = meshopt_cullMeshlets(&visible[0], &bounds[0], bounds.size(), planes, 2, camera, NULL);
+
+	std::vector<unsigned int> expected;
+
+	for (size_t i = 0; i < bounds.size(); ++i)
+	{
+		const meshopt_Bounds& b = bounds[i];
+
+		bool inside = b.center[0] >= -20.75f && b.center[0] <= 31.25f;
+
+		float vl = sqrtf(b.center[0] * b.center[0] + b.center[2] * b.center[2]);
+		bool backface = b.center[2] * b.cone_axis[2] >= b.cone_cutoff * vl + b.radius;
+
+		if (inside && !backface)
+			expected.push_back(unsigned(i));
+	}
+
+	assert(count == expected.size());
+	assert(memcmp(&visible[0], &expected[0], count * sizeof(unsigned int)) == 0);
+
+	// 4x4 depth pyramid with orthographic identity projection: left half is at depth 0.5, right half is at depth 1
+	float depth[4 * 4 + 2 * 2 + 1] = {};
+
+	for (int y = 0; y < 4; ++y)
+		for (int x = 0; x < 4; ++x)
+			depth[y * 4 + x] = x < 2 ? 0.5f : 1.f;
+
+	for (int i = 16; i < 21; ++i)
+		depth[i] = (i == 16 || i == 18) ? 0.5f : 1.f;
+
+	meshopt_DepthPyramid pyramid = {depth, 4, 4, 3, {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+
+	meshopt_Bounds spheres[6];
+	memset(spheres, 0, sizeof(spheres));
+
+	float centers[6][4] = {
+	    {-0.5f, 0.f, 0.8f, 0.1f},   // behind the left half
+	    {-0.5f, 0.f, 0.3f, 0.1f},   // in front of the left half
+	    {0.5f, 0.f, 0.8f, 0.1f},    // right half
+	    {-0.5f, 0.f, 0.05f, 0.1f},  // intersects the near plane
+	    {-0.5f, 0.f, 0.97f, 0.45f}, // behind the left half, covers 2x2 texels
+	    {0.f, 0.f, 0.6f, 0.5f},     // covers both halves via the next level
+	};
+
+	for (int i = 0; i < 6; ++i)
+	{
+		memcpy(spheres[i].center, centers[i], sizeof(float) * 4);
+		spheres[i].cone_cutoff = 1.f;
+	}
+
+	unsigned int visible_occ[6] = {};
+	assert(meshopt_cullMeshlets(visible_occ, spheres, 6, NULL, 0, NULL, &pyramid) == 4);
+	assert(visible_occ[0] == 1 && visible_occ[1] == 2 && visible_occ[2] == 3 && visible_occ[3] == 5);
+}
+
+static void buildMeshletsParallel()
+{
+	const size_t N = 300;
+
+	// (N+1)^2 grid with 2*N^2 = 180K triangles, which is split into multiple regions
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+		vb[i + 2] = float((size_t(vb[i]) * size_t(vb[i + 1])) % 7) * 0.1f;
+
+	const size_t max_vertices = 64, max_triangles = 124;
+
+	size_t max_meshlets = meshopt_buildMeshletsParallelBound(ib.size(), max_vertices, max_triangles);
+	assert(max_meshlets >= meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles));
+
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	size_t count = meshopt_buildMeshletsParallel(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.25f, NULL, NULL);
+	assert(count > 0 && count <= max_meshlets);
+
+	// every input triangle is emitted exactly once
+	std::vector<unsigned long long> expected, actual;
+
+	for (size_t i = 0; i < ib.size(); i += 3)
+	{
+		unsigned int tri[3] = {ib[i + 0], ib[i + 1], ib[i + 2]};
+		std::rotate(tri, std::min_element(tri, tri + 3), tri + 3);
+		expected.push_back((unsigned long long)tri[0] << 42 | (unsigned long long)tri[1] << 21 | tri[2]);
+	}
+
+	size_t vertex_offset = 0, triangle_offset = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		assert(m.vertex_count <= max_vertices && m.triangle_count <= max_triangles);
+
+		// meshlet data is tightly packed
+		assert(m.vertex_offset == vertex_offset && m.triangle_offset == triangle_offset);
+		vertex_offset += m.vertex_count;
+		triangle_offset += (m.triangle_count * 3 + 3) & ~3;
+
+		for (size_t j = 0; j < m.triangle_count; ++j)
+		{
+			unsigned int tri[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				unsigned char v = meshlet_triangles[m.triangle_offset + j * 3 + k];
+				assert(v < m.vertex_count);
+				tri[k] = meshlet_vertices[m.vertex_offset + v];
+			}
+
+			std::rotate(tri, std::min_element(tri, tri + 3), tri + 3);
+			actual.push_back((unsigned long long)tri[0] << 42 | (unsigned long long)tri[1] << 21 | tri[2]);
+		}
+	}
+
+	std::sort(expected.begin(), expected.end());
+	std::sort(actual.begin(), actual.end());
+	assert(actual == expected);
+
+	// results don't depend on the task order
+	std::vector<meshopt_Meshlet> meshlets2(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices2(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles2(max_meshlets * max_triangles * 3);
+	int calls = 0;
+
+	assert(meshopt_buildMeshletsParallel(&meshlets2[0], &meshlet_vertices2[0], &meshlet_triangles2[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.25f, reverseScheduler, &calls) == count);
+	assert(calls == 1);
+	assert(equalPrefix(meshlets, meshlets2, count) && equalPrefix(meshlet_vertices, meshlet_vertices2, vertex_offset) && equalPrefix(meshlet_triangles, meshlet_triangles2, triangle_offset));
+}
+
+static void buildMeshletsSpatial()
+{
+	const size_t N = 40;
+
+	// (N+1)^2 vertices on a cylinder
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+	{
+		float u = vb[i] / float(N) * 6.2831853f, y = vb[i + 1];
+
+		vb[i + 0] = cosf(u) * 5.f;
+		vb[i + 1] = sinf(u) * 5.f;
+		vb[i + 2] = y;
+	}
+
+	const size_t max_vertices = 64, max_triangles = 64;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+	std::vector<float> meshlet_boxes(max_meshlets * 6);
+
+	meshlets.resize(meshopt_buildMeshletsSpatial(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &meshlet_boxes[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles));
+	assert(meshlets.size() > 1);
+
+	size_t triangles = 0;
+	float area = 0;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+		const float* box = &meshlet_boxes[i * 6];
+
+		assert(m.vertex_count <= max_vertices && m.triangle_count <= max_triangles);
+		triangles += m.triangle_count;
+
+		// boxes are tight around meshlet vertices
+		float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < m.vertex_count; ++j)
+			for (int k = 0; k < 3; ++k)
+			{
+				float v = vb[meshlet_vertices[m.vertex_offset + j] * 3 + k];
+				bmin[k] = v < bmin[k] ? v : bmin[k];
+				bmax[k] = v > bmax[k] ? v : bmax[k];
+			}
+
+		for (int k = 0; k < 3; ++k)
+			assert(box[k] == bmin[k] && box[k + 3] == bmax[k]);
+
+		area += (bmax[0] - bmin[0]) * (bmax[1] - bmin[1]) + (bmax[1] - bmin[1]) * (bmax[2] - bmin[2]) + (bmax[2] - bmin[2]) * (bmax[0] - bmin[0]);
+	}
+
+	assert(triangles == ib.size() / 3);
+
+	// boxes are smaller than the ones produced by the regular builder
+	std::vector<meshopt_Meshlet> base(max_meshlets);
+	base.resize(meshopt_buildMeshlets(&base[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.f));
+
+	float base_area = 0;
+
+	for (size_t i = 0; i < base.size(); ++i)
+	{
+		float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < base[i].vertex_count; ++j)
+			for (int k = 0; k < 3; ++k)
+			{
+				float v = vb[meshlet_vertices[base[i].vertex_offset + j] * 3 + k];
+				bmin[k] = v < bmin[k] ? v : bmin[k];
+				bmax[k] = v > bmax[k] ? v : bmax[k];
+			}
+
+		base_area += (bmax[0] - bmin[0]) * (bmax[1] - bmin[1]) + (bmax[1] - bmin[1]) * (bmax[2] - bmin[2]) + (bmax[2] - bmin[2]) * (bmax[0] - bmin[0]);
+	}
+
+	assert(area < base_area);
+}
+
+static void optimizeMeshletBatch()
+{
+	const size_t N = 250;
+
+	// N*N quads on a grid
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	const size_t max_vertices = 255, max_triangles = 512;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.f));
+
+	// tasks process 256 meshlets each; we need several tasks with a partial last one
+	assert(meshlets.size() > 256 && meshlets.size() % 256 != 0);
+
+	// shuffle triangles within each meshlet so that the input order isn't coherent
+	unsigned int seed = 42;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		unsigned char* triangles = &meshlet_triangles[meshlets[i].triangle_offset];
+
+		for (size_t j = meshlets[i].triangle_count - 1; j > 0; --j)
+		{
+			seed = seed * 1103515245 + 12345;
+			size_t k = (seed >> 16) % (j + 1);
+
+			for (int c = 0; c < 3; ++c)
+			{
+				unsigned char t = triangles[j * 3 + c];
+				triangles[j * 3 + c] = triangles[k * 3 + c];
+				triangles[k * 3 + c] = t;
+			}
+		}
+	}
+
+	std::vector<unsigned int> expected_vertices = meshlet_vertices;
+	std::vector<unsigned char> expected_triangles = meshlet_triangles;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+		meshopt_optimizeMeshlet(&expected_vertices[meshlets[i].vertex_offset], &expected_triangles[meshlets[i].triangle_offset], meshlets[i].triangle_count, meshlets[i].vertex_count);
+
+	std::vector<unsigned int> actual_vertices = meshlet_vertices;
+	std::vector<unsigned char> actual_triangles = meshlet_triangles;
+
+	int calls = 0;
+	meshopt_optimizeMeshletBatch(&meshlets[0], meshlets.size(), &actual_vertices[0], &actual_triangles[0], reverseScheduler, &calls);
+	assert(calls == 1);
+
+	// batch results must match per-meshlet optimization exactly
+	assert(actual_vertices == expected_vertices);
+	assert(actual_triangles == expected_triangles);
+
+	size_t triangles = 0, coherent = 0;
+
+	for (size_t i = 0; i < meshlets.size(); ++i)
+	{
+		const meshopt_Meshlet& m = meshlets[i];
+
+		std::vector<unsigned long long> before, after;
+
+		for (size_t j = 0; j < m.triangle_count; ++j)
+		{
+			unsigned int a[3], b[3];
+
+			for (int k = 0; k < 3; ++k)
+			{
+				a[k] = meshlet_vertices[m.vertex_offset + meshlet_triangles[m.triangle_offset + j * 3 + k]];
+				b[k] = actual_vertices[m.vertex_offset + actual_triangles[m.triangle_offset + j * 3 + k]];
+			}
+
+			// rotate triangles so that the smallest index comes first, preserving winding
+			int ra = a[1] < a[0] ? (a[2] < a[1] ? 2 : 1) : (a[2] < a[0] ? 2 : 0);
+			int rb = b[1] < b[0] ? (b[2] < b[1] ? 2 : 1) : (b[2] < b[0] ? 2 : 0);
+
+			unsigned long long ka = (unsigned long long)a[ra] << 40 | (unsigned long long)a[(ra + 1) % 3] << 20 | a[(ra + 2) % 3];
+			unsigned long long kb = (unsigned long long)b[rb] << 40 | (unsigned long long)b[(rb + 1) % 3] << 20 | b[(rb + 2) % 3];
+
+			before.push_back(ka);
+			after.push_back(kb);
+		}
+
+		// triangles are a permutation of the input, with winding preserved
+		std::sort(before.begin(), before.end());
+		std::sort(after.begin(), after.end());
+		assert(before == after);
+
+		// vertices are sorted in the order of first use
+		const unsigned char* result = &actual_triangles[m.triangle_offset];
+		unsigned int next_vertex = 0;
+
+		for (size_t j = 0; j < m.triangle_count * 3; ++j)
+		{
+			assert(result[j] <= next_vertex);
+			next_vertex += result[j] == next_vertex;
+		}
+
+		// most triangles should share an edge with one of the last few triangles despite the shuffled input
+		for (size_t j = 1; j < m.triangle_count; ++j)
+		{
+			int shared = 0;
+
+			for (size_t p = j > 3 ? j - 3 : 0; p < j; ++p)
+				for (int k = 0; k < 3; ++k)
+					shared |= (result[j * 3 + k] == result[p * 3 + 0] || result[j * 3 + k] == result[p * 3 + 1] || result[j * 3 + k] == result[p * 3 + 2]) << k;
+
+			coherent += shared == 3 || shared == 5 || shared == 6 || shared == 7;
+		}
+
+		triangles += m.triangle_count;
+	}
+
+	assert(coherent * 5 > triangles * 4);
+}
+
+static void packMeshletPages()
+{
+	const size_t N = 60;
+
+	// (N+1)^2 vertices on a sphere
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+	{
+		float u = vb[i] / float(N) * 6.2831853f, v = vb[i + 1] / float(N) * 3.1415926f;
+
+		vb[i + 0] = cosf(u) * sinf(v) * 10.f;
+		vb[i + 1] = sinf(u) * sinf(v) * 10.f;
+		vb[i + 2] = cosf(v) * 10.f;
+	}
+
+	const size_t max_vertices = 64, max_triangles = 124;
+
+	size_t max_meshlets = meshopt_buildMeshletsBound(ib.size(), max_vertices, max_triangles);
+	std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+	std::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
+	std::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+	meshlets.resize(meshopt_buildMeshlets(&meshlets[0], &meshlet_vertices[0], &meshlet_triangles[0], &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, 0.f));
+	assert(meshlets.size() > 1);
+
+	const size_t page_size = 4096;
+	const int bits_options[] = {12, 16};
+
+	for (size_t b = 0; b < sizeof(bits_options) / sizeof(bits_options[0]); ++b)
+	{
+		int bits = bits_options[b];
+
+		size_t page_count = meshopt_packMeshletPagesBound(&meshlets[0], meshlets.size(), page_size, bits);
+		assert(page_count > 1);
+
+		std::vector<unsigned char> pages(page_count * page_size);
+		std::vector<meshopt_MeshletPage> directory(page_count);
+
+		size_t result = meshopt_packMeshletPages(&pages[0], &directory[0], &meshlets[0], meshlets.size(), &meshlet_vertices[0], &meshlet_triangles[0], &vb[0], vb.size() / 3, sizeof(float) * 3, page_size, bits);
+		assert(result == page_count);
+
+		size_t next_meshlet = 0;
+
+		for (size_t i = 0; i < page_count; ++i)
+		{
+			const meshopt_MeshletPage& page = directory[i];
+			const unsigned char* data = &pages[i * page_size];
+
+			// pages cover all meshlets in order
+			assert(page.meshlet_offset == next_meshlet && page.meshlet_count > 0);
+			next_meshlet += page.meshlet_count;
+
+			for (size_t j = 0; j < page.meshlet_count; ++j)
+			{
+				const meshopt_Meshlet& m = meshlets[page.meshlet_offset + j];
+
+				meshopt_PackedMeshlet header;
+				memcpy(&header, data + j * sizeof(meshopt_PackedMeshlet), sizeof(header));
+
+				assert(header.vertex_count == m.vertex_count && header.triangle_count == m.triangle_count && header.bits == bits);
+				assert(header.data_offset % 4 == 0 && header.data_offset < page_size);
+
+				const unsigned int* stream = reinterpret_cast<const unsigned int*>(data + header.data_offset);
+				size_t bit = 0;
+
+				for (size_t v = 0; v < m.vertex_count; ++v)
+					for (int k = 0; k < 3; ++k)
+					{
+						unsigned long long word = stream[bit / 32] | (bit % 32 + bits > 32 ? (unsigned long long)stream[bit / 32 + 1] << 32 : 0);
+						unsigned int q = unsigned(word >> (bit % 32)) & ((1u << bits) - 1);
+						bit += bits;
+
+						float decoded = header.offset[k] + float(q) * header.scale[k];
+						float expected = vb[meshlet_vertices[m.vertex_offset + v] * 3 + k];
+
+						assert(fabsf(decoded - expected) <= header.scale[k] * 0.5f + 1e-5f);
+						assert(expected >= page.min[k] && expected <= page.max[k]);
+					}
+
+				size_t triangle_offset = header.data_offset + (m.vertex_count * 3 * bits + 31) / 32 * 4;
+				assert(triangle_offset + m.triangle_count * 3 <= page_size);
+
+				assert(memcmp(data + triangle_offset, &meshlet_triangles[m.triangle_offset], m.triangle_count * 3) == 0);
+			}
+		}
+
+		assert(next_meshlet == meshlets.size());
+	}
+}
+
+static void partitionClusters()
+{
+	const size_t N = 40, T = 2;
+
+	// N*N grid split into (N/T)^2 clusters of T*T quads each
+	std::vector<float> vb;
+	std::vector<unsigned int> grid, ib, counts;
+	makeGrid(vb, grid, N);
+
+	for (size_t ty = 0; ty < N / T; ++ty)
+		for (size_t tx = 0; tx < N / T; ++tx)
+		{
+			for (size_t y = ty * T; y < ty * T + T; ++y)
+				for (size_t x = tx * T; x < tx * T + T; ++x)
+					ib.insert(ib.end(), &grid[(y * N + x) * 6], &grid[(y * N + x) * 6] + 6);
+
+			counts.push_back(unsigned(T * T * 6));
+		}
+
+	// one extra cluster that isn't connected to anything
+	unsigned int isolated[3] = {unsigned((N + 1) * (N + 1)), unsigned((N + 1) * (N + 1) + 1), unsigned((N + 1) * (N + 1) + 2)};
+	ib.insert(ib.end(), isolated, isolated + 3);
+	counts.push_back(3);
+
+	const size_t target = 4;
+	size_t cluster_count = counts.size();
+	size_t vertex_count = (N + 1) * (N + 1) + 3;
+
+	std::vector<unsigned int> part(cluster_count);
+	size_t partition_count = meshopt_partitionClusters(&part[0], &ib[0], ib.size(), &counts[0], cluster_count, vertex_count, target, NULL, NULL);
+	assert(partition_count > 0 && partition_count < cluster_count);
+
+	// partition ids are assigned in order of first appearance
+	std::vector<unsigned int> sizes(partition_count);
+	unsigned int next = 0;
+
+	for (size_t i = 0; i < cluster_count; ++i)
+	{
+		assert(part[i] <= next);
+		next += part[i] == next;
+		sizes[part[i]]++;
+	}
+
+	assert(next == partition_count);
+
+	// partitions are balanced, and most of them have the target size
+	size_t full = 0;
+
+	for (size_t i = 0; i < partition_count; ++i)
+	{
+		assert(sizes[i] <= target + target / 2);
+		full += sizes[i] == target;
+	}
+
+	assert(full * 2 > partition_count);
+	assert(sizes[part[cluster_count - 1]] == 1);
+
+	// results don't depend on the task order
+	std::vector<unsigned int> part2(cluster_count);
+	int calls = 0;
+
+	assert(meshopt_partitionClusters(&part2[0], &ib[0], ib.size(), &counts[0], cluster_count, vertex_count, target, reverseScheduler, &calls) == partition_count);
+	assert(calls > 0);
+	assert(part == part2);
+}
+
+static void buildClusterHierarchy()
+{
+	const size_t N = 100;
+
+	// (N+1)^2 curved grid with 2*N^2 = 20K triangles
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+		vb[i + 2] = (vb[i] * vb[i] + vb[i + 1] * vb[i + 1]) * 0.01f;
+
+	const size_t max_vertices = 64, max_triangles = 64;
+
+	size_t max_clusters = meshopt_buildClusterHierarchyBound(ib.size(), max_vertices, max_triangles);
+	size_t max_cluster_indices = ib.size() * 20 / 3;
+
+	std::vector<meshopt_Cluster> clusters(max_clusters);
+	std::vector<unsigned int> cluster_indices(max_cluster_indices);
+	std::vector<meshopt_ClusterGroup> groups(max_clusters / 2);
+	std::vector<unsigned int> group_clusters(max_clusters);
+	size_t group_count = 0;
+
+	size_t count = meshopt_buildClusterHierarchy(&clusters[0], &cluster_indices[0], &groups[0], &group_clusters[0], &group_count, max_clusters, max_cluster_indices, &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, NULL, NULL);
+	assert(count > 0 && count <= max_clusters);
+	assert(group_count > 0);
+
+	size_t base_triangles = 0, coarse_triangles = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const meshopt_Cluster& c = clusters[i];
+		assert(c.index_count > 0 && c.index_count <= max_triangles * 3);
+		assert(i == 0 || c.depth >= clusters[i - 1].depth);
+
+		// errors are monotonic along every path in the DAG
+		assert(c.self.error <= c.parent.error);
+
+		base_triangles += c.depth == 0 ? c.index_count / 3 : 0;
+		coarse_triangles += c.group == ~0u ? c.index_count / 3 : 0;
+	}
+
+	assert(base_triangles == ib.size() / 3);
+	assert(coarse_triangles < base_triangles / 2);
+
+	for (size_t i = 0; i < group_count; ++i)
+	{
+		const meshopt_ClusterGroup& g = groups[i];
+		assert(g.cluster_count >= 2);
+
+		for (size_t j = 0; j < g.cluster_count; ++j)
+		{
+			const meshopt_Cluster& c = clusters[group_clusters[g.cluster_offset + j]];
+			assert(c.group == i);
+			assert(memcmp(&c.parent, &g.bounds, sizeof(meshopt_LODBounds)) == 0);
+		}
+
+		for (size_t j = 0; j < g.result_count; ++j)
+		{
+			const meshopt_Cluster& c = clusters[g.result_offset + j];
+			assert(c.depth > 0);
+			assert(memcmp(&c.self, &g.bounds, sizeof(meshopt_LODBounds)) == 0);
+		}
+	}
+
+	// results don't depend on the task order
+	std::vector<meshopt_Cluster> clusters2(max_clusters);
+	std::vector<unsigned int> cluster_indices2(max_cluster_indices);
+	std::vector<meshopt_ClusterGroup> groups2(max_clusters / 2);
+	std::vector<unsigned int> group_clusters2(max_clusters);
+	size_t group_count2 = 0;
+	int calls = 0;
+
+	assert(meshopt_buildClusterHierarchy(&clusters2[0], &cluster_indices2[0], &groups2[0], &group_clusters2[0], &group_count2, max_clusters, max_cluster_indices, &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, reverseScheduler, &calls) == count);
+	assert(group_count2 == group_count && calls > 1);
+	assert(equalPrefix(clusters, clusters2, count) && equalPrefix(groups, groups2, group_count));
+	assert(equalPrefix(group_clusters, group_clusters2, groups[group_count - 1].cluster_offset + groups[group_count - 1].cluster_count));
+
+	size_t index_total = clusters[count - 1].index_offset + clusters[count - 1].index_count;
+	assert(equalPrefix(cluster_indices, cluster_indices2, index_total));
+
+	// construction stops early when the output doesn't have enough space for the next level
+	size_t limited = meshopt_buildClusterHierarchy(&clusters2[0], &cluster_indices2[0], &groups2[0], &group_clusters2[0], &group_count2, count - 1, max_cluster_indices, &ib[0], ib.size(), &vb[0], vb.size() / 3, sizeof(float) * 3, max_vertices, max_triangles, NULL, NULL);
+	assert(limited > 0 && limited < count && group_count2 < group_count);
+}
+
+static void validateBvh(const std::vector<meshopt_BvhNode>& nodes, const std::vector<unsigned int>& primitive_indices, const std::vector<float>& boxes, std::vector<int>& seen, unsigned int index, size_t max_leaf_size)
+{
+	const meshopt_BvhNode& node = nodes[index];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		float bmin[3] = {node.min_x[i], node.min_y[i], node.min_z[i]};
+		float bmax[3] = {node.max_x[i], node.max_y[i], node.max_z[i]};
+
+		if (node.children[i] == ~0u)
+		{
+			assert(node.counts[i] == 0 && bmin[0] > bmax[0]);
+			continue;
+		}
+
+		if (node.counts[i])
+		{
+			assert(node.counts[i] <= max_leaf_size);
+
+			for (unsigned int j = 0; j < node.counts[i]; ++j)
+			{
+				unsigned int prim = primitive_indices[node.children[i] + j];
+				seen[prim]++;
+
+				for (int k = 0; k < 3; ++k)
+					assert(boxes[prim * 6 + k] >= bmin[k] && boxes[prim * 6 + 3 + k] <= bmax[k]);
+			}
+		}
+		else
+		{
+			// depth-first order
+			assert(node.children[i] > index && node.children[i] < nodes.size());
+
+			const meshopt_BvhNode& child = nodes[node.children[i]];
+
+			for (int j = 0; j < 4; ++j)
+				if (child.children[j] != ~0u)
+				{
+					assert(child.min_x[j] >= bmin[0] && child.min_y[j] >= bmin[1] && child.min_z[j] >= bmin[2]);
+					assert(child.max_x[j] <= bmax[0] && child.max_y[j] <= bmax[1] && child.max_z[j] <= bmax[2]);
+				}
+
+			validateBvh(nodes, primitive_indices, boxes, seen, node.children[i], max_leaf_size);
+		}
+	}
+}
+
+static void buildBvh()
+{
+	const size_t N = 100;
+
+	// N*N jittered boxes on a bumpy grid produce several chunks; the last 100 boxes are identical
+	std::vector<float> boxes;
+
+	for (size_t y = 0; y < N; ++y)
+		for (size_t x = 0; x < N; ++x)
+		{
+			float z = float((x * 7 + y * 13) % 11) * 0.1f;
+			float s = float((x + y) % 3 + 1) * 0.2f;
+			float box[6] = {float(x), float(y), z, float(x) + s, float(y) + s, z + s};
+
+			boxes.insert(boxes.end(), box, box + 6);
+		}
+
+	for (size_t i = 0; i < 100; ++i)
+	{
+		float box[6] = {10, 10, 10, 11, 11, 11};
+		boxes.insert(boxes.end(), box, box + 6);
+	}
+
+	size_t primitive_count = boxes.size() / 6;
+	const size_t max_leaf_size = 4;
+
+	std::vector<meshopt_BvhNode> nodes(meshopt_buildBvhBound(primitive_count));
+	std::vector<unsigned int> primitive_indices(primitive_count);
+
+	nodes.resize(meshopt_buildBvh(&nodes[0], &primitive_indices[0], &boxes[0], primitive_count, max_leaf_size, NULL, NULL));
+	assert(nodes.size() > 1);
+
+	std::vector<int> seen(primitive_count);
+	validateBvh(nodes, primitive_indices, boxes, seen, 0, max_leaf_size);
+
+	for (size_t i = 0; i < primitive_count; ++i)
+		assert(seen[i] == 1);
+
+	// results don't depend on the task order
+	std::vector<meshopt_BvhNode> nodes2(meshopt_buildBvhBound(primitive_count));
+	std::vector<unsigned int> primitive_indices2(primitive_count);
+	int calls = 0;
+
+	nodes2.resize(meshopt_buildBvh(&nodes2[0], &primitive_indices2[0], &boxes[0], primitive_count, max_leaf_size, reverseScheduler, &calls));
+	assert(calls == 1 && nodes.size() == nodes2.size());
+	assert(equalPrefix(nodes, nodes2, nodes.size()) && primitive_indices == primitive_indices2);
+
+	// single primitive produces a root with one leaf
+	meshopt_BvhNode root;
+	unsigned int root_index = ~0u;
+
+	assert(meshopt_buildBvh(&root, &root_index, &boxes[0], 1, max_leaf_size, NULL, NULL) == 1);
+	assert(root_index == 0 && root.children[0] == 0 && root.counts[0] == 1 && root.children[1] == ~0u);
+
+	// triangles use their bounding boxes
+	const float vb[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 1};
+	const unsigned int ib[] = {0, 1, 2, 1, 3, 2};
+
+	meshopt_BvhNode tri_nodes[1];
+	unsigned int tri_indices[2];
+
+	assert(meshopt_buildBvhTriangles(tri_nodes, tri_indices, ib, 6, vb, 4, sizeof(float) * 3, 2, NULL, NULL) == 1);
+	assert(tri_nodes[0].counts[0] + tri_nodes[0].counts[1] == 2);
+}
+
+static void buildPointHierarchy()
+{
+	const unsigned int N = 30;
+
+	std::vector<float> vb(N * N * N * 6);
+	for (unsigned int i = 0; i < N * N * N; ++i)
+	{
+		vb[i * 6 + 0] = float(i % N) + 0.1f * float(i % 7);
+		vb[i * 6 + 1] = float(i / N % N) * 0.5f;
+		vb[i * 6 + 2] = float(i / N / N) * 2.f;
+		vb[i * 6 + 3] = float(i % 3) * 0.5f;
+		vb[i * 6 + 4] = float(i % 5) * 0.25f;
+		vb[i * 6 + 5] = 1.f;
+	}
+
+	const size_t max_leaf_points = 64;
+
+	std::vector<meshopt_PointNode> nodes(meshopt_buildPointHierarchyBound(N * N * N, max_leaf_points));
+	std::vector<unsigned int> points(N * N * N);
+
+	nodes.resize(meshopt_buildPointHierarchy(&nodes[0], &points[0], &vb[0], N * N * N, 24, &vb[3], 24, 1.f, 4, max_leaf_points, NULL, NULL));
+	assert(nodes.size() > 1);
+
+	// every point is stored exactly once
+	std::vector<unsigned int> sorted = points;
+	std::sort(sorted.begin(), sorted.end());
+	for (size_t i = 0; i < sorted.size(); ++i)
+		assert(sorted[i] == i);
+
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		const meshopt_PointNode& node = nodes[i];
+
+		assert(node.point_offset + node.point_count <= points.size());
+		assert(node.child_count == 0 || node.point_count <= 4 * 4 * 4);
+		assert(node.child_count > 0 || node.point_count <= max_leaf_points);
+
+		for (size_t j = 0; j < node.point_count; ++j)
+		{
+			const float* v = &vb[points[node.point_offset + j] * 6];
+
+			for (int k = 0; k < 3; ++k)
+				assert(v[k] >= node.bounds_min[k] && v[k] <= node.bounds_max[k]);
+		}
+
+		for (size_t j = node.child_offset; j < node.child_offset + node.child_count; ++j)
+		{
+			assert(j > i && j < nodes.size());
+			assert(nodes[j].depth == node.depth + 1);
+			assert(nodes[j].spacing <= node.spacing);
+
+			for (int k = 0; k < 3; ++k)
+				assert(nodes[j].bounds_min[k] >= node.bounds_min[k] && nodes[j].bounds_max[k] <= node.bounds_max[k]);
+		}
+	}
+
+	assert(nodes[0].depth == 0 && nodes[0].point_count > 0 && nodes[0].bounds_max[0] == float(N - 1) + 0.6f);
+
+	// results don't depend on the scheduler
+	std::vector<meshopt_PointNode> nodes2(meshopt_buildPointHierarchyBound(N * N * N, max_leaf_points));
+	std::vector<unsigned int> points2(N * N * N);
+
+	int calls = 0;
+	assert(meshopt_buildPointHierarchy(&nodes2[0], &points2[0], &vb[0], N * N * N, 24, &vb[3], 24, 1.f, 4, max_leaf_points, reverseScheduler, &calls) == nodes.size());
+	assert(equalPrefix(nodes, nodes2, nodes.size()));
+	assert(points == points2);
+	assert(calls > 1);
+}
+
+static void generateVertexRemapLarge()
+{
+	// 67-byte vertices that only differ in a single byte, including the bytes that don't fit into 4/8/16-byte words
+	const size_t vertex_size = 67;
+	const size_t vertex_count = vertex_size * 2;
+
+	std::vector<unsigned char> vb(vertex_count * vertex_size, 42);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		vb[i * vertex_size + i % vertex_size] = (unsigned char)(i / vertex_size);
+
+	std::vector<unsigned int> remap(vertex_count);
+	assert(meshopt_generateVertexRemap(&remap[0], NULL, vertex_count, &vb[0], vertex_count, vertex_size) == vertex_count);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		assert(remap[i] == i);
+
+	// second half duplicates the first half
+	memcpy(&vb[vertex_count / 2 * vertex_size], &vb[0], vertex_count / 2 * vertex_size);
+
+	assert(meshopt_generateVertexRemap(&remap[0], NULL, vertex_count, &vb[0], vertex_count, vertex_size) == vertex_count / 2);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		assert(remap[i] == i % (vertex_count / 2));
+}
+
+static void generateVertexRemapParallel()
+{
+	const size_t N = 300000;
+
+	// 150001 distinct positions, enough to split deduplication into multiple partitions
+	std::vector<float> vb(N * 3);
+	std::vector<unsigned char> ab(N);
+
+	for (size_t i = 0; i < N; ++i)
+	{
+		vb[i * 3 + 0] = float(i % 150001);
+		vb[i * 3 + 1] = 1.f;
+		vb[i * 3 + 2] = 0.f;
+		ab[i] = (unsigned char)(i % 3);
+	}
+
+	// the last 1000 vertices are unreferenced; some vertices are referenced multiple times
+	std::vector<unsigned int> ib(N * 3 / 2);
+
+	for (size_t i = 0; i < ib.size(); ++i)
+		ib[i] = unsigned((i * 2654435761ull) % (N - 1000));
+
+	std::vector<unsigned int> expected(N), actual(N);
+	int calls = 0;
+
+	size_t unique = meshopt_generateVertexRemap(&expected[0], &ib[0], ib.size(), &vb[0], N, sizeof(float) * 3);
+	assert(meshopt_generateVertexRemapParallel(&actual[0], &ib[0], ib.size(), &vb[0], N, sizeof(float) * 3, reverseScheduler, &calls) == unique);
+	assert(actual == expected);
+	assert(unique < N - 1000 && unique > 65536);
+	assert(calls == 3);
+
+	unique = meshopt_generateVertexRemap(&expected[0], NULL, N, &vb[0], N, sizeof(float) * 3);
+	assert(meshopt_generateVertexRemapParallel(&actual[0], NULL, N, &vb[0], N, sizeof(float) * 3, NULL, NULL) == unique);
+	assert(actual == expected);
+
+	meshopt_Stream streams[] = {
+	    {&vb[0], sizeof(float) * 3, sizeof(float) * 3},
+	    {&ab[0], 1, 1},
+	};
+
+	unique = meshopt_generateVertexRemapMulti(&expected[0], &ib[0], ib.size(), N, streams, 2);
+	assert(meshopt_generateVertexRemapMultiParallel(&actual[0], &ib[0], ib.size(), N, streams, 2, reverseScheduler, &calls) == unique);
+	assert(actual == expected);
+	assert(calls == 6);
+}
+
+static void generateVertexRemapFuzzy()
+{
+	// 3 triangles with vertices that are slightly offset from each other; the last triangle has different normals
+	const float vb[] = {
+	    0, 0, 0, 0, 0, 1,
+	    1, 0, 0, 0, 0, 1,
+	    1, 1, 0, 0, 0, 1,
+	    1.0001f, 0, 0, 0, 0, 1,
+	    2, 0, 0, 0, 0, 1,
+	    1, 1.0001f, 0.0001f, 0, 0, 1,
+	    -0.f, 0, 0, 0, 0.01f, 1,
+	    0.0002f, 0, 0, 0, 1, 0,
+	    0, 0.0002f, 0, 0, 0, 1,
+	};
+
+	const unsigned int ib[] = {
+	    0, 1, 2,
+	    3, 4, 5,
+	    6, 8, 7,
+	};
+
+	meshopt_Stream streams[] = {
+	    {&vb[0], sizeof(float) * 3, sizeof(float) * 6},
+	    {&vb[3], sizeof(float) * 3, sizeof(float) * 6},
+	};
+
+	unsigned int remap[9];
+
+	// tolerance 0 matches exact equality, folding -0 into +0
+	float exact[] = {0.f, 0.f};
+	assert(meshopt_generateVertexRemapFuzzy(remap, ib, 9, 9, streams, 2, exact) == 9);
+	assert(meshopt_generateVertexRemapFuzzy(remap, ib, 9, 9, streams, 1, exact) == 8);
+	assert(remap[6] == remap[0]);
+
+	float normal_exact[] = {0.001f, 0.f};
+	unsigned int expected1[] = {0, 1, 2, 1, 3, 2, 4, 5, 0};
+	assert(meshopt_generateVertexRemapFuzzy(remap, ib, 9, 9, streams, 2, normal_exact) == 6);
+	assert(memcmp(remap, expected1, sizeof(expected1)) == 0);
+
+	float loose[] = {0.001f, 0.1f};
+	unsigned int expected2[] = {0, 1, 2, 1, 3, 2, 0, 4, 0};
+	assert(meshopt_generateVertexRemapFuzzy(remap, ib, 9, 9, streams, 2, loose) == 5);
+	assert(memcmp(remap, expected2, sizeof(expected2)) == 0);
+
+	// unindexed input and unreferenced vertices
+	assert(meshopt_generateVertexRemapFuzzy(remap, NULL, 9, 9, streams, 2, loose) == 5);
+	assert(memcmp(remap, expected2, sizeof(expected2)) == 0);
+
+	assert(meshopt_generateVertexRemapFuzzy(remap, ib, 3, 9, streams, 1, loose) == 3);
+	assert(remap[3] == ~0u && remap[8] == ~0u);
+
+	// coordinates that are very large relative to tolerance are matched exactly; each vertex is listed twice
+	const size_t N = 1200;
+	std::vector<float> large(N * 2 * 3);
+
+	for (size_t i = 0; i < N * 2; ++i)
+	{
+		large[i * 3 + 0] = float(i % N + 1) * 1e12f;
+		large[i * 3 + 1] = 1.f;
+		large[i * 3 + 2] = 0.f;
+	}
+
+	meshopt_Stream large_stream = {&large[0], sizeof(float) * 3, sizeof(float) * 3};
+	float large_tolerance[] = {1e-3f};
+
+	std::vector<unsigned int> large_remap(N * 2);
+	assert(meshopt_generateVertexRemapFuzzy(&large_remap[0], NULL, N * 2, N * 2, &large_stream, 1, large_tolerance) == N);
+
+	for (size_t i = 0; i < N; ++i)
+		assert(large_remap[i] == i && large_remap[i + N] == i);
+}
+
+static void generateIndexedMesh()
+{
+	const size_t N = 3000;
+
+	// interleaved vertex soup with duplicates; indices reference vertices out of order
+	std::vector<float> vb(N * 4);
+	std::vector<unsigned int> ib(N);
+
+	for (size_t i = 0; i < N; ++i)
+	{
+		vb[i * 4 + 0] = float(i % 1000);
+		vb[i * 4 + 1] = float(i % 1000 % 7);
+		vb[i * 4 + 2] = 0.f;
+		vb[i * 4 + 3] = float(i % 1000 % 3);
+		ib[i] = unsigned((i * 7919) % N);
+	}
+
+	meshopt_Stream streams[] = {
+	    {&vb[0], sizeof(float) * 3, sizeof(float) * 4},
+	    {&vb[3], sizeof(float), sizeof(float) * 4},
+	};
+
+	std::vector<unsigned int> remap(N);
+	size_t unique = meshopt_generateVertexRemapMulti(&remap[0], &ib[0], N, N, streams, 2);
+	assert(unique == 1000);
+
+	std::vector<unsigned int> expected_ib(N);
+	meshopt_remapIndexBuffer(&expected_ib[0], &ib[0], N, &remap[0]);
+
+	std::vector<float> expected_pos(unique * 3), expected_attr(unique);
+	std::vector<float> pos(N * 3), attr(N);
+
+	for (size_t i = 0; i < N; ++i)
+	{
+		pos[i * 3 + 0] = vb[i * 4 + 0];
+		pos[i * 3 + 1] = vb[i * 4 + 1];
+		pos[i * 3 + 2] = vb[i * 4 + 2];
+		attr[i] = vb[i * 4 + 3];
+	}
+
+	meshopt_remapVertexBuffer(&expected_pos[0], &pos[0], N, sizeof(float) * 3, &remap[0]);
+	meshopt_remapVertexBuffer(&expected_attr[0], &attr[0], N, sizeof(float), &remap[0]);
+
+	// separate destinations
+	std::vector<unsigned int> res_ib(N);
+	std::vector<float> res_pos(N * 3), res_attr(N);
+	void* destinations[] = {&res_pos[0], &res_attr[0]};
+
+	assert(meshopt_generateIndexedMesh(&res_ib[0], 4, destinations, &ib[0], N, N, streams, 2) == unique);
+	assert(res_ib == expected_ib);
+	assert(memcmp(&res_pos[0], &expected_pos[0], unique * sizeof(float) * 3) == 0);
+	assert(memcmp(&res_attr[0], &expected_attr[0], unique * sizeof(float)) == 0);
+
+	// in place remap of non-interleaved streams with 16-bit indices
+	std::vector<unsigned int> ib_copy = ib;
+	meshopt_Stream streams_split[] = {
+	    {&pos[0], sizeof(float) * 3, sizeof(float) * 3},
+	    {&attr[0], sizeof(float), sizeof(float)},
+	};
+	void* destinations_split[] = {&pos[0], &attr[0]};
+
+	assert(meshopt_generateIndexedMesh(&ib_copy[0], 2, destinations_split, &ib_copy[0], N, N, streams_split, 2) == unique);
+	assert(memcmp(&pos[0], &expected_pos[0], unique * sizeof(float) * 3) == 0);
+	assert(memcmp(&attr[0], &expected_attr[0], unique * sizeof(float)) == 0);
+
+	const unsigned short* ib16 = reinterpret_cast<const unsigned short*>(&ib_copy[0]);
+
+	for (size_t i = 0; i < N; ++i)
+		assert(ib16[i] == expected_ib[i]);
+
+	// in place remap of unindexed input doesn't need temporary storage
+	std::vector<float> soup(N);
+	for (size_t i = 0; i < N; ++i)
+		soup[i] = float(i % 10);
+
+	meshopt_Stream stream_soup = {&soup[0], sizeof(float), sizeof(float)};
+	void* destination_soup = &soup[0];
+
+	assert(meshopt_generateIndexedMesh(&res_ib[0], 4, &destination_soup, NULL, N, N, &stream_soup, 1) == 10);
+
+	for (size_t i = 0; i < N; ++i)
+		assert(res_ib[i] == i % 10 && soup[res_ib[i]] == float(i % 10));
+}
+
+static void generateIndexedMeshLimit()
+{
+	const size_t N = 65538 * 3;
+
+	std::vector<unsigned int> vb(N);
+	for (size_t i = 0; i < N; ++i)
+		vb[i] = unsigned(i);
+
+	meshopt_Stream stream = {&vb[0], sizeof(unsigned int), sizeof(unsigned int)};
+
+	std::vector<unsigned short> ib16(N, 42);
+	std::vector<unsigned int> res(N);
+	void* destination = &res[0];
+
+	// 16-bit indices can't represent all vertices, so nothing is written
+	assert(meshopt_generateIndexedMesh(&ib16[0], 2, &destination, NULL, N, N, &stream, 1) == N);
+	assert(ib16[0] == 42 && ib16[N - 1] == 42 && res[1] == 0);
+
+	std::vector<unsigned int> ib(N);
+	assert(meshopt_generateIndexedMesh(&ib[0], 4, &destination, NULL, N, N, &stream, 1) == N);
+	assert(ib[N - 1] == N - 1 && res == vb);
+}
+
+static void indexVertexBatch()
+{
+	const size_t N = 64;
+
+	// triangle soup of a N*N grid, emitted row by row
+	std::vector<float> soup;
+
+	for (size_t y = 0; y < N; ++y)
+		for (size_t x = 0; x < N; ++x)
+		{
+			float quad[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+
+			for (int k = 0; k < 6; ++k)
+			{
+				soup.push_back(float(x) + quad[k][0]);
+				soup.push_back(float(y) + quad[k][1]);
+				soup.push_back(0.f);
+			}
+		}
+
+	size_t soup_count = soup.size() / 3;
+
+	std::vector<unsigned int> remap(soup_count);
+	size_t unique = meshopt_generateVertexRemap(&remap[0], NULL, soup_count, &soup[0], soup_count, sizeof(float) * 3);
+	assert(unique == (N + 1) * (N + 1));
+
+	// cache that holds two rows of vertices is sufficient to find all duplicates; smaller cache produces some duplicate vertices
+	size_t cache_sizes[] = {4096, 2 * N + 2, 16};
+
+	for (size_t c = 0; c < sizeof(cache_sizes) / sizeof(cache_sizes[0]); ++c)
+	{
+		meshopt_VertexIndexer* indexer = meshopt_createVertexIndexer(sizeof(float) * 3, cache_sizes[c]);
+
+		std::vector<unsigned int> ib(soup_count);
+		std::vector<float> vb(soup.size());
+		size_t vertex_count = 0;
+
+		// process the soup in batches of varying size
+		for (size_t offset = 0, batch = 1; offset < soup_count; offset += batch, batch = batch * 3 + 1)
+		{
+			size_t count = soup_count - offset < batch ? soup_count - offset : batch;
+
+			vertex_count += meshopt_indexVertexBatch(indexer, &ib[offset], &vb[vertex_count * 3], &soup[offset * 3], count);
+		}
+
+		meshopt_destroyVertexIndexer(indexer);
+
+		for (size_t i = 0; i < soup_count; ++i)
+		{
+			assert(ib[i] < vertex_count);
+			assert(memcmp(&vb[ib[i] * 3], &soup[i * 3], sizeof(float) * 3) == 0);
+		}
+
+		assert(c < 2 ? vertex_count == unique : vertex_count > unique);
+	}
+}
+
+static void optimizeVertexCacheParallel()
+{
+	const size_t N = 200;
+
+	// N*N quads on a bumpy grid, enough to split the mesh into multiple regions
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+		vb[i + 2] = float((size_t(vb[i]) * 7 + size_t(vb[i + 1]) * 13) % 5) * 0.1f;
+
+	size_t vertex_count = vb.size() / 3;
+
+	std::vector<unsigned int> expected(ib.size()), actual(ib.size());
+	int calls = 0;
+
+	meshopt_optimizeVertexCache(&expected[0], &ib[0], ib.size(), vertex_count);
+	meshopt_optimizeVertexCacheParallel(&actual[0], &ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3, reverseScheduler, &calls);
+	assert(calls == 1);
+
+	// result must contain the same triangles with the same winding
+	std::vector<unsigned long long> before, after;
+
+	for (size_t i = 0; i < ib.size(); i += 3)
+	{
+		const unsigned int* a = &ib[i];
+		const unsigned int* b = &actual[i];
+
+		int ra = a[1] < a[0] ? (a[2] < a[1] ? 2 : 1) : (a[2] < a[0] ? 2 : 0);
+		int rb = b[1] < b[0] ? (b[2] < b[1] ? 2 : 1) : (b[2] < b[0] ? 2 : 0);
+
+		before.push_back((unsigned long long)a[ra] << 42 | (unsigned long long)a[(ra + 1) % 3] << 21 | a[(ra + 2) % 3]);
+		after.push_back((unsigned long long)b[rb] << 42 | (unsigned long long)b[(rb + 1) % 3] << 21 | b[(rb + 2) % 3]);
+	}
+
+	std::sort(before.begin(), before.end());
+	std::sort(after.begin(), after.end());
+	assert(before == after);
+
+	// regions are optimized independently, which should only affect efficiency around region boundaries
+	meshopt_VertexCacheStatistics serial = meshopt_analyzeVertexCache(&expected[0], expected.size(), vertex_count, 16, 0, 0);
+	meshopt_VertexCacheStatistics parallel = meshopt_analyzeVertexCache(&actual[0], actual.size(), vertex_count, 16, 0, 0);
+
+	assert(parallel.acmr < serial.acmr * 1.02f);
+
+	// in-place optimization is supported
+	std::vector<unsigned int> copy = ib;
+	meshopt_optimizeVertexCacheParallel(&copy[0], &copy[0], copy.size(), &vb[0], vertex_count, sizeof(float) * 3, NULL, NULL);
+	assert(copy == actual);
+
+	// small meshes produce the same result as the serial optimizer
+	size_t small_count = 3000 * 3;
+
+	meshopt_optimizeVertexCache(&expected[0], &ib[0], small_count, vertex_count);
+	meshopt_optimizeVertexCacheParallel(&actual[0], &ib[0], small_count, &vb[0], vertex_count, sizeof(float) * 3, NULL, NULL);
+	assert(memcmp(&expected[0], &actual[0], small_count * sizeof(unsigned int)) == 0);
+}
+
+static void analyzeVertexCacheMulti()
+{
+	const size_t N = 60;
+
+	// N*N quads on a grid; triangles are optimized to get realistic cache behavior
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	size_t vertex_count = (N + 1) * (N + 1);
+
+	meshopt_optimizeVertexCache(&ib[0], &ib[0], ib.size(), vertex_count);
+
+	// 6 FIFO profiles need two groups of lanes; LRU profiles are interleaved to test result ordering
+	const meshopt_VertexCacheProfile profiles[] = {
+	    {16, 0, 0, meshopt_VertexCacheFifo},
+	    {32, 32, 32, meshopt_VertexCacheFifo},
+	    {16, 0, 0, meshopt_VertexCacheLru},
+	    {14, 64, 128, meshopt_VertexCacheFifo},
+	    {128, 0, 0, meshopt_VertexCacheFifo},
+	    {32, 32, 32, meshopt_VertexCacheLru},
+	    {3, 0, 0, meshopt_VertexCacheFifo},
+	    {16, 32, 0, meshopt_VertexCacheFifo},
+	    {4096, 0, 0, meshopt_VertexCacheLru},
+	};
+
+	const size_t profile_count = sizeof(profiles) / sizeof(profiles[0]);
+
+	meshopt_VertexCacheStatistics results[profile_count];
+	meshopt_analyzeVertexCacheMulti(results, &ib[0], ib.size(), vertex_count, profiles, profile_count);
+
+	for (size_t i = 0; i < profile_count; ++i)
+	{
+		if (profiles[i].replacement != meshopt_VertexCacheFifo)
+			continue;
+
+		meshopt_VertexCacheStatistics expected = meshopt_analyzeVertexCache(&ib[0], ib.size(), vertex_count, profiles[i].cache_size, profiles[i].warp_size, profiles[i].primgroup_size);
+
+		assert(results[i].vertices_transformed == expected.vertices_transformed);
+		assert(results[i].warps_executed == expected.warps_executed);
+		assert(results[i].acmr == expected.acmr && results[i].atvr == expected.atvr);
+	}
+
+	// a large LRU cache transforms each vertex once
+	assert(results[8].vertices_transformed == vertex_count && results[8].atvr == 1.f && results[8].warps_executed == 1);
+
+	// with 3 entries, LRU keeps vertex 1 which is used by all triangles, whereas FIFO evicts it
+	const unsigned int ibs[] = {0, 1, 2, 2, 1, 3, 0, 1, 2};
+	const meshopt_VertexCacheProfile small[] = {
+	    {3, 0, 0, meshopt_VertexCacheFifo},
+	    {3, 0, 0, meshopt_VertexCacheLru},
+	};
+
+	meshopt_VertexCacheStatistics small_results[2];
+	meshopt_analyzeVertexCacheMulti(small_results, ibs, 9, 4, small, 2);
+
+	assert(small_results[0].vertices_transformed == 7);
+	assert(small_results[1].vertices_transformed == 6);
+}
+
+static void analyzeOverdrawViews()
+{
+	const size_t N = 40;
+
+	// N*N quads on a bumpy grid, so that some triangles overlap in axis views
+	std::vector<float> vb;
+	std::vector<unsigned int> ib;
+	makeGrid(vb, ib, N);
+
+	for (size_t i = 0; i < vb.size(); i += 3)
+		vb[i + 2] = sinf(vb[i] * 0.7f) * cosf(vb[i + 1] * 0.3f) * 5.f;
+
+	size_t vertex_count = (N + 1) * (N + 1);
+
+	// axis views at default resolution match the regular analyzer exactly
+	const float axes[] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	meshopt_OverdrawStatistics expected = meshopt_analyzeOverdraw(&ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3);
+	assert(expected.pixels_shaded > expected.pixels_covered);
+
+	int calls = 0;
+	meshopt_OverdrawStatistics actual = meshopt_analyzeOverdrawViews(&ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3, axes, 3, 256, reverseScheduler, &calls);
+	assert(calls == 1);
+	assert(actual.pixels_covered == expected.pixels_covered && actual.pixels_shaded == expected.pixels_shaded);
+
+	actual = meshopt_analyzeOverdrawViews(&ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3, axes, 3, 256, NULL, NULL);
+	assert(actual.pixels_covered == expected.pixels_covered && actual.pixels_shaded == expected.pixels_shaded);
+
+	// view directions don't need to be normalized
+	const float diagonal[] = {1, 1, 1, 2, 2, 2};
+
+	meshopt_OverdrawStatistics diag[2];
+	for (int i = 0; i < 2; ++i)
+		diag[i] = meshopt_analyzeOverdrawViews(&ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3, &diagonal[i * 3], 1, 100, NULL, NULL);
+
+	assert(diag[0].pixels_covered > 0 && diag[0].pixels_shaded >= diag[0].pixels_covered);
+	assert(diag[0].pixels_covered == diag[1].pixels_covered && diag[0].pixels_shaded == diag[1].pixels_shaded);
+
+	// a flat grid viewed along Z covers the entire viewport at any resolution, with rows and columns that don't fit into SIMD spans
+	std::vector<float> flat = vb;
+	for (size_t i = 0; i < vertex_count; ++i)
+		flat[i * 3 + 2] = 0.f;
+
+	const float top[] = {0, 0, 1};
+
+	for (size_t size = 1; size <= 67; size += 11)
+	{
+		meshopt_OverdrawStatistics os = meshopt_analyzeOverdrawViews(&ib[0], ib.size(), &flat[0], vertex_count, sizeof(float) * 3, top, 1, size, NULL, NULL);
+		assert(os.pixels_covered == size * size && os.pixels_shaded == size * size && os.overdraw == 1.f);
+	}
+
+	meshopt_OverdrawStatistics empty = meshopt_analyzeOverdrawViews(&ib[0], ib.size(), &vb[0], vertex_count, sizeof(float) * 3, NULL, 0, 256, NULL, NULL);
+	assert(empty.pixels_covered == 0 && empty.pixels_shaded == 0 && empty.overdraw == 0.f);
+}
+
 static size_t allocCount;
 static size_t freeCount;
 
@@ -900,6 +2306,7 @@ static void emptyMesh()
 {
 	meshopt_optimizeVertexCache(NULL, NULL, 0, 0);
 	meshopt_optimizeVertexCacheFifo(NULL, NULL, 0, 0, 16);
+	meshopt_optimizeVertexCacheParallel(NULL, NULL, 0, NULL, 0, 12, NULL, NULL);
 	meshopt_optimizeOverdraw(NULL, NULL, 0, NULL, 0, 12, 1.f);
 }
 
@@ -997,6 +2404,13 @@ static void simplifySloppyStuck()
 
 	// simplifying down to 2 triangles given that all triangles are degenerate results in 0 as well
 	assert(meshopt_simplifySloppy(target, ib, 6, vb, 3, 12, 6, 0.f) == 0);
+
+	const float vb2[] = {0, 0, 0, 1, 0, 0, 0, 1, 0};
+	const unsigned int ib2[] = {0, 1, 2};
+	unsigned int result[3];
+
+	// target below one triangle makes the grid size estimate interpolate between equal counts
+	assert(meshopt_simplifySloppy(result, ib2, 3, vb2, 3, 12, 2, 1.f) == 0);
 }
 
 static void simplifyPointsStuck()
@@ -1007,6 +2421,45 @@ static void simplifyPointsStuck()
 	assert(meshopt_simplifyPoints(NULL, vb, 3, 12, NULL, 0, 0, 0) == 0);
 }
 
+static void simplifyPointsMulti()
+{
+	const unsigned int N = 20;
+
+	std::vector<float> vb(N * N * N * 3);
+	for (unsigned int i = 0; i < N * N * N; ++i)
+	{
+		vb[i * 3 + 0] = float(i % N) + 0.1f * float(i % 7);
+		vb[i * 3 + 1] = float(i / N % N) * 0.5f;
+		vb[i * 3 + 2] = float(i / N / N) * 2.f;
+	}
+
+	size_t targets[] = {4000, 0, 500, 50, 1};
+	const size_t target_count = sizeof(targets) / sizeof(targets[0]);
+
+	std::vector<unsigned int> res(4000 + 500 + 50 + 1);
+	size_t counts[target_count];
+
+	size_t total = meshopt_simplifyPointsMulti(&res[0], counts, &vb[0], N * N * N, 12, NULL, 0, 0, targets, target_count);
+
+	// results must match individual meshopt_simplifyPoints calls
+	size_t offset = 0;
+
+	for (size_t i = 0; i < target_count; ++i)
+	{
+		std::vector<unsigned int> expected(targets[i] + 1);
+		size_t expected_count = meshopt_simplifyPoints(&expected[0], &vb[0], N * N * N, 12, NULL, 0, 0, targets[i]);
+
+		assert(counts[i] == expected_count);
+		assert(counts[i] <= targets[i]);
+		assert(expected_count == 0 || memcmp(&res[offset], &expected[0], expected_count * sizeof(unsigned int)) == 0);
+
+		offset += counts[i];
+	}
+
+	assert(total == offset);
+	assert(counts[0] > 3000 && counts[1] == 0 && counts[4] == 1);
+}
+
 static void simplifyFlip()
 {
 	// this mesh has been constructed by taking a tessellated irregular grid with a square cutout
@@ -1431,6 +2884,331 @@ static void simplifySeamFake()
 	assert(meshopt_simplify(ib, ib, 6, vb, 4, 16, 0, 1.f, 0, NULL) == 6);
 }
 
+static size_t scratchCurrent;
+static size_t scratchPeak;
+
+static void* scratchAlloc(size_t size)
+{
+	// keep allocation size in front of the allocation to track it on free; 16 bytes keep the alignment intact
+	char* ptr = static_cast<char*>(malloc(size + 16));
+	*reinterpret_cast<size_t*>(ptr) = size;
+
+	scratchCurrent += size;
+	scratchPeak = scratchPeak < scratchCurrent ? scratchCurrent : scratchPeak;
+
+	return ptr + 16;
+}
+
+static void scratchFree(void* ptr)
+{
+	char* base = static_cast<char*>(ptr) - 16;
+
+	scratchCurrent -= *reinterpret_cast<size_t*>(base);
+	free(base);
+}
+
+static void simplifyLowMemory()
+{
+	const size_t N = 20;
+
+	// grid with a curved surface so that collapses have varying errors
+	std::vector<float> vb(N * N * 4);
+	for (size_t y = 0; y < N; ++y)
+		for (size_t x = 0; x < N; ++x)
+		{
+			float* v = &vb[(y * N + x) * 4];
+			v[0] = float(x);
+			v[1] = float(y);
+			v[2] = sinf(float(x) * 0.3f) * cosf(float(y) * 0.2f);
+			v[3] = float(x) / float(N);
+		}
+
+	std::vector<unsigned int> ib;
+	for (size_t y = 0; y + 1 < N; ++y)
+		for (size_t x = 0; x + 1 < N; ++x)
+		{
+			unsigned int v0 = unsigned(y * N + x), v1 = v0 + 1, v2 = v0 + unsigned(N), v3 = v2 + 1;
+			unsigned int quad[] = {v0, v1, v3, v0, v3, v2};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	float aw = 0.5f;
+
+	std::vector<unsigned int> res1(ib.size()), res2(ib.size());
+	float error1 = 0, error2 = 0;
+
+	meshopt_setAllocator(scratchAlloc, scratchFree);
+
+	// low memory mode should produce the same result while using less memory
+	scratchPeak = 0;
+	size_t count1 = meshopt_simplifyWithAttributes(&res1[0], &ib[0], ib.size(), &vb[0], N * N, 16, &vb[3], 16, &aw, 1, NULL, ib.size() / 4, 1e-1f, 0, &error1);
+	size_t peak1 = scratchPeak;
+
+	scratchPeak = 0;
+	size_t count2 = meshopt_simplifyWithAttributes(&res2[0], &ib[0], ib.size(), &vb[0], N * N, 16, &vb[3], 16, &aw, 1, NULL, ib.size() / 4, 1e-1f, meshopt_SimplifyLowMemory, &error2);
+	size_t peak2 = scratchPeak;
+
+	assert(count1 == count2 && count1 < ib.size());
+	assert(memcmp(&res1[0], &res2[0], count1 * sizeof(unsigned int)) == 0);
+	assert(error1 == error2);
+	assert(peak2 < peak1);
+
+	// scratch bound should be conservative for all modes
+	assert(peak1 <= meshopt_simplifyScratchBound(ib.size(), N * N, 1, 0));
+	assert(peak2 <= meshopt_simplifyScratchBound(ib.size(), N * N, 1, meshopt_SimplifyLowMemory));
+
+	scratchPeak = 0;
+	meshopt_simplify(&res1[0], &ib[0], ib.size() / 2, &vb[0], N * N, 16, 0, 1e-1f, meshopt_SimplifySparse);
+	assert(scratchPeak <= meshopt_simplifyScratchBound(ib.size() / 2, N * N, 0, meshopt_SimplifySparse));
+
+	meshopt_setAllocator(operator new, operator delete);
+	assert(scratchCurrent == 0);
+}
+
+static void simplifyContext()
+{
+	float vb[] = {0, 4, 0, 0, 1, 0, 2, 2, 0, 0, 0, 0, 1, 0, 0, 4, 0, 0};
+	unsigned int ib[] = {0, 2, 1, 1, 2, 3, 3, 2, 4, 2, 5, 4};
+
+	unsigned int expected[12];
+	size_t expected_count = meshopt_simplify(expected, ib, 12, vb, 6, 12, 3, 1e-2f, 0, NULL);
+
+	meshopt_setAllocator(customAlloc, customFree);
+
+	meshopt_SimplifierContext* context = meshopt_createSimplifierContext();
+
+	// context scratch memory is allocated on first use and reused afterwards
+	for (int i = 0; i < 10; ++i)
+	{
+		unsigned int res[12];
+		float error = -1.f;
+		assert(meshopt_simplifyWithContext(context, res, ib, 12, vb, 6, 12, NULL, 0, NULL, 0, NULL, 3, 1e-2f, 0, &error) == expected_count);
+		assert(memcmp(res, expected, expected_count * sizeof(unsigned int)) == 0);
+		assert(error == 0.f);
+	}
+
+	assert(allocCount == 2 && freeCount == 0);
+
+	meshopt_destroySimplifierContext(context);
+	assert(allocCount == 2 && freeCount == 2);
+
+	meshopt_setAllocator(operator new, operator delete);
+
+	allocCount = freeCount = 0;
+}
+
+static void simplifyStats()
+{
+	meshopt_SimplifierContext* context = meshopt_createSimplifierContext();
+	meshopt_SimplifyStats stats = {};
+
+	// strip with locked border can't be simplified due to topology restriction
+	float vb1[] = {0, 0, 0, 1, 0, 0, 2, 0, 0, 0.5f, 1, 0, 1.5f, 1, 0};
+	unsigned int ib1[] = {0, 1, 3, 3, 1, 4, 1, 2, 4};
+
+	assert(meshopt_simplifyWithContext(context, ib1, ib1, 9, vb1, 5, 12, NULL, 0, NULL, 0, NULL, 6, 1e-3f, meshopt_SimplifyLockBorder, NULL) == 9);
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopTopology);
+	assert(stats.passes == 0 && stats.collapses_performed == 0);
+	assert(stats.locked_vertices == 5);
+
+	// tetrahedron can't be simplified due to collapse error restrictions
+	float vb2[] = {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+	unsigned int ib2[] = {0, 1, 2, 0, 2, 3, 0, 3, 1, 2, 1, 3};
+
+	assert(meshopt_simplifyWithContext(context, ib2, ib2, 12, vb2, 4, 12, NULL, 0, NULL, 0, NULL, 6, 1e-3f, 0, NULL) == 12);
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopError);
+	assert(stats.passes == 1 && stats.collapses_evaluated == 1 && stats.collapses_performed == 0);
+	assert(stats.locked_vertices == 0);
+
+	// see simplifyFlip; with a large error limit, the mesh is simplified until all remaining collapses would flip triangles
+	float vb3[] = {1, 1, -1, 1, 1, 1, 1, -1, 1, 1, -0.2f, -0.2f, 1, 0.2f, -0.2f, 1, -0.2f, 0.2f, 1, 0.2f, 0.2f, 1, 0.5f, -0.5f, 1, -1, 0};
+	unsigned int ib3[] = {7, 4, 3, 1, 2, 5, 7, 1, 6, 7, 8, 0, 7, 6, 4, 8, 5, 2, 8, 7, 3, 8, 3, 5, 5, 6, 1, 7, 0, 1};
+
+	assert(meshopt_simplifyWithContext(context, ib3, ib3, 30, vb3, 9, 12, NULL, 0, NULL, 0, NULL, 3, 1.f, 0, NULL) == 9);
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopFlip);
+	assert(stats.passes == 3 && stats.collapses_performed == 5);
+	assert(stats.collapses_rejected_flip > 0);
+
+	// with a lower error limit, the last pass rejects some collapses due to flips and then reaches the error limit
+	unsigned int ib3e[] = {7, 4, 3, 1, 2, 5, 7, 1, 6, 7, 8, 0, 7, 6, 4, 8, 5, 2, 8, 7, 3, 8, 3, 5, 5, 6, 1, 7, 0, 1};
+
+	assert(meshopt_simplifyWithContext(context, ib3e, ib3e, 30, vb3, 9, 12, NULL, 0, NULL, 0, NULL, 3, 0.7f, 0, NULL) == 9);
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopError);
+	assert(stats.passes == 3 && stats.collapses_performed == 5);
+	assert(stats.collapses_rejected_flip > 0); // exact count depends on FMA contraction of the error math
+
+	// regular grid reaches the target
+	const unsigned int N = 10;
+
+	std::vector<float> vb4(N * N * 3);
+	for (unsigned int y = 0; y < N; ++y)
+		for (unsigned int x = 0; x < N; ++x)
+		{
+			vb4[(y * N + x) * 3 + 0] = float(x);
+			vb4[(y * N + x) * 3 + 1] = float(y);
+		}
+
+	std::vector<unsigned int> ib4;
+	for (unsigned int y = 0; y + 1 < N; ++y)
+		for (unsigned int x = 0; x + 1 < N; ++x)
+		{
+			unsigned int v0 = y * N + x, v1 = v0 + 1, v2 = v0 + N, v3 = v2 + 1;
+			unsigned int quad[] = {v0, v1, v3, v0, v3, v2};
+			ib4.insert(ib4.end(), quad, quad + 6);
+		}
+
+	size_t target = ib4.size() / 4 / 3 * 3;
+	assert(meshopt_simplifyWithContext(context, &ib4[0], &ib4[0], ib4.size(), &vb4[0], N * N, 12, NULL, 0, NULL, 0, NULL, target, 1e-2f, 0, NULL) <= target);
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopTarget);
+	assert(stats.passes > 0 && stats.collapses_performed > 0);
+	assert(stats.collapses_evaluated >= stats.collapses_performed + stats.collapses_rejected_locked + stats.collapses_rejected_flip);
+	assert(stats.locked_vertices == 0);
+	assert(stats.time_setup >= 0 && stats.time_quadrics >= 0 && stats.time_pick >= 0 && stats.time_rank >= 0 && stats.time_collapse >= 0);
+
+	meshopt_destroySimplifierContext(context);
+}
+
+static int simplifyCallbackCount(void* callback_data, size_t index_count, float error)
+{
+	int* calls = static_cast<int*>(callback_data);
+
+	assert(index_count % 3 == 0);
+	assert(error >= 0);
+	(void)index_count;
+	(void)error;
+
+	return --*calls > 0;
+}
+
+static void simplifyCancel()
+{
+	const unsigned int N = 10;
+
+	std::vector<float> vb(N * N * 3);
+	for (unsigned int y = 0; y < N; ++y)
+		for (unsigned int x = 0; x < N; ++x)
+		{
+			vb[(y * N + x) * 3 + 0] = float(x);
+			vb[(y * N + x) * 3 + 1] = float(y);
+			vb[(y * N + x) * 3 + 2] = float((x * y) % 3) * 0.1f;
+		}
+
+	std::vector<unsigned int> ib;
+	for (unsigned int y = 0; y + 1 < N; ++y)
+		for (unsigned int x = 0; x + 1 < N; ++x)
+		{
+			unsigned int v0 = y * N + x, v1 = v0 + 1, v2 = v0 + N, v3 = v2 + 1;
+			unsigned int quad[] = {v0, v1, v3, v0, v3, v2};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	std::vector<unsigned int> expected(ib.size());
+	float expected_error = 0;
+	size_t expected_count = meshopt_simplify(&expected[0], &ib[0], ib.size(), &vb[0], N * N, 12, 6, 1.f, 0, &expected_error);
+
+	meshopt_SimplifierContext* context = meshopt_createSimplifierContext();
+	meshopt_SimplifyStats stats = {};
+
+	std::vector<unsigned int> res(ib.size());
+	float error = 0;
+
+	// callback that never cancels doesn't affect the result
+	int calls = 1000;
+	meshopt_setSimplifierCallback(context, simplifyCallbackCount, &calls);
+	assert(meshopt_simplifyWithContext(context, &res[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, 6, 1.f, 0, &error) == expected_count);
+	assert(memcmp(&res[0], &expected[0], expected_count * sizeof(unsigned int)) == 0);
+	assert(error == expected_error);
+
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason != meshopt_SimplifyStopCancel);
+	assert(stats.passes > 2 && 1000 - calls >= int(stats.passes));
+
+	unsigned int passes = stats.passes;
+
+	// cancelling before the first pass returns the original mesh
+	calls = 1;
+	assert(meshopt_simplifyWithContext(context, &res[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, 6, 1.f, 0, &error) == ib.size());
+	assert(memcmp(&res[0], &ib[0], ib.size() * sizeof(unsigned int)) == 0);
+	assert(error == 0);
+
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopCancel && stats.passes == 0);
+
+	// cancelling after two passes returns an intermediate result
+	calls = 3;
+	size_t count = meshopt_simplifyWithContext(context, &res[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, 6, 1.f, 0, &error);
+	assert(count < ib.size() && count > expected_count);
+	assert(error <= expected_error);
+
+	meshopt_getSimplifierStats(context, &stats);
+	assert(stats.stop_reason == meshopt_SimplifyStopCancel && stats.passes == 2 && passes > 2);
+
+	meshopt_setSimplifierCallback(context, NULL, NULL);
+	assert(meshopt_simplifyWithContext(context, &res[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, 6, 1.f, 0, &error) == expected_count);
+
+	meshopt_destroySimplifierContext(context);
+}
+
+static void simplifyStream()
+{
+	const size_t N = 40;
+
+	std::vector<float> vb(N * N * 3);
+	for (size_t y = 0; y < N; ++y)
+		for (size_t x = 0; x < N; ++x)
+		{
+			float* v = &vb[(y * N + x) * 3];
+			v[0] = float(x);
+			v[1] = float(y);
+			v[2] = sinf(float(x) * 0.1f) * 2.f;
+		}
+
+	std::vector<unsigned int> ib;
+	for (size_t y = 0; y + 1 < N; ++y)
+		for (size_t x = 0; x + 1 < N; ++x)
+		{
+			unsigned int v0 = unsigned(y * N + x), v1 = v0 + 1, v2 = v0 + unsigned(N), v3 = v2 + 1;
+			unsigned int quad[] = {v0, v1, v3, v0, v3, v2};
+			ib.insert(ib.end(), quad, quad + 6);
+		}
+
+	// chunks need to be spatially coherent
+	meshopt_spatialSortTriangles(&ib[0], &ib[0], ib.size(), &vb[0], N * N, 12);
+
+	std::vector<unsigned int> res(ib.size());
+	float error = 0;
+
+	size_t target = ib.size() / 10 / 3 * 3;
+	size_t count = meshopt_simplifyStream(&res[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, target, 1e-2f, 0, 600, &error);
+
+	assert(count <= ib.size() / 4);
+	assert(error <= 1e-2f);
+
+	// result must be a valid index buffer without degenerate triangles
+	for (size_t i = 0; i < count; i += 3)
+	{
+		assert(res[i + 0] < N * N && res[i + 1] < N * N && res[i + 2] < N * N);
+		assert(res[i + 0] != res[i + 1] && res[i + 0] != res[i + 2] && res[i + 1] != res[i + 2]);
+	}
+
+	// grid corners can't be removed without changing the shape
+	unsigned int corners[] = {0, unsigned(N - 1), unsigned(N * N - N), unsigned(N * N - 1)};
+	for (size_t k = 0; k < 4; ++k)
+		assert(std::find(res.begin(), res.begin() + count, corners[k]) != res.begin() + count);
+
+	// in-place operation with a chunk that covers the entire mesh is equivalent to regular simplification
+	std::vector<unsigned int> ref(ib.size());
+	size_t refcount = meshopt_simplify(&ref[0], &ib[0], ib.size(), &vb[0], N * N, 12, target, 1e-2f, meshopt_SimplifySparse);
+
+	assert(meshopt_simplifyStream(&ib[0], &ib[0], ib.size(), &vb[0], N * N, 12, NULL, 0, NULL, 0, NULL, target, 1e-2f, 0, ib.size(), NULL) == refcount);
+	assert(memcmp(&ib[0], &ref[0], refcount * sizeof(unsigned int)) == 0);
+}
+
 static void adjacency()
 {
 	// 0 1/4
@@ -1667,6 +3445,30 @@ void runTests()
 	encodeFilterExpZero();
 
 	clusterBoundsDegenerate();
+	clusterBoundsLargeMeshlet();
+	computeMeshletBoundsBatch();
+	cullMeshlets();
+
+	buildMeshletsParallel();
+	buildMeshletsSpatial();
+	optimizeMeshletBatch();
+	packMeshletPages();
+	partitionClusters();
+	buildClusterHierarchy();
+
+	buildBvh();
+	buildPointHierarchy();
+
+	generateVertexRemapLarge();
+	generateVertexRemapParallel();
+	generateVertexRemapFuzzy();
+	generateIndexedMesh();
+	generateIndexedMeshLimit();
+	indexVertexBatch();
+
+	optimizeVertexCacheParallel();
+	analyzeVertexCacheMulti();
+	analyzeOverdrawViews();
 
 	customAllocator();
 
@@ -1676,6 +3478,7 @@ void runTests()
 	simplifyStuck();
 	simplifySloppyStuck();
 	simplifyPointsStuck();
+	simplifyPointsMulti();
 	simplifyFlip();
 	simplifyScale();
 	simplifyDegenerate();
@@ -1687,6 +3490,11 @@ void runTests()
 	simplifyErrorAbsolute();
 	simplifySeam();
 	simplifySeamFake();
+	simplifyLowMemory();
+	simplifyContext();
+	simplifyStats();
+	simplifyCancel();
+	simplifyStream();
 
 	adjacency();
 	tessellation();
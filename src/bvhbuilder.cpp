@@ -0,0 +1,474 @@
+// This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
+#include "meshoptimizer.h"
+
+#include <assert.h>
+#include <float.h>
+#include <string.h>
+
+// This work is based on:
+// Ingo Wald. On fast Construction of SAH-based Bounding Volume Hierarchies. 2007
+// Jacopo Pantaleoni, David Luebke. HLBVH: Hierarchical LBVH Construction for Real-Time Ray Tracing of Dynamic Geometry. 2010
+// Holger Dammertz, Johannes Hanika, Alexander Keller. Shallow Bounding Volume Hierarchies for Fast SIMD Ray Tracing of Incoherent Rays. 2008
+namespace meshopt
+{
+
+// primitives are split into chunks along Morton order; each chunk is built as an independent task
+const size_t kBvhChunkSize = 4096;
+
+const size_t kBvhBinCount = 16;
+
+struct BvhBox
+{
+	float min[3];
+	float max[3];
+};
+
+struct BvhBuildNode
+{
+	BvhBox box;
+
+	// inner nodes refer to two child nodes; leaves refer to a range of primitive indices
+	unsigned int left, right;
+	unsigned int offset, count;
+};
+
+struct BvhBuilder
+{
+	const float* boxes;
+	const float* centroids;
+
+	unsigned int* items;
+	BvhBuildNode* nodes;
+	unsigned int* stack;
+
+	size_t primitive_count;
+	size_t chunk_count;
+	size_t max_leaf_size;
+};
+
+static void resetBvhBox(BvhBox& box)
+{
+	box.min[0] = box.min[1] = box.min[2] = FLT_MAX;
+	box.max[0] = box.max[1] = box.max[2] = -FLT_MAX;
+}
+
+static void mergeBvhBox(BvhBox& box, const float* min, const float* max)
+{
+	for (int k = 0; k < 3; ++k)
+	{
+		box.min[k] = min[k] < box.min[k] ? min[k] : box.min[k];
+		box.max[k] = max[k] > box.max[k] ? max[k] : box.max[k];
+	}
+}
+
+static float getBvhBoxArea(const BvhBox& box)
+{
+	float sx = box.max[0] - box.min[0], sy = box.max[1] - box.min[1], sz = box.max[2] - box.min[2];
+
+	// empty boxes have negative extents; half of the surface area is sufficient for comparisons
+	return (sx < 0 || sy < 0 || sz < 0) ? 0.f : sx * sy + sy * sz + sz * sx;
+}
+
+static size_t getBvhChunkStart(size_t primitive_count, size_t chunk_count, size_t chunk)
+{
+	return primitive_count * chunk / chunk_count;
+}
+
+// returns the number of items in the left half after partitioning them in place, or 0 if the items should form a leaf
+static size_t splitBvhItems(BvhBox& box, unsigned int* items, size_t count, const float* boxes, const float* centroids, size_t max_leaf_size)
+{
+	BvhBox cbox;
+	resetBvhBox(box);
+	resetBvhBox(cbox);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		unsigned int item = items[i];
+
+		mergeBvhBox(box, &boxes[item * 6 + 0], &boxes[item * 6 + 3]);
+		mergeBvhBox(cbox, &centroids[item * 3], &centroids[item * 3]);
+	}
+
+	if (count <= 1)
+		return 0;
+
+	float best_cost = FLT_MAX;
+	int best_axis = -1;
+	size_t best_bin = 0;
+
+	float scale[3];
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float extent = cbox.max[axis] - cbox.min[axis];
+
+		scale[axis] = extent > 0 ? float(kBvhBinCount) / extent : 0.f;
+	}
+
+	// binned SAH: all 3 axes are binned in the same pass
+	BvhBox bins[3][kBvhBinCount];
+	size_t bin_counts[3][kBvhBinCount] = {};
+
+	for (int axis = 0; axis < 3; ++axis)
+		for (size_t i = 0; i < kBvhBinCount; ++i)
+			resetBvhBox(bins[axis][i]);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		unsigned int item = items[i];
+
+		const float* bmin = &boxes[item * 6 + 0];
+		const float* bmax = &boxes[item * 6 + 3];
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			size_t bin = size_t((centroids[item * 3 + axis] - cbox.min[axis]) * scale[axis]);
+			bin = bin < kBvhBinCount ? bin : kBvhBinCount - 1;
+
+			mergeBvhBox(bins[axis][bin], bmin, bmax);
+			bin_counts[axis][bin]++;
+		}
+	}
+
+	// right to left sweep computes costs of right halves, left to right sweep completes the split costs
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (scale[axis] == 0)
+			continue;
+
+		float right_costs[kBvhBinCount];
+		size_t right_counts[kBvhBinCount];
+
+		BvhBox acc;
+		resetBvhBox(acc);
+		size_t acc_count = 0;
+
+		for (size_t i = kBvhBinCount - 1; i > 0; --i)
+		{
+			mergeBvhBox(acc, bins[axis][i].min, bins[axis][i].max);
+			acc_count += bin_counts[axis][i];
+
+			right_costs[i] = getBvhBoxArea(acc) * float(acc_count);
+			right_counts[i] = acc_count;
+		}
+
+		resetBvhBox(acc);
+		acc_count = 0;
+
+		for (size_t i = 0; i < kBvhBinCount - 1; ++i)
+		{
+			mergeBvhBox(acc, bins[axis][i].min, bins[axis][i].max);
+			acc_count += bin_counts[axis][i];
+
+			if (acc_count == 0 || right_counts[i + 1] == 0)
+				continue;
+
+			float cost = getBvhBoxArea(acc) * float(acc_count) + right_costs[i + 1];
+
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_axis = axis;
+				best_bin = i + 1;
+			}
+		}
+	}
+
+	// all centroids are the same; split in the middle to respect leaf size limit
+	if (best_axis < 0)
+		return count <= max_leaf_size ? 0 : count / 2;
+
+	// traversal cost is the same as intersection cost of one primitive
+	float area = getBvhBoxArea(box);
+
+	if (count <= max_leaf_size && area * float(count) <= area + best_cost)
+		return 0;
+
+	size_t left = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		unsigned int item = items[i];
+
+		size_t bin = size_t((centroids[item * 3 + best_axis] - cbox.min[best_axis]) * scale[best_axis]);
+		bin = bin < kBvhBinCount ? bin : kBvhBinCount - 1;
+
+		if (bin < best_bin)
+		{
+			items[i] = items[left];
+			items[left] = item;
+			left++;
+		}
+	}
+
+	assert(left > 0 && left < count);
+	return left;
+}
+
+static void buildBvhChunkTask(void* context, size_t index)
+{
+	const BvhBuilder& b = *static_cast<const BvhBuilder*>(context);
+
+	size_t begin = getBvhChunkStart(b.primitive_count, b.chunk_count, index);
+	size_t end = getBvhChunkStart(b.primitive_count, b.chunk_count, index + 1);
+
+	// a subtree over k primitives has at most 2k-1 nodes; chunk subtrees are packed in chunk order, and the root of a range is stored first
+	// stack uses the chunk range of scratch memory, since pending ranges are disjoint and non-empty there are at most k of them
+	unsigned int* stack = b.stack + begin * 3;
+	size_t stack_size = 0;
+
+	stack[stack_size++] = unsigned(2 * begin - index);
+	stack[stack_size++] = unsigned(begin);
+	stack[stack_size++] = unsigned(end);
+
+	while (stack_size)
+	{
+		size_t range_end = stack[--stack_size];
+		size_t range_begin = stack[--stack_size];
+		size_t slot = stack[--stack_size];
+
+		BvhBuildNode& node = b.nodes[slot];
+
+		size_t left = splitBvhItems(node.box, b.items + range_begin, range_end - range_begin, b.boxes, b.centroids, b.max_leaf_size);
+
+		if (left == 0)
+		{
+			node.left = node.right = ~0u;
+			node.offset = unsigned(range_begin);
+			node.count = unsigned(range_end - range_begin);
+			continue;
+		}
+
+		node.left = unsigned(slot + 1);
+		node.right = unsigned(slot + 2 * left);
+		node.offset = 0;
+		node.count = 0;
+
+		stack[stack_size++] = node.right;
+		stack[stack_size++] = unsigned(range_begin + left);
+		stack[stack_size++] = unsigned(range_end);
+
+		stack[stack_size++] = node.left;
+		stack[stack_size++] = unsigned(range_begin);
+		stack[stack_size++] = unsigned(range_begin + left);
+	}
+}
+
+static unsigned int buildBvhTop(BvhBuildNode* nodes, size_t& next_slot, unsigned int* chunks, size_t count, const float* chunk_boxes, const float* chunk_centroids, const unsigned int* chunk_roots)
+{
+	if (count == 1)
+		return chunk_roots[chunks[0]];
+
+	BvhBox box;
+	size_t left = splitBvhItems(box, chunks, count, chunk_boxes, chunk_centroids, 1);
+	assert(left > 0);
+
+	unsigned int left_root = buildBvhTop(nodes, next_slot, chunks, left, chunk_boxes, chunk_centroids, chunk_roots);
+	unsigned int right_root = buildBvhTop(nodes, next_slot, chunks + left, count - left, chunk_boxes, chunk_centroids, chunk_roots);
+
+	unsigned int slot = unsigned(next_slot++);
+
+	BvhBuildNode& node = nodes[slot];
+	node.box = box;
+	node.left = left_root;
+	node.right = right_root;
+	node.offset = 0;
+	node.count = 0;
+
+	return slot;
+}
+
+static unsigned int collapseBvh(meshopt_BvhNode* result, size_t& result_count, const BvhBuildNode* nodes, unsigned int root)
+{
+	unsigned int children[4] = {root};
+	size_t child_count = 1;
+
+	// expand the largest inner child until we have 4 children; this keeps the boxes that are tested together as small as possible
+	while (child_count < 4)
+	{
+		size_t best = ~size_t(0);
+		float best_area = -1.f;
+
+		for (size_t i = 0; i < child_count; ++i)
+		{
+			const BvhBuildNode& child = nodes[children[i]];
+
+			if (child.count == 0 && getBvhBoxArea(child.box) > best_area)
+			{
+				best = i;
+				best_area = getBvhBoxArea(child.box);
+			}
+		}
+
+		if (best == ~size_t(0))
+			break;
+
+		unsigned int expand = children[best];
+
+		children[best] = nodes[expand].left;
+		children[child_count++] = nodes[expand].right;
+	}
+
+	// nodes are emitted in depth-first order, so the first inner child immediately follows its parent
+	unsigned int index = unsigned(result_count++);
+	meshopt_BvhNode& node = result[index];
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		if (i < child_count)
+		{
+			const BvhBuildNode& child = nodes[children[i]];
+
+			node.min_x[i] = child.box.min[0];
+			node.min_y[i] = child.box.min[1];
+			node.min_z[i] = child.box.min[2];
+			node.max_x[i] = child.box.max[0];
+			node.max_y[i] = child.box.max[1];
+			node.max_z[i] = child.box.max[2];
+
+			node.children[i] = child.count ? child.offset : collapseBvh(result, result_count, nodes, children[i]);
+			node.counts[i] = child.count;
+		}
+		else
+		{
+			node.min_x[i] = node.min_y[i] = node.min_z[i] = FLT_MAX;
+			node.max_x[i] = node.max_y[i] = node.max_z[i] = -FLT_MAX;
+
+			node.children[i] = ~0u;
+			node.counts[i] = 0;
+		}
+	}
+
+	return index;
+}
+
+} // namespace meshopt
+
+size_t meshopt_buildBvhBound(size_t primitive_count)
+{
+	// every output node after the first one corresponds to a distinct inner node of a binary tree with at most primitive_count-1 inner nodes
+	return primitive_count > 1 ? primitive_count - 1 : 1;
+}
+
+size_t meshopt_buildBvh(meshopt_BvhNode* nodes, unsigned int* primitive_indices, const float* primitive_boxes, size_t primitive_count, size_t max_leaf_size, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(max_leaf_size >= 1);
+
+	if (primitive_count == 0)
+		return 0;
+
+	meshopt_Allocator allocator;
+
+	float* centroids = allocator.allocate<float>(primitive_count * 3);
+
+	for (size_t i = 0; i < primitive_count; ++i)
+		for (int k = 0; k < 3; ++k)
+			centroids[i * 3 + k] = (primitive_boxes[i * 6 + k] + primitive_boxes[i * 6 + 3 + k]) * 0.5f;
+
+	size_t chunk_count = (primitive_count + kBvhChunkSize - 1) / kBvhChunkSize;
+
+	unsigned int* stack = allocator.allocate<unsigned int>(primitive_count * 3);
+
+	// sort primitives along Morton curve so that each chunk is spatially coherent
+	if (chunk_count > 1)
+	{
+		unsigned int* remap = stack;
+		meshopt_spatialSortRemap(remap, centroids, primitive_count, sizeof(float) * 3);
+
+		for (size_t i = 0; i < primitive_count; ++i)
+			primitive_indices[remap[i]] = unsigned(i);
+	}
+	else
+	{
+		for (size_t i = 0; i < primitive_count; ++i)
+			primitive_indices[i] = unsigned(i);
+	}
+
+	BvhBuildNode* build_nodes = allocator.allocate<BvhBuildNode>(primitive_count * 2 - 1);
+
+	BvhBuilder builder = {};
+	builder.boxes = primitive_boxes;
+	builder.centroids = centroids;
+	builder.items = primitive_indices;
+	builder.nodes = build_nodes;
+	builder.stack = stack;
+	builder.primitive_count = primitive_count;
+	builder.chunk_count = chunk_count;
+	builder.max_leaf_size = max_leaf_size;
+
+	meshopt_runTasks(scheduler, scheduler_context, buildBvhChunkTask, &builder, chunk_count);
+
+	// chunk subtrees are combined using SAH over chunk bounds; top nodes are stored after all chunk subtrees
+	unsigned int* chunk_data = allocator.allocate<unsigned int>(chunk_count * 2);
+	unsigned int* chunk_roots = chunk_data;
+	unsigned int* chunks = chunk_data + chunk_count;
+
+	float* chunk_bounds = allocator.allocate<float>(chunk_count * 9);
+	float* chunk_boxes = chunk_bounds;
+	float* chunk_centroids = chunk_bounds + chunk_count * 6;
+
+	for (size_t i = 0; i < chunk_count; ++i)
+	{
+		size_t root = 2 * getBvhChunkStart(primitive_count, chunk_count, i) - i;
+		const BvhBox& box = build_nodes[root].box;
+
+		chunk_roots[i] = unsigned(root);
+		chunks[i] = unsigned(i);
+
+		memcpy(&chunk_boxes[i * 6 + 0], box.min, sizeof(float) * 3);
+		memcpy(&chunk_boxes[i * 6 + 3], box.max, sizeof(float) * 3);
+
+		for (int k = 0; k < 3; ++k)
+			chunk_centroids[i * 3 + k] = (box.min[k] + box.max[k]) * 0.5f;
+	}
+
+	size_t next_slot = primitive_count * 2 - chunk_count;
+	unsigned int root = buildBvhTop(build_nodes, next_slot, chunks, chunk_count, chunk_boxes, chunk_centroids, chunk_roots);
+	assert(next_slot == primitive_count * 2 - 1);
+
+	size_t result = 0;
+	collapseBvh(nodes, result, build_nodes, root);
+
+	assert(result <= meshopt_buildBvhBound(primitive_count));
+	return result;
+}
+
+size_t meshopt_buildBvhTriangles(meshopt_BvhNode* nodes, unsigned int* primitive_indices, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_leaf_size, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	(void)vertex_count;
+
+	size_t face_count = index_count / 3;
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	meshopt_Allocator allocator;
+
+	float* boxes = allocator.allocate<float>(face_count * 6);
+
+	for (size_t i = 0; i < face_count; ++i)
+	{
+		BvhBox box;
+		resetBvhBox(box);
+
+		for (int j = 0; j < 3; ++j)
+		{
+			unsigned int index = indices[i * 3 + j];
+			assert(index < vertex_count);
+
+			const float* p = vertex_positions + index * vertex_stride_float;
+			mergeBvhBox(box, p, p);
+		}
+
+		memcpy(&boxes[i * 6 + 0], box.min, sizeof(float) * 3);
+		memcpy(&boxes[i * 6 + 3], box.max, sizeof(float) * 3);
+	}
+
+	return meshopt_buildBvh(nodes, primitive_indices, boxes, face_count, max_leaf_size, scheduler, scheduler_context);
+}
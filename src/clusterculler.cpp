@@ -0,0 +1,359 @@
+// This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
+#include "meshoptimizer.h"
+
+#include <assert.h>
+#include <math.h>
+
+// The block below auto-detects SIMD ISA that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// The SIMD implementation requires SSE2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE2__)
+#define SIMD_SSE
+#endif
+
+// MSVC supports compiling SSE2 code regardless of compile options; we assume all 32-bit CPUs support SSE2
+#if !defined(SIMD_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define SIMD_SSE
+#endif
+
+// The NEON implementation requires vsqrtq_f32 which is only available on AArch64
+#if (defined(__ARM_NEON__) || defined(__ARM_NEON)) && defined(__aarch64__)
+#define SIMD_NEON
+#endif
+
+#if !defined(SIMD_NEON) && defined(_MSC_VER) && defined(_M_ARM64)
+#define SIMD_NEON
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+#ifdef SIMD_NEON
+#if defined(_MSC_VER) && defined(_M_ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace meshopt
+{
+
+struct CullingState
+{
+	const float* planes;
+	size_t plane_count;
+
+	const float* camera;
+};
+
+static bool isVisibleScalar(const CullingState& state, const meshopt_Bounds& bounds)
+{
+	const float* c = bounds.center;
+	float r = bounds.radius;
+
+	// sphere is outside of the frustum if it's fully behind any plane
+	for (size_t i = 0; i < state.plane_count; ++i)
+	{
+		const float* p = &state.planes[i * 4];
+
+		if (p[0] * c[0] + p[1] * c[1] + p[2] * c[2] + p[3] < -r)
+			return false;
+	}
+
+	// dot(center - camera_position, cone_axis) >= cone_cutoff * length(center - camera_position) + radius
+	if (state.camera)
+	{
+		float v[3] = {c[0] - state.camera[0], c[1] - state.camera[1], c[2] - state.camera[2]};
+		float vl = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+		if (v[0] * bounds.cone_axis[0] + v[1] * bounds.cone_axis[1] + v[2] * bounds.cone_axis[2] >= bounds.cone_cutoff * vl + r)
+			return false;
+	}
+
+	return true;
+}
+
+static bool isOccluded(const meshopt_DepthPyramid& pyramid, const meshopt_Bounds& bounds)
+{
+	const float* m = pyramid.view_projection;
+
+	float minx = 1, miny = 1, maxx = -1, maxy = -1, minz = 1;
+
+	// project the corners of the box around the sphere to get a conservative screen space rectangle and nearest depth
+	for (int i = 0; i < 8; ++i)
+	{
+		float x = bounds.center[0] + ((i & 1) ? bounds.radius : -bounds.radius);
+		float y = bounds.center[1] + ((i & 2) ? bounds.radius : -bounds.radius);
+		float z = bounds.center[2] + ((i & 4) ? bounds.radius : -bounds.radius);
+
+		float cx = m[0] * x + m[4] * y + m[8] * z + m[12];
+		float cy = m[1] * x + m[5] * y + m[9] * z + m[13];
+		float cz = m[2] * x + m[6] * y + m[10] * z + m[14];
+		float cw = m[3] * x + m[7] * y + m[11] * z + m[15];
+
+		// the box intersects the near plane or is behind the camera; it can't be tested reliably
+		if (cz <= 0 || cw <= 0)
+			return false;
+
+		float iw = 1.f / cw;
+
+		minx = (cx * iw < minx) ? cx * iw : minx;
+		miny = (cy * iw < miny) ? cy * iw : miny;
+		maxx = (cx * iw > maxx) ? cx * iw : maxx;
+		maxy = (cy * iw > maxy) ? cy * iw : maxy;
+		minz = (cz * iw < minz) ? cz * iw : minz;
+	}
+
+	// clamp the rectangle to the screen; fully offscreen boxes are left to frustum culling
+	minx = minx < -1 ? -1 : minx;
+	miny = miny < -1 ? -1 : miny;
+	maxx = maxx > 1 ? 1 : maxx;
+	maxy = maxy > 1 ? 1 : maxy;
+
+	if (minx > maxx || miny > maxy)
+		return false;
+
+	size_t width = pyramid.width, height = pyramid.height;
+
+	size_t x0 = size_t((minx * 0.5f + 0.5f) * float(width));
+	size_t y0 = size_t((miny * 0.5f + 0.5f) * float(height));
+	size_t x1 = size_t((maxx * 0.5f + 0.5f) * float(width));
+	size_t y1 = size_t((maxy * 0.5f + 0.5f) * float(height));
+
+	x0 = x0 < width ? x0 : width - 1;
+	y0 = y0 < height ? y0 : height - 1;
+	x1 = x1 < width ? x1 : width - 1;
+	y1 = y1 < height ? y1 : height - 1;
+
+	// pick the finest level where the rectangle covers at most 2x2 texels
+	const float* data = pyramid.data;
+	size_t level = 0;
+
+	while (level + 1 < pyramid.levels && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+	{
+		data += width * height;
+
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		level++;
+	}
+
+	size_t lx0 = x0 >> level, ly0 = y0 >> level;
+	size_t lx1 = x1 >> level, ly1 = y1 >> level;
+
+	// odd dimensions round down, so the last texel of a level is covered by the last texel of the next level
+	lx0 = lx0 < width ? lx0 : width - 1;
+	ly0 = ly0 < height ? ly0 : height - 1;
+	lx1 = lx1 < width ? lx1 : width - 1;
+	ly1 = ly1 < height ? ly1 : height - 1;
+
+	float depth = 0;
+
+	for (size_t y = ly0; y <= ly1; ++y)
+		for (size_t x = lx0; x <= lx1; ++x)
+			depth = data[y * width + x] > depth ? data[y * width + x] : depth;
+
+	return minz > depth;
+}
+
+#if defined(SIMD_SSE) || defined(SIMD_NEON)
+#ifdef SIMD_SSE
+typedef __m128 Vec4;
+
+inline Vec4 vec4Load(const float* data)
+{
+	return _mm_loadu_ps(data);
+}
+
+inline Vec4 vec4Splat(float value)
+{
+	return _mm_set1_ps(value);
+}
+
+inline void vec4Transpose(Vec4& r0, Vec4& r1, Vec4& r2, Vec4& r3)
+{
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+#define vec4Add _mm_add_ps
+#define vec4Sub _mm_sub_ps
+#define vec4Mul _mm_mul_ps
+#define vec4Sqrt _mm_sqrt_ps
+#define vec4Or _mm_or_ps
+#define vec4Less _mm_cmplt_ps
+#define vec4GreaterEqual _mm_cmpge_ps
+
+inline int vec4Mask(Vec4 mask)
+{
+	return _mm_movemask_ps(mask);
+}
+
+inline Vec4 vec4False()
+{
+	return _mm_setzero_ps();
+}
+#endif
+
+#ifdef SIMD_NEON
+typedef float32x4_t Vec4;
+
+inline Vec4 vec4Load(const float* data)
+{
+	return vld1q_f32(data);
+}
+
+inline Vec4 vec4Splat(float value)
+{
+	return vdupq_n_f32(value);
+}
+
+inline void vec4Transpose(Vec4& r0, Vec4& r1, Vec4& r2, Vec4& r3)
+{
+	float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	float32x4x2_t t23 = vtrnq_f32(r2, r3);
+
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+#define vec4Add vaddq_f32
+#define vec4Sub vsubq_f32
+#define vec4Mul vmulq_f32
+#define vec4Sqrt vsqrtq_f32
+
+inline Vec4 vec4Or(Vec4 a, Vec4 b)
+{
+	return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline Vec4 vec4Less(Vec4 a, Vec4 b)
+{
+	return vreinterpretq_f32_u32(vcltq_f32(a, b));
+}
+
+inline Vec4 vec4GreaterEqual(Vec4 a, Vec4 b)
+{
+	return vreinterpretq_f32_u32(vcgeq_f32(a, b));
+}
+
+inline int vec4Mask(Vec4 mask)
+{
+	static const int32_t kMaskBits[4] = {1, 2, 4, 8};
+
+	uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(mask), vreinterpretq_u32_s32(vld1q_s32(kMaskBits)));
+
+	return int(vaddvq_u32(bits));
+}
+
+inline Vec4 vec4False()
+{
+	return vdupq_n_f32(0.f);
+}
+#endif
+
+static int getVisibleMask4(const CullingState& state, const meshopt_Bounds* bounds)
+{
+	// center and radius occupy the first 4 floats, cone axis and cutoff occupy 4 floats starting from cone_axis
+	Vec4 cx = vec4Load(bounds[0].center), cy = vec4Load(bounds[1].center), cz = vec4Load(bounds[2].center), cr = vec4Load(bounds[3].center);
+	vec4Transpose(cx, cy, cz, cr);
+
+	// after transposition, the fourth vector contains radii
+	Vec4 r = cr;
+
+	Vec4 culled = vec4False();
+
+	for (size_t i = 0; i < state.plane_count; ++i)
+	{
+		const float* p = &state.planes[i * 4];
+
+		Vec4 d = vec4Add(vec4Add(vec4Add(vec4Mul(vec4Splat(p[0]), cx), vec4Mul(vec4Splat(p[1]), cy)), vec4Mul(vec4Splat(p[2]), cz)), vec4Splat(p[3]));
+
+		culled = vec4Or(culled, vec4Less(d, vec4Sub(vec4False(), r)));
+	}
+
+	if (state.camera)
+	{
+		Vec4 ax = vec4Load(bounds[0].cone_axis), ay = vec4Load(bounds[1].cone_axis), az = vec4Load(bounds[2].cone_axis), ac = vec4Load(bounds[3].cone_axis);
+		vec4Transpose(ax, ay, az, ac);
+
+		Vec4 vx = vec4Sub(cx, vec4Splat(state.camera[0]));
+		Vec4 vy = vec4Sub(cy, vec4Splat(state.camera[1]));
+		Vec4 vz = vec4Sub(cz, vec4Splat(state.camera[2]));
+
+		Vec4 vl = vec4Sqrt(vec4Add(vec4Add(vec4Mul(vx, vx), vec4Mul(vy, vy)), vec4Mul(vz, vz)));
+		Vec4 dp = vec4Add(vec4Add(vec4Mul(vx, ax), vec4Mul(vy, ay)), vec4Mul(vz, az));
+
+		culled = vec4Or(culled, vec4GreaterEqual(dp, vec4Add(vec4Mul(ac, vl), r)));
+	}
+
+	return ~vec4Mask(culled) & 15;
+}
+#endif
+
+} // namespace meshopt
+
+size_t meshopt_cullMeshlets(unsigned int* destination, const meshopt_Bounds* bounds, size_t bounds_count, const float* frustum_planes, size_t plane_count, const float* camera_position, const meshopt_DepthPyramid* depth_pyramid)
+{
+	using namespace meshopt;
+
+	assert(frustum_planes || plane_count == 0);
+	assert(!depth_pyramid || (depth_pyramid->data && depth_pyramid->width > 0 && depth_pyramid->height > 0 && depth_pyramid->levels > 0));
+
+	CullingState state = {frustum_planes, plane_count, camera_position};
+
+	size_t result = 0;
+	size_t i = 0;
+
+#if defined(SIMD_SSE) || defined(SIMD_NEON)
+	for (; i + 4 <= bounds_count; i += 4)
+	{
+		int mask = getVisibleMask4(state, &bounds[i]);
+
+		// the frustum and cone tests are cheap; occlusion test is only performed for bounds that passed them
+		if (depth_pyramid && mask)
+		{
+			for (int k = 0; k < 4; ++k)
+				if ((mask & (1 << k)) && isOccluded(*depth_pyramid, bounds[i + k]))
+					mask &= ~(1 << k);
+		}
+
+		// branchless compaction: result <= i + k, so the store is always in bounds
+		for (int k = 0; k < 4; ++k)
+		{
+			destination[result] = unsigned(i + k);
+			result += (mask >> k) & 1;
+		}
+	}
+#endif
+
+	for (; i < bounds_count; ++i)
+	{
+		if (!isVisibleScalar(state, bounds[i]))
+			continue;
+
+		if (depth_pyramid && isOccluded(*depth_pyramid, bounds[i]))
+			continue;
+
+		destination[result++] = unsigned(i);
+	}
+
+	return result;
+}
+
+#undef vec4Add
+#undef vec4Sub
+#undef vec4Mul
+#undef vec4Sqrt
+#undef vec4Or
+#undef vec4Less
+#undef vec4GreaterEqual
+
+#undef SIMD_SSE
+#undef SIMD_NEON
@@ -0,0 +1,457 @@
+// This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
+#include "meshoptimizer.h"
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+// This work is based on:
+// Brian Karis, Rune Stubbe, Graham Wihlidal. Nanite: A Deep Dive. 2021
+namespace meshopt
+{
+
+// groups of each level are split into at most this many batches; each batch owns a simplifier context that is reused across groups and levels
+const size_t kHierarchyBatchCount = 64;
+
+// number of clusters merged into each group; simplifying the group to half of its size keeps the number of clusters per level decreasing
+const size_t kHierarchyGroupSize = 4;
+
+struct HierarchyGroup
+{
+	// range of pending clusters merged into the group
+	size_t pending_offset;
+	size_t pending_count;
+
+	// merged indices and split meshlets are stored in per-group ranges of level scratch memory
+	size_t index_offset;
+	size_t index_count;
+	size_t meshlet_offset;
+
+	bool accepted;
+	size_t result_count;
+	size_t result_index_count;
+	meshopt_LODBounds bounds;
+};
+
+struct HierarchyLevel
+{
+	const float* vertex_positions;
+	size_t vertex_count;
+	size_t vertex_positions_stride;
+	size_t max_vertices;
+	size_t max_triangles;
+
+	const meshopt_Cluster* clusters;
+	const unsigned int* cluster_indices;
+	const unsigned int* pending;
+
+	HierarchyGroup* groups;
+	size_t group_count;
+	size_t batch_size;
+
+	meshopt_SimplifierContext** contexts;
+
+	unsigned int* merged;
+	unsigned int* simplified;
+	meshopt_Meshlet* meshlets;
+	unsigned int* meshlet_vertices;
+	unsigned char* meshlet_triangles;
+};
+
+static meshopt_LODBounds mergeLODBounds(const meshopt_Cluster* clusters, const unsigned int* ids, size_t count)
+{
+	meshopt_LODBounds result = {};
+
+	// merged center is a weighted average of cluster centers; precise bounds of the merged geometry can't be used as they may violate monotonicity
+	float weight = 0.f;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const meshopt_LODBounds& self = clusters[ids[i]].self;
+
+		result.center[0] += self.center[0] * self.radius;
+		result.center[1] += self.center[1] * self.radius;
+		result.center[2] += self.center[2] * self.radius;
+		weight += self.radius;
+	}
+
+	if (weight > 0)
+	{
+		result.center[0] /= weight;
+		result.center[1] /= weight;
+		result.center[2] /= weight;
+	}
+
+	// merged bounds must contain all cluster bounds, and merged error must be conservative wrt cluster errors
+	for (size_t i = 0; i < count; ++i)
+	{
+		const meshopt_LODBounds& self = clusters[ids[i]].self;
+
+		float dx = self.center[0] - result.center[0];
+		float dy = self.center[1] - result.center[1];
+		float dz = self.center[2] - result.center[2];
+		float radius = self.radius + sqrtf(dx * dx + dy * dy + dz * dz);
+
+		result.radius = result.radius < radius ? radius : result.radius;
+		result.error = result.error < self.error ? self.error : result.error;
+	}
+
+	return result;
+}
+
+static size_t unpackMeshlets(unsigned int* destination, meshopt_Meshlet* meshlets, size_t meshlet_count, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles)
+{
+	size_t offset = 0;
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		const meshopt_Meshlet& meshlet = meshlets[i];
+
+		meshopt_optimizeMeshlet(&meshlet_vertices[meshlet.vertex_offset], &meshlet_triangles[meshlet.triangle_offset], meshlet.triangle_count, meshlet.vertex_count);
+
+		for (size_t j = 0; j < meshlet.triangle_count * 3; ++j)
+			destination[offset++] = meshlet_vertices[meshlet.vertex_offset + meshlet_triangles[meshlet.triangle_offset + j]];
+	}
+
+	return offset;
+}
+
+static void simplifyHierarchyGroup(const HierarchyLevel& level, HierarchyGroup& group, meshopt_SimplifierContext* context)
+{
+	group.accepted = false;
+
+	if (group.pending_count < 2)
+		return;
+
+	unsigned int* merged = level.merged + group.index_offset;
+	size_t merged_count = 0;
+
+	for (size_t i = 0; i < group.pending_count; ++i)
+	{
+		const meshopt_Cluster& cluster = level.clusters[level.pending[group.pending_offset + i]];
+
+		memcpy(merged + merged_count, level.cluster_indices + cluster.index_offset, cluster.index_count * sizeof(unsigned int));
+		merged_count += cluster.index_count;
+	}
+
+	assert(merged_count == group.index_count);
+
+	size_t target_index_count = level.max_triangles * 2 * 3;
+	if (merged_count <= target_index_count)
+		return;
+
+	unsigned int* simplified = level.simplified + group.index_offset;
+	unsigned int options = meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute;
+	float error = 0.f;
+
+	size_t simplified_count = meshopt_simplifyWithContext(context, simplified, merged, merged_count, level.vertex_positions, level.vertex_count, level.vertex_positions_stride, NULL, 0, NULL, 0, NULL, target_index_count, FLT_MAX, options, &error);
+
+	// simplification is stuck; abandon the merge so that the clusters can be retried at the next level
+	if (simplified_count * 20 > merged_count * 17 || simplified_count > level.max_triangles * 3 * 3)
+		return;
+
+	// this may overestimate the error, but we are starting from the simplified mesh so this is a little more correct
+	group.bounds = mergeLODBounds(level.clusters, level.pending + group.pending_offset, group.pending_count);
+	group.bounds.error += error;
+
+	meshopt_Meshlet* meshlets = level.meshlets + group.meshlet_offset;
+	unsigned int* meshlet_vertices = level.meshlet_vertices + group.meshlet_offset * level.max_vertices;
+	unsigned char* meshlet_triangles = level.meshlet_triangles + group.meshlet_offset * level.max_triangles * 3;
+
+	size_t meshlet_count = meshopt_buildMeshlets(meshlets, meshlet_vertices, meshlet_triangles, simplified, simplified_count, level.vertex_positions, level.vertex_count, level.vertex_positions_stride, level.max_vertices, level.max_triangles, 0.f);
+
+	// merged indices are no longer needed, so they are replaced with indices of the resulting clusters
+	group.accepted = true;
+	group.result_count = meshlet_count;
+	group.result_index_count = unpackMeshlets(merged, meshlets, meshlet_count, meshlet_vertices, meshlet_triangles);
+
+	assert(group.result_index_count == simplified_count);
+}
+
+static void simplifyHierarchyTask(void* context, size_t index)
+{
+	const HierarchyLevel& level = *static_cast<const HierarchyLevel*>(context);
+
+	size_t begin = index * level.batch_size;
+	size_t end = begin + level.batch_size < level.group_count ? begin + level.batch_size : level.group_count;
+
+	for (size_t i = begin; i < end; ++i)
+		simplifyHierarchyGroup(level, level.groups[i], level.contexts[index]);
+}
+
+} // namespace meshopt
+
+size_t meshopt_buildClusterHierarchyBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+{
+	assert(index_count % 3 == 0);
+	assert(max_vertices >= 3 && max_triangles >= 1);
+
+	if (index_count == 0)
+		return 0;
+
+	// every meshlet built from a group accounts for at least this many indices, except for the last meshlet of each group
+	size_t meshlet_indices = max_vertices - 2 < max_triangles * 3 ? max_vertices - 2 : max_triangles * 3;
+
+	// every accepted group reduces the index count by at least 15%, so coarser levels have at most 17/3 * index_count indices in total
+	size_t lod_indices = index_count / 3 * 17;
+
+	// each group merges at least two clusters, so the number of groups is at most half of the number of clusters
+	return 2 * (meshopt_buildMeshletsParallelBound(index_count, max_vertices, max_triangles) + lod_indices / meshlet_indices + 1);
+}
+
+size_t meshopt_buildClusterHierarchy(meshopt_Cluster* clusters, unsigned int* cluster_indices, meshopt_ClusterGroup* groups, unsigned int* group_clusters, size_t* group_count, size_t max_clusters, size_t max_cluster_indices, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	*group_count = 0;
+
+	if (index_count == 0)
+		return 0;
+
+	meshopt_Allocator allocator;
+
+	size_t cluster_count = 0;
+	size_t cluster_index_count = 0;
+
+	// initial clusterization splits the original mesh
+	{
+		meshopt_Allocator scratch;
+
+		size_t max_meshlets = meshopt_buildMeshletsParallelBound(index_count, max_vertices, max_triangles);
+
+		meshopt_Meshlet* meshlets = scratch.allocate<meshopt_Meshlet>(max_meshlets);
+		unsigned int* meshlet_vertices = scratch.allocate<unsigned int>(max_meshlets * max_vertices);
+		unsigned char* meshlet_triangles = scratch.allocate<unsigned char>(max_meshlets * max_triangles * 3);
+
+		size_t meshlet_count = meshopt_buildMeshletsParallel(meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, 0.f, scheduler, scheduler_context);
+
+		if (meshlet_count > max_clusters || index_count > max_cluster_indices)
+			return 0;
+
+		for (size_t i = 0; i < meshlet_count; ++i)
+		{
+			meshopt_Cluster& cluster = clusters[i];
+
+			cluster.index_offset = unsigned(cluster_index_count);
+			cluster.index_count = unpackMeshlets(cluster_indices + cluster_index_count, &meshlets[i], 1, meshlet_vertices, meshlet_triangles);
+			cluster.depth = 0;
+			cluster.group = ~0u;
+
+			meshopt_Bounds bounds = meshopt_computeClusterBounds(cluster_indices + cluster.index_offset, cluster.index_count, vertex_positions, vertex_count, vertex_positions_stride);
+
+			memset(&cluster.self, 0, sizeof(meshopt_LODBounds));
+			memcpy(cluster.self.center, bounds.center, sizeof(bounds.center));
+			cluster.self.radius = bounds.radius;
+
+			memset(&cluster.parent, 0, sizeof(meshopt_LODBounds));
+			cluster.parent.error = FLT_MAX;
+
+			cluster_index_count += cluster.index_count;
+		}
+
+		cluster_count = meshlet_count;
+	}
+
+	size_t context_count = cluster_count < kHierarchyBatchCount ? cluster_count : kHierarchyBatchCount;
+	meshopt_SimplifierContext** contexts = allocator.allocate<meshopt_SimplifierContext*>(context_count);
+
+	for (size_t i = 0; i < context_count; ++i)
+		contexts[i] = meshopt_createSimplifierContext();
+
+	unsigned int* pending = allocator.allocate<unsigned int>(max_clusters);
+	unsigned int* next_pending = allocator.allocate<unsigned int>(max_clusters);
+	unsigned int* retry = allocator.allocate<unsigned int>(max_clusters);
+
+	size_t pending_count = cluster_count;
+
+	for (size_t i = 0; i < cluster_count; ++i)
+		pending[i] = unsigned(i);
+
+	size_t group_cluster_count = 0;
+	bool full = false;
+
+	// merge and simplify clusters until we can't merge anymore
+	for (unsigned int depth = 1; pending_count > 1 && !full; ++depth)
+	{
+		meshopt_Allocator scratch;
+
+		HierarchyGroup* level_groups = scratch.allocate<HierarchyGroup>(pending_count);
+		size_t level_group_count = 0;
+
+		size_t merged_total = 0;
+		size_t meshlet_total = 0;
+
+		for (size_t i = 0; i < pending_count; ++i)
+			merged_total += clusters[pending[i]].index_count;
+
+		unsigned int* merged = scratch.allocate<unsigned int>(merged_total);
+		unsigned int* simplified = scratch.allocate<unsigned int>(merged_total);
+		unsigned int* partition = scratch.allocate<unsigned int>(pending_count * 2 + 1);
+		unsigned int* partition_counts = partition + pending_count;
+
+		// partition pending clusters into groups of connected clusters
+		for (size_t i = 0, offset = 0; i < pending_count; ++i)
+		{
+			const meshopt_Cluster& cluster = clusters[pending[i]];
+
+			memcpy(simplified + offset, cluster_indices + cluster.index_offset, cluster.index_count * sizeof(unsigned int));
+			offset += cluster.index_count;
+			partition_counts[i] = cluster.index_count;
+		}
+
+		size_t partition_count = meshopt_partitionClusters(partition, simplified, merged_total, partition_counts, pending_count, vertex_count, kHierarchyGroupSize, scheduler, scheduler_context);
+
+		// reorder pending clusters so that every group is a consecutive range; the sort is stable to keep the order deterministic
+		memset(partition_counts, 0, (partition_count + 1) * sizeof(unsigned int));
+
+		for (size_t i = 0; i < pending_count; ++i)
+			partition_counts[partition[i] + 1]++;
+
+		for (size_t i = 0; i < partition_count; ++i)
+			partition_counts[i + 1] += partition_counts[i];
+
+		for (size_t i = 0; i < pending_count; ++i)
+			next_pending[partition_counts[partition[i]]++] = pending[i];
+
+		unsigned int* swap = pending;
+		pending = next_pending;
+		next_pending = swap;
+
+		// after the scatter, partition_counts[i] points to the end of partition i
+		for (size_t i = 0, offset = 0; i < partition_count; ++i)
+		{
+			HierarchyGroup& group = level_groups[level_group_count++];
+
+			memset(&group, 0, sizeof(HierarchyGroup));
+			group.pending_offset = i == 0 ? 0 : partition_counts[i - 1];
+			group.pending_count = partition_counts[i] - group.pending_offset;
+			group.index_offset = offset;
+
+			for (size_t j = 0; j < group.pending_count; ++j)
+				group.index_count += clusters[pending[group.pending_offset + j]].index_count;
+
+			offset += group.index_count;
+		}
+
+		// simplified groups never have more indices than merged groups, which bounds the number of meshlets each group can produce
+		for (size_t i = 0; i < level_group_count; ++i)
+		{
+			level_groups[i].meshlet_offset = meshlet_total;
+			meshlet_total += meshopt_buildMeshletsBound(level_groups[i].index_count, max_vertices, max_triangles);
+		}
+
+		HierarchyLevel level = {};
+		level.vertex_positions = vertex_positions;
+		level.vertex_count = vertex_count;
+		level.vertex_positions_stride = vertex_positions_stride;
+		level.max_vertices = max_vertices;
+		level.max_triangles = max_triangles;
+		level.clusters = clusters;
+		level.cluster_indices = cluster_indices;
+		level.pending = pending;
+		level.groups = level_groups;
+		level.group_count = level_group_count;
+		level.contexts = contexts;
+		level.merged = merged;
+		level.simplified = simplified;
+		level.meshlets = scratch.allocate<meshopt_Meshlet>(meshlet_total);
+		level.meshlet_vertices = scratch.allocate<unsigned int>(meshlet_total * max_vertices);
+		level.meshlet_triangles = scratch.allocate<unsigned char>(meshlet_total * max_triangles * 3);
+
+		// groups are assigned to batches statically; the result doesn't depend on the batch a group is simplified in
+		size_t batch_count = level_group_count < context_count ? level_group_count : context_count;
+		level.batch_size = (level_group_count + batch_count - 1) / batch_count;
+		batch_count = (level_group_count + level.batch_size - 1) / level.batch_size;
+
+		meshopt_runTasks(scheduler, scheduler_context, simplifyHierarchyTask, &level, batch_count);
+
+		// append the results in group order so that the output is deterministic
+		size_t next_pending_count = 0;
+		size_t retry_count = 0;
+		size_t triangles = 0;
+		size_t stuck_triangles = 0;
+
+		for (size_t i = 0; i < level_group_count; ++i)
+		{
+			const HierarchyGroup& group = level_groups[i];
+			const unsigned int* members = pending + group.pending_offset;
+
+			if (group.accepted && (cluster_count + group.result_count > max_clusters || cluster_index_count + group.result_index_count > max_cluster_indices))
+				full = true;
+
+			if (!group.accepted || full)
+			{
+				memcpy(retry + retry_count, members, group.pending_count * sizeof(unsigned int));
+				retry_count += group.pending_count;
+				stuck_triangles += group.index_count / 3;
+				continue;
+			}
+
+			assert(*group_count < max_clusters / 2 && group_cluster_count + group.pending_count <= max_clusters);
+
+			meshopt_ClusterGroup& result = groups[*group_count];
+
+			result.cluster_offset = unsigned(group_cluster_count);
+			result.cluster_count = unsigned(group.pending_count);
+			result.result_offset = unsigned(cluster_count);
+			result.result_count = unsigned(group.result_count);
+			result.bounds = group.bounds;
+
+			// all clusters in the group need to switch simultaneously so they have the same parent bounds
+			for (size_t j = 0; j < group.pending_count; ++j)
+			{
+				assert(clusters[members[j]].parent.error == FLT_MAX);
+
+				clusters[members[j]].parent = group.bounds;
+				clusters[members[j]].group = unsigned(*group_count);
+				group_clusters[group_cluster_count++] = members[j];
+			}
+
+			memcpy(cluster_indices + cluster_index_count, level.merged + group.index_offset, group.result_index_count * sizeof(unsigned int));
+
+			for (size_t j = 0; j < group.result_count; ++j)
+			{
+				meshopt_Cluster& cluster = clusters[cluster_count];
+
+				cluster.index_offset = unsigned(cluster_index_count);
+				cluster.index_count = level.meshlets[group.meshlet_offset + j].triangle_count * 3;
+				cluster.depth = depth;
+				cluster.group = ~0u;
+				cluster.self = group.bounds;
+
+				memset(&cluster.parent, 0, sizeof(meshopt_LODBounds));
+				cluster.parent.error = FLT_MAX;
+
+				cluster_index_count += cluster.index_count;
+				triangles += cluster.index_count / 3;
+
+				next_pending[next_pending_count++] = unsigned(cluster_count++);
+			}
+
+			*group_count += 1;
+		}
+
+		// stuck clusters are retried after the new clusters, which keeps them next to each other for grouping
+		memcpy(next_pending + next_pending_count, retry, retry_count * sizeof(unsigned int));
+		next_pending_count += retry_count;
+
+		unsigned int* temp = pending;
+		pending = next_pending;
+		next_pending = temp;
+		pending_count = next_pending_count;
+
+		// stop when most of the remaining geometry can't be simplified further
+		if (triangles < stuck_triangles / 3)
+			break;
+	}
+
+	for (size_t i = 0; i < context_count; ++i)
+		meshopt_destroySimplifierContext(contexts[i]);
+
+	return cluster_count;
+}
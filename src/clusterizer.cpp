@@ -6,6 +6,25 @@
 #include <math.h>
 #include <string.h>
 
+// The block below auto-detects SIMD ISA that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// The SIMD implementation requires SSE2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE2__)
+#define SIMD_SSE
+#endif
+
+// MSVC supports compiling SSE2 code regardless of compile options; we assume all 32-bit CPUs support SSE2
+#if !defined(SIMD_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define SIMD_SSE
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef SIMD_SSE
+#include <emmintrin.h>
+#endif
+
 // This work is based on:
 // Graham Wihlidal. Optimizing the Graphics Pipeline with Compute. 2016
 // Matthaeus Chajdas. GeometryFX 1.2 - Cluster Culling. 2016
@@ -19,6 +38,24 @@ const size_t kMeshletMaxVertices = 255;
 // A reasonable limit is around 2*max_vertices or less
 const size_t kMeshletMaxTriangles = 512;
 
+// Number of meshlets processed by each task when computing bounds in parallel
+const size_t kMeshletBoundsTaskSize = 256;
+
+// Bounds computation accepts any 8-bit local index, which may exceed builder limits
+const size_t kMeshletBoundsMaxVertices = 256;
+
+// Cluster bounds gather this many triangles at a time; 3 corners per triangle must fit in 8-bit local indices
+const size_t kClusterBoundsChunkSize = 84;
+
+// Number of meshlets processed by each task when optimizing meshlets in parallel
+const size_t kMeshletOptimizeTaskSize = 256;
+
+// Meshlet optimizer looks for a good triangle among this many triangles in input order before falling back to adjacency search
+const size_t kMeshletOptimizeLookahead = 32;
+
+// Parallel meshlet construction splits the mesh into spatially coherent regions of roughly this many triangles
+const size_t kMeshletRegionTriangles = 65536;
+
 struct TriangleAdjacency2
 {
 	unsigned int* counts;
@@ -26,15 +63,10 @@ struct TriangleAdjacency2
 	unsigned int* data;
 };
 
-static void buildTriangleAdjacency(TriangleAdjacency2& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count, meshopt_Allocator& allocator)
+static void fillTriangleAdjacency(TriangleAdjacency2& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count)
 {
 	size_t face_count = index_count / 3;
 
-	// allocate arrays
-	adjacency.counts = allocator.allocate<unsigned int>(vertex_count);
-	adjacency.offsets = allocator.allocate<unsigned int>(vertex_count);
-	adjacency.data = allocator.allocate<unsigned int>(index_count);
-
 	// fill triangle counts
 	memset(adjacency.counts, 0, vertex_count * sizeof(unsigned int));
 
@@ -83,6 +115,46 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 	size_t pmin[3] = {0, 0, 0};
 	size_t pmax[3] = {0, 0, 0};
 
+#ifdef SIMD_SSE
+	// find extremum values first, then locate the first point with each value; this matches the scalar loop below, including NaN handling
+	__m128 vmin = _mm_setr_ps(points[0][0], points[0][1], points[0][2], 0.f);
+	__m128 vmax = vmin;
+
+	// all loads except the last one read 4 floats, which stays in bounds since the next point follows
+	for (size_t i = 1; i + 1 < count; ++i)
+	{
+		__m128 p = _mm_loadu_ps(points[i]);
+
+		vmin = _mm_min_ps(p, vmin);
+		vmax = _mm_max_ps(p, vmax);
+	}
+
+	if (count > 1)
+	{
+		__m128 p = _mm_setr_ps(points[count - 1][0], points[count - 1][1], points[count - 1][2], 0.f);
+
+		vmin = _mm_min_ps(p, vmin);
+		vmax = _mm_max_ps(p, vmax);
+	}
+
+	float emin[4], emax[4];
+	_mm_storeu_ps(emin, vmin);
+	_mm_storeu_ps(emax, vmax);
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		size_t imin = 0, imax = 0;
+
+		while (imin < count && !(points[imin][axis] == emin[axis]))
+			imin++;
+
+		while (imax < count && !(points[imax][axis] == emax[axis]))
+			imax++;
+
+		pmin[axis] = imin < count ? imin : 0;
+		pmax[axis] = imax < count ? imax : 0;
+	}
+#else
 	for (size_t i = 0; i < count; ++i)
 	{
 		const float* p = points[i];
@@ -93,6 +165,7 @@ static void computeBoundingSphere(float result[4], const float points[][3], size
 			pmax[axis] = (p[axis] > points[pmax[axis]][axis]) ? i : pmax[axis];
 		}
 	}
+#endif
 
 	// find the pair of points with largest distance
 	float paxisd2 = 0;
@@ -159,6 +232,32 @@ static float getMeshletScore(float distance2, float spread, float cone_weight, f
 	return (1 + sqrtf(distance2) / expected_radius * (1 - cone_weight)) * cone_clamped;
 }
 
+struct Box
+{
+	float min[3];
+	float max[3];
+};
+
+static void mergeBox(Box& box, const Box& other)
+{
+	for (int k = 0; k < 3; ++k)
+	{
+		box.min[k] = other.min[k] < box.min[k] ? other.min[k] : box.min[k];
+		box.max[k] = other.max[k] > box.max[k] ? other.max[k] : box.max[k];
+	}
+}
+
+static float getMergedBoxArea(const Box& box, const Box& other)
+{
+	Box merged = box;
+	mergeBox(merged, other);
+
+	float sx = merged.max[0] - merged.min[0], sy = merged.max[1] - merged.min[1], sz = merged.max[2] - merged.min[2];
+
+	// half of the surface area is sufficient for comparisons
+	return sx * sy + sy * sz + sz * sx;
+}
+
 static Cone getMeshletCone(const Cone& acc, unsigned int triangle_count)
 {
 	Cone result = acc;
@@ -221,6 +320,28 @@ static float computeTriangleCones(Cone* triangles, const unsigned int* indices,
 	return mesh_area;
 }
 
+static void computeTriangleBoxes(Box* boxes, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_positions_stride)
+{
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+	size_t face_count = index_count / 3;
+
+	for (size_t i = 0; i < face_count; ++i)
+	{
+		const float* p0 = vertex_positions + vertex_stride_float * indices[i * 3 + 0];
+		const float* p1 = vertex_positions + vertex_stride_float * indices[i * 3 + 1];
+		const float* p2 = vertex_positions + vertex_stride_float * indices[i * 3 + 2];
+
+		for (int k = 0; k < 3; ++k)
+		{
+			float min01 = p0[k] < p1[k] ? p0[k] : p1[k];
+			float max01 = p0[k] > p1[k] ? p0[k] : p1[k];
+
+			boxes[i].min[k] = min01 < p2[k] ? min01 : p2[k];
+			boxes[i].max[k] = max01 > p2[k] ? max01 : p2[k];
+		}
+	}
+}
+
 static void finishMeshlet(meshopt_Meshlet& meshlet, unsigned char* meshlet_triangles)
 {
 	size_t offset = meshlet.triangle_offset + meshlet.triangle_count * 3;
@@ -283,7 +404,7 @@ static bool appendMeshlet(meshopt_Meshlet& meshlet, unsigned int a, unsigned int
 	return result;
 }
 
-static unsigned int getNeighborTriangle(const meshopt_Meshlet& meshlet, const Cone* meshlet_cone, unsigned int* meshlet_vertices, const unsigned int* indices, const TriangleAdjacency2& adjacency, const Cone* triangles, const unsigned int* live_triangles, const unsigned char* used, float meshlet_expected_radius, float cone_weight, unsigned int* out_extra)
+static unsigned int getNeighborTriangle(const meshopt_Meshlet& meshlet, const Cone* meshlet_cone, const Box* meshlet_box, unsigned int* meshlet_vertices, const unsigned int* indices, const TriangleAdjacency2& adjacency, const Cone* triangles, const Box* boxes, const unsigned int* live_triangles, const unsigned char* used, float meshlet_expected_radius, float cone_weight, unsigned int* out_extra)
 {
 	unsigned int best_triangle = ~0u;
 	unsigned int best_extra = 5;
@@ -319,8 +440,20 @@ static unsigned int getNeighborTriangle(const meshopt_Meshlet& meshlet, const Co
 
 			float score = 0;
 
-			// caller selects one of two scoring functions: geometrical (based on meshlet cone) or topological (based on remaining triangles)
-			if (meshlet_cone)
+			// caller selects one of three scoring functions: surface area (based on meshlet box), geometrical (based on meshlet cone) or topological (based on remaining triangles)
+			if (meshlet_box)
+			{
+				const Cone& tri_cone = triangles[triangle];
+
+				float distance2 =
+				    (tri_cone.px - meshlet_cone->px) * (tri_cone.px - meshlet_cone->px) +
+				    (tri_cone.py - meshlet_cone->py) * (tri_cone.py - meshlet_cone->py) +
+				    (tri_cone.pz - meshlet_cone->pz) * (tri_cone.pz - meshlet_cone->pz);
+
+				// many triangles don't change the box area when they are inside the box; distance to meshlet center keeps the meshlet compact in that case
+				score = getMergedBoxArea(*meshlet_box, boxes[triangle]) * (1 + 0.5f * sqrtf(distance2) / meshlet_expected_radius);
+			}
+			else if (meshlet_cone)
 			{
 				const Cone& tri_cone = triangles[triangle];
 
@@ -508,59 +641,50 @@ static void kdtreeNearest(KDNode* nodes, unsigned int root, const float* points,
 	}
 }
 
-} // namespace meshopt
-
-size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+struct MeshletScratch
 {
-	using namespace meshopt;
-
-	assert(index_count % 3 == 0);
-	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
-	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
-	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
-
-	(void)kMeshletMaxVertices;
-	(void)kMeshletMaxTriangles;
+	TriangleAdjacency2 adjacency;
+	unsigned int* live_triangles;
+	unsigned char* emitted_flags;
+	Cone* triangles;
+	unsigned int* kdindices;
+	KDNode* nodes;
+	unsigned char* used;
+
+	// optional; when set, meshlets are grown to minimize bounding box surface area instead of using cone_weight
+	Box* boxes;
+};
 
-	// meshlet construction is limited by max vertices and max triangles per meshlet
-	// the worst case is that the input is an unindexed stream since this equally stresses both limits
-	// note that we assume that in the worst case, we leave 2 vertices unpacked in each meshlet - if we have space for 3 we can pack any triangle
-	size_t max_vertices_conservative = max_vertices - 2;
-	size_t meshlet_limit_vertices = (index_count + max_vertices_conservative - 1) / max_vertices_conservative;
-	size_t meshlet_limit_triangles = (index_count / 3 + max_triangles - 1) / max_triangles;
+static void allocateMeshletScratch(MeshletScratch& scratch, size_t index_count, size_t vertex_count, meshopt_Allocator& allocator)
+{
+	size_t face_count = index_count / 3;
 
-	return meshlet_limit_vertices > meshlet_limit_triangles ? meshlet_limit_vertices : meshlet_limit_triangles;
+	scratch.adjacency.counts = allocator.allocate<unsigned int>(vertex_count);
+	scratch.adjacency.offsets = allocator.allocate<unsigned int>(vertex_count);
+	scratch.adjacency.data = allocator.allocate<unsigned int>(index_count);
+	scratch.live_triangles = allocator.allocate<unsigned int>(vertex_count);
+	scratch.emitted_flags = allocator.allocate<unsigned char>(face_count);
+	scratch.triangles = allocator.allocate<Cone>(face_count);
+	scratch.kdindices = allocator.allocate<unsigned int>(face_count);
+	scratch.nodes = allocator.allocate<KDNode>(face_count * 2);
+	scratch.used = allocator.allocate<unsigned char>(vertex_count);
 }
 
-size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
+static size_t buildMeshletsGreedy(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight, MeshletScratch& scratch)
 {
-	using namespace meshopt;
-
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
-
-	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
-	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
-	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+	TriangleAdjacency2& adjacency = scratch.adjacency;
+	fillTriangleAdjacency(adjacency, indices, index_count, vertex_count);
 
-	assert(cone_weight >= 0 && cone_weight <= 1);
-
-	meshopt_Allocator allocator;
-
-	TriangleAdjacency2 adjacency = {};
-	buildTriangleAdjacency(adjacency, indices, index_count, vertex_count, allocator);
-
-	unsigned int* live_triangles = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* live_triangles = scratch.live_triangles;
 	memcpy(live_triangles, adjacency.counts, vertex_count * sizeof(unsigned int));
 
 	size_t face_count = index_count / 3;
 
-	unsigned char* emitted_flags = allocator.allocate<unsigned char>(face_count);
+	unsigned char* emitted_flags = scratch.emitted_flags;
 	memset(emitted_flags, 0, face_count);
 
 	// for each triangle, precompute centroid & normal to use for scoring
-	Cone* triangles = allocator.allocate<Cone>(face_count);
+	Cone* triangles = scratch.triangles;
 	float mesh_area = computeTriangleCones(triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride);
 
 	// assuming each meshlet is a square patch, expected radius is sqrt(expected area)
@@ -568,15 +692,15 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 	float meshlet_expected_radius = sqrtf(triangle_area_avg * max_triangles) * 0.5f;
 
 	// build a kd-tree for nearest neighbor lookup
-	unsigned int* kdindices = allocator.allocate<unsigned int>(face_count);
+	unsigned int* kdindices = scratch.kdindices;
 	for (size_t i = 0; i < face_count; ++i)
 		kdindices[i] = unsigned(i);
 
-	KDNode* nodes = allocator.allocate<KDNode>(face_count * 2);
+	KDNode* nodes = scratch.nodes;
 	kdtreeBuild(0, nodes, face_count * 2, &triangles[0].px, sizeof(Cone) / sizeof(float), kdindices, face_count, /* leaf_size= */ 8);
 
 	// index of the vertex in the meshlet, 0xff if the vertex isn't used
-	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
+	unsigned char* used = scratch.used;
 	memset(used, -1, vertex_count);
 
 	meshopt_Meshlet meshlet = {};
@@ -584,17 +708,24 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 
 	Cone meshlet_cone_acc = {};
 
+	// surface area scoring uses per-triangle bounding boxes
+	Box* boxes = scratch.boxes;
+	Box meshlet_box = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+
+	if (boxes)
+		computeTriangleBoxes(boxes, indices, index_count, vertex_positions, vertex_positions_stride);
+
 	for (;;)
 	{
 		Cone meshlet_cone = getMeshletCone(meshlet_cone_acc, meshlet.triangle_count);
 
 		unsigned int best_extra = 0;
-		unsigned int best_triangle = getNeighborTriangle(meshlet, &meshlet_cone, meshlet_vertices, indices, adjacency, triangles, live_triangles, used, meshlet_expected_radius, cone_weight, &best_extra);
+		unsigned int best_triangle = getNeighborTriangle(meshlet, &meshlet_cone, boxes ? &meshlet_box : NULL, meshlet_vertices, indices, adjacency, triangles, boxes, live_triangles, used, meshlet_expected_radius, cone_weight, &best_extra);
 
 		// if the best triangle doesn't fit into current meshlet, the spatial scoring we've used is not very meaningful, so we re-select using topological scoring
 		if (best_triangle != ~0u && (meshlet.vertex_count + best_extra > max_vertices || meshlet.triangle_count >= max_triangles))
 		{
-			best_triangle = getNeighborTriangle(meshlet, NULL, meshlet_vertices, indices, adjacency, triangles, live_triangles, used, meshlet_expected_radius, 0.f, NULL);
+			best_triangle = getNeighborTriangle(meshlet, NULL, NULL, meshlet_vertices, indices, adjacency, triangles, boxes, live_triangles, used, meshlet_expected_radius, 0.f, NULL);
 		}
 
 		// when we run out of neighboring triangles we need to switch to spatial search; we currently just pick the closest triangle irrespective of connectivity
@@ -620,6 +751,9 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 		{
 			meshlet_offset++;
 			memset(&meshlet_cone_acc, 0, sizeof(meshlet_cone_acc));
+
+			if (boxes)
+				meshlet_box = boxes[best_triangle];
 		}
 
 		live_triangles[a]--;
@@ -656,6 +790,9 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 		meshlet_cone_acc.ny += triangles[best_triangle].ny;
 		meshlet_cone_acc.nz += triangles[best_triangle].nz;
 
+		if (boxes)
+			mergeBox(meshlet_box, boxes[best_triangle]);
+
 		emitted_flags[best_triangle] = 1;
 	}
 
@@ -666,99 +803,91 @@ size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_ve
 		meshlets[meshlet_offset++] = meshlet;
 	}
 
-	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
 	return meshlet_offset;
 }
 
-size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles)
-{
-	using namespace meshopt;
-
-	assert(index_count % 3 == 0);
-
-	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
-	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
-	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
-
-	meshopt_Allocator allocator;
-
-	// index of the vertex in the meshlet, 0xff if the vertex isn't used
-	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
-	memset(used, -1, vertex_count);
-
-	meshopt_Meshlet meshlet = {};
-	size_t meshlet_offset = 0;
-
-	for (size_t i = 0; i < index_count; i += 3)
-	{
-		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
-		assert(a < vertex_count && b < vertex_count && c < vertex_count);
-
-		// appends triangle to the meshlet and writes previous meshlet to the output if full
-		meshlet_offset += appendMeshlet(meshlet, a, b, c, used, meshlets, meshlet_vertices, meshlet_triangles, meshlet_offset, max_vertices, max_triangles);
-	}
-
-	if (meshlet.triangle_count)
-	{
-		finishMeshlet(meshlet, meshlet_triangles);
 
-		meshlets[meshlet_offset++] = meshlet;
-	}
+struct MeshletRegions
+{
+	const unsigned int* local_indices; // index buffer sorted by region, referencing region-local vertices
+	const unsigned int* local_vertices; // region-local vertex => original vertex
+	const size_t* region_triangles; // first triangle of each region
+	const size_t* region_vertices; // first local vertex of each region
+	const size_t* region_meshlets; // first reserved meshlet of each region
+	size_t* meshlet_counts;
+
+	const float* vertex_positions;
+	size_t vertex_stride_float;
+	float* local_positions;
+
+	// scratch memory for all regions, region r uses slices at its vertex/triangle offsets
+	MeshletScratch scratch;
+
+	meshopt_Meshlet* meshlets;
+	unsigned int* meshlet_vertices;
+	unsigned char* meshlet_triangles;
+
+	size_t max_vertices;
+	size_t max_triangles;
+	float cone_weight;
+};
 
-	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
-	return meshlet_offset;
+static size_t getMeshletRegionStart(size_t face_count, size_t region_count, size_t region)
+{
+	return face_count * region / region_count;
 }
 
-meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+static void buildMeshletsRegionTask(void* context, size_t index)
 {
-	using namespace meshopt;
+	const MeshletRegions& r = *static_cast<const MeshletRegions*>(context);
 
-	assert(index_count % 3 == 0);
-	assert(index_count / 3 <= kMeshletMaxTriangles);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+	size_t triangle_offset = r.region_triangles[index];
+	size_t face_count = r.region_triangles[index + 1] - triangle_offset;
+	size_t vertex_offset = r.region_vertices[index];
+	size_t vertex_count = r.region_vertices[index + 1] - vertex_offset;
 
-	(void)vertex_count;
+	const unsigned int* local_vertices = r.local_vertices + vertex_offset;
+	float* local_positions = r.local_positions + vertex_offset * 3;
 
-	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		const float* p = r.vertex_positions + local_vertices[i] * r.vertex_stride_float;
 
-	// compute triangle normals and gather triangle corners
-	float normals[kMeshletMaxTriangles][3];
-	float corners[kMeshletMaxTriangles][3][3];
-	size_t triangles = 0;
+		local_positions[i * 3 + 0] = p[0];
+		local_positions[i * 3 + 1] = p[1];
+		local_positions[i * 3 + 2] = p[2];
+	}
 
-	for (size_t i = 0; i < index_count; i += 3)
-	{
-		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
-		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+	MeshletScratch scratch = {};
+	scratch.adjacency.counts = r.scratch.adjacency.counts + vertex_offset;
+	scratch.adjacency.offsets = r.scratch.adjacency.offsets + vertex_offset;
+	scratch.adjacency.data = r.scratch.adjacency.data + triangle_offset * 3;
+	scratch.live_triangles = r.scratch.live_triangles + vertex_offset;
+	scratch.emitted_flags = r.scratch.emitted_flags + triangle_offset;
+	scratch.triangles = r.scratch.triangles + triangle_offset;
+	scratch.kdindices = r.scratch.kdindices + triangle_offset;
+	scratch.nodes = r.scratch.nodes + triangle_offset * 2;
+	scratch.used = r.scratch.used + vertex_offset;
 
-		const float* p0 = vertex_positions + vertex_stride_float * a;
-		const float* p1 = vertex_positions + vertex_stride_float * b;
-		const float* p2 = vertex_positions + vertex_stride_float * c;
+	size_t meshlet_offset = r.region_meshlets[index];
 
-		float p10[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
-		float p20[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	meshopt_Meshlet* meshlets = r.meshlets + meshlet_offset;
+	unsigned int* meshlet_vertices = r.meshlet_vertices + meshlet_offset * r.max_vertices;
+	unsigned char* meshlet_triangles = r.meshlet_triangles + meshlet_offset * r.max_triangles * 3;
 
-		float normalx = p10[1] * p20[2] - p10[2] * p20[1];
-		float normaly = p10[2] * p20[0] - p10[0] * p20[2];
-		float normalz = p10[0] * p20[1] - p10[1] * p20[0];
+	size_t meshlet_count = buildMeshletsGreedy(meshlets, meshlet_vertices, meshlet_triangles, r.local_indices + triangle_offset * 3, face_count * 3, local_positions, vertex_count, sizeof(float) * 3, r.max_vertices, r.max_triangles, r.cone_weight, scratch);
 
-		float area = sqrtf(normalx * normalx + normaly * normaly + normalz * normalz);
+	// meshlet vertices refer to region-local vertices; since each vertex is written once, this can be done in bulk
+	size_t meshlet_vertex_count = meshlet_count ? meshlets[meshlet_count - 1].vertex_offset + meshlets[meshlet_count - 1].vertex_count : 0;
 
-		// no need to include degenerate triangles - they will be invisible anyway
-		if (area == 0.f)
-			continue;
+	for (size_t i = 0; i < meshlet_vertex_count; ++i)
+		meshlet_vertices[i] = local_vertices[meshlet_vertices[i]];
 
-		// record triangle normals & corners for future use; normal and corner 0 define a plane equation
-		normals[triangles][0] = normalx / area;
-		normals[triangles][1] = normaly / area;
-		normals[triangles][2] = normalz / area;
-		memcpy(corners[triangles][0], p0, 3 * sizeof(float));
-		memcpy(corners[triangles][1], p1, 3 * sizeof(float));
-		memcpy(corners[triangles][2], p2, 3 * sizeof(float));
-		triangles++;
-	}
+	r.meshlet_counts[index] = meshlet_count;
+}
 
+static meshopt_Bounds computeTriangleBounds(const float normals[][3], const float corners[][3][3], size_t triangles)
+{
 	meshopt_Bounds bounds = {};
 
 	// degenerate cluster, no valid triangles => trivial reject (cone data is 0)
@@ -862,102 +991,303 @@ meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t
 	return bounds;
 }
 
-meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+static size_t computeTriangleNormals(float normals[][3], float corners[][3][3], const float positions[][4], const unsigned char* indices, size_t triangle_count)
 {
-	using namespace meshopt;
+	size_t triangles = 0;
+	size_t i = 0;
 
-	assert(triangle_count <= kMeshletMaxTriangles);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+#ifdef SIMD_SSE
+	// process 4 triangles at a time; note that the results may differ slightly from the scalar path when the compiler contracts the scalar math into FMA
+	// there is no NEON path; other targets use the scalar loop, which matters less as the bounding sphere passes dominate the cost
+	for (; i + 4 <= triangle_count; i += 4)
+	{
+		// positions are padded to 4 floats, so every corner can be loaded with one instruction and transposed into SoA form
+		__m128 p0x = _mm_loadu_ps(positions[indices[i * 3 + 0]]);
+		__m128 p0y = _mm_loadu_ps(positions[indices[i * 3 + 3]]);
+		__m128 p0z = _mm_loadu_ps(positions[indices[i * 3 + 6]]);
+		__m128 p0w = _mm_loadu_ps(positions[indices[i * 3 + 9]]);
+		_MM_TRANSPOSE4_PS(p0x, p0y, p0z, p0w);
+
+		__m128 p1x = _mm_loadu_ps(positions[indices[i * 3 + 1]]);
+		__m128 p1y = _mm_loadu_ps(positions[indices[i * 3 + 4]]);
+		__m128 p1z = _mm_loadu_ps(positions[indices[i * 3 + 7]]);
+		__m128 p1w = _mm_loadu_ps(positions[indices[i * 3 + 10]]);
+		_MM_TRANSPOSE4_PS(p1x, p1y, p1z, p1w);
+
+		__m128 p2x = _mm_loadu_ps(positions[indices[i * 3 + 2]]);
+		__m128 p2y = _mm_loadu_ps(positions[indices[i * 3 + 5]]);
+		__m128 p2z = _mm_loadu_ps(positions[indices[i * 3 + 8]]);
+		__m128 p2w = _mm_loadu_ps(positions[indices[i * 3 + 11]]);
+		_MM_TRANSPOSE4_PS(p2x, p2y, p2z, p2w);
+
+		__m128 p10x = _mm_sub_ps(p1x, p0x);
+		__m128 p10y = _mm_sub_ps(p1y, p0y);
+		__m128 p10z = _mm_sub_ps(p1z, p0z);
+		__m128 p20x = _mm_sub_ps(p2x, p0x);
+		__m128 p20y = _mm_sub_ps(p2y, p0y);
+		__m128 p20z = _mm_sub_ps(p2z, p0z);
+
+		__m128 normalx = _mm_sub_ps(_mm_mul_ps(p10y, p20z), _mm_mul_ps(p10z, p20y));
+		__m128 normaly = _mm_sub_ps(_mm_mul_ps(p10z, p20x), _mm_mul_ps(p10x, p20z));
+		__m128 normalz = _mm_sub_ps(_mm_mul_ps(p10x, p20y), _mm_mul_ps(p10y, p20x));
+
+		__m128 area = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(normalx, normalx), _mm_mul_ps(normaly, normaly)), _mm_mul_ps(normalz, normalz)));
+
+		float n[4][4];
+		_mm_storeu_ps(n[0], _mm_div_ps(normalx, area));
+		_mm_storeu_ps(n[1], _mm_div_ps(normaly, area));
+		_mm_storeu_ps(n[2], _mm_div_ps(normalz, area));
+		_mm_storeu_ps(n[3], area);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			// no need to include degenerate triangles - they will be invisible anyway
+			if (n[3][k] == 0.f)
+				continue;
 
-	unsigned int indices[kMeshletMaxTriangles * 3];
+			normals[triangles][0] = n[0][k];
+			normals[triangles][1] = n[1][k];
+			normals[triangles][2] = n[2][k];
+			memcpy(corners[triangles][0], positions[indices[(i + k) * 3 + 0]], 3 * sizeof(float));
+			memcpy(corners[triangles][1], positions[indices[(i + k) * 3 + 1]], 3 * sizeof(float));
+			memcpy(corners[triangles][2], positions[indices[(i + k) * 3 + 2]], 3 * sizeof(float));
+			triangles++;
+		}
+	}
+#endif
 
-	for (size_t i = 0; i < triangle_count * 3; ++i)
+	for (; i < triangle_count; ++i)
 	{
-		unsigned int index = meshlet_vertices[meshlet_triangles[i]];
-		assert(index < vertex_count);
+		const float* p0 = positions[indices[i * 3 + 0]];
+		const float* p1 = positions[indices[i * 3 + 1]];
+		const float* p2 = positions[indices[i * 3 + 2]];
 
-		indices[i] = index;
-	}
+		float p10[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+		float p20[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
 
-	return meshopt_computeClusterBounds(indices, triangle_count * 3, vertex_positions, vertex_count, vertex_positions_stride);
-}
+		float normalx = p10[1] * p20[2] - p10[2] * p20[1];
+		float normaly = p10[2] * p20[0] - p10[0] * p20[2];
+		float normalz = p10[0] * p20[1] - p10[1] * p20[0];
 
-void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, size_t triangle_count, size_t vertex_count)
-{
-	using namespace meshopt;
+		float area = sqrtf(normalx * normalx + normaly * normaly + normalz * normalz);
 
-	assert(triangle_count <= kMeshletMaxTriangles);
-	assert(vertex_count <= kMeshletMaxVertices);
+		if (area == 0.f)
+			continue;
 
-	unsigned char* indices = meshlet_triangles;
-	unsigned int* vertices = meshlet_vertices;
+		normals[triangles][0] = normalx / area;
+		normals[triangles][1] = normaly / area;
+		normals[triangles][2] = normalz / area;
+		memcpy(corners[triangles][0], p0, 3 * sizeof(float));
+		memcpy(corners[triangles][1], p1, 3 * sizeof(float));
+		memcpy(corners[triangles][2], p2, 3 * sizeof(float));
+		triangles++;
+	}
 
-	// cache tracks vertex timestamps (corresponding to triangle index! all 3 vertices are added at the same time and never removed)
-	unsigned char cache[kMeshletMaxVertices];
-	memset(cache, 0, vertex_count);
+	return triangles;
+}
 
-	// note that we start from a value that means all vertices aren't in cache
-	unsigned char cache_last = 128;
-	const unsigned char cache_cutoff = 3; // 3 triangles = ~5..9 vertices depending on reuse
+struct MeshletBoundsBatch
+{
+	meshopt_Bounds* bounds;
+	const meshopt_Meshlet* meshlets;
+	size_t meshlet_count;
+	const unsigned int* meshlet_vertices;
+	const unsigned char* meshlet_triangles;
+	const float* vertex_positions;
+	size_t vertex_count;
+	size_t vertex_stride_float;
+};
 
-	for (size_t i = 0; i < triangle_count; ++i)
-	{
-		int next = -1;
-		int next_match = -1;
+static meshopt_Bounds computeMeshletBounds(float positions[][4], float normals[][3], float corners[][3][3], const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t vertex_count, size_t triangle_count, const float* vertex_positions, size_t vertex_positions_count, size_t vertex_stride_float)
+{
+	assert(vertex_count <= kMeshletBoundsMaxVertices && triangle_count <= kMeshletMaxTriangles);
+	(void)vertex_positions_count;
 
-		for (size_t j = i; j < triangle_count; ++j)
-		{
-			unsigned char a = indices[j * 3 + 0], b = indices[j * 3 + 1], c = indices[j * 3 + 2];
-			assert(a < vertex_count && b < vertex_count && c < vertex_count);
+	// gather meshlet vertices once; triangles reference each vertex several times
+	for (size_t j = 0; j < vertex_count; ++j)
+	{
+		unsigned int vertex = meshlet_vertices[j];
+		assert(vertex < vertex_positions_count);
 
-			// score each triangle by how many vertices are in cache
-			// note: the distance is computed using unsigned 8-bit values, so cache timestamp overflow is handled gracefully
-			int aok = (unsigned char)(cache_last - cache[a]) < cache_cutoff;
-			int bok = (unsigned char)(cache_last - cache[b]) < cache_cutoff;
-			int cok = (unsigned char)(cache_last - cache[c]) < cache_cutoff;
+		memcpy(positions[j], vertex_positions + vertex * vertex_stride_float, 3 * sizeof(float));
+		positions[j][3] = 0.f;
+	}
 
-			if (aok + bok + cok > next_match)
-			{
-				next = (int)j;
-				next_match = aok + bok + cok;
+	size_t triangles = computeTriangleNormals(normals, corners, positions, meshlet_triangles, triangle_count);
 
-				// note that we could end up with all 3 vertices in the cache, but 2 is enough for ~strip traversal
-				if (next_match >= 2)
-					break;
-			}
-		}
+	return computeTriangleBounds(normals, corners, triangles);
+}
 
-		assert(next >= 0);
+static void computeMeshletBoundsTask(void* context, size_t index)
+{
+	const MeshletBoundsBatch& batch = *static_cast<const MeshletBoundsBatch*>(context);
 
-		unsigned char a = indices[next * 3 + 0], b = indices[next * 3 + 1], c = indices[next * 3 + 2];
+	size_t begin = index * kMeshletBoundsTaskSize;
+	size_t end = begin + kMeshletBoundsTaskSize < batch.meshlet_count ? begin + kMeshletBoundsTaskSize : batch.meshlet_count;
 
-		// shift triangles before the next one forward so that we always keep an ordered partition
-		// note: this could have swapped triangles [i] and [next] but that distorts the order and may skew the output sequence
-		memmove(indices + (i + 1) * 3, indices + i * 3, (next - i) * 3 * sizeof(unsigned char));
+	float positions[kMeshletBoundsMaxVertices][4];
+	float normals[kMeshletMaxTriangles][3];
+	float corners[kMeshletMaxTriangles][3][3];
 
-		indices[i * 3 + 0] = a;
-		indices[i * 3 + 1] = b;
-		indices[i * 3 + 2] = c;
+	for (size_t i = begin; i < end; ++i)
+	{
+		const meshopt_Meshlet& meshlet = batch.meshlets[i];
 
-		// cache timestamp is the same between all vertices of each triangle to reduce overflow
-		cache_last++;
-		cache[a] = cache_last;
-		cache[b] = cache_last;
-		cache[c] = cache_last;
+		batch.bounds[i] = computeMeshletBounds(positions, normals, corners, batch.meshlet_vertices + meshlet.vertex_offset, batch.meshlet_triangles + meshlet.triangle_offset, meshlet.vertex_count, meshlet.triangle_count, batch.vertex_positions, batch.vertex_count, batch.vertex_stride_float);
 	}
+}
 
-	// reorder meshlet vertices for access locality assuming index buffer is scanned sequentially
-	unsigned int order[kMeshletMaxVertices];
+static void buildMeshletAdjacency(unsigned short* counts, unsigned short* offsets, unsigned short* data, const unsigned char* indices, size_t triangle_count, size_t vertex_count)
+{
+	memset(counts, 0, vertex_count * sizeof(unsigned short));
 
-	unsigned char remap[kMeshletMaxVertices];
-	memset(remap, -1, vertex_count);
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+		counts[indices[i]]++;
 
-	size_t vertex_offset = 0;
+	unsigned short offset = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		offsets[i] = offset;
+		offset = (unsigned short)(offset + counts[i]);
+		counts[i] = 0;
+	}
 
 	for (size_t i = 0; i < triangle_count * 3; ++i)
 	{
-		unsigned char& r = remap[indices[i]];
+		unsigned char v = indices[i];
+		data[offsets[v] + counts[v]++] = (unsigned short)(i / 3);
+	}
+}
+
+static void optimizeMeshlet(unsigned int* vertices, unsigned char* indices, size_t triangle_count, size_t vertex_count)
+{
+	// keep a copy of the input so that output can be written in place
+	unsigned char source[kMeshletMaxTriangles * 3];
+	memcpy(source, indices, triangle_count * 3);
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+		assert(source[i] < vertex_count);
+
+	// vertex => triangle adjacency is only needed when input order isn't coherent, so it's built on demand
+	unsigned short adjacency_counts[kMeshletMaxVertices];
+	unsigned short adjacency_offsets[kMeshletMaxVertices];
+	unsigned short adjacency_data[kMeshletMaxTriangles * 3];
+	bool adjacency_ready = false;
+
+	// cache tracks the step at which each vertex leaves the cache; vertices of the last few emitted triangles are considered cached
+	unsigned short cache[kMeshletMaxVertices];
+	memset(cache, 0, vertex_count * sizeof(unsigned short));
+
+	const size_t cache_cutoff = 3; // 3 triangles = ~5..9 vertices depending on reuse
+
+	unsigned short visited[kMeshletMaxVertices];
+	memset(visited, 0, vertex_count * sizeof(unsigned short));
+
+	unsigned char emitted[kMeshletMaxTriangles];
+	memset(emitted, 0, triangle_count);
+
+	size_t input_cursor = 0;
+
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		while (emitted[input_cursor])
+			input_cursor++;
+
+		// candidates are ranked by the number of cached vertices and then by input order; key 0 means no candidates were found
+		unsigned int next_key = 0;
+
+		// input order is usually coherent, so we first look for a triangle with 2 cached vertices among the next few remaining triangles
+		// since the first such triangle wins all ties, finding it allows us to skip the adjacency search
+		size_t lookahead_end = input_cursor + kMeshletOptimizeLookahead < triangle_count ? input_cursor + kMeshletOptimizeLookahead : triangle_count;
+
+		for (size_t j = input_cursor; j < lookahead_end; ++j)
+		{
+			unsigned char a = source[j * 3 + 0], b = source[j * 3 + 1], c = source[j * 3 + 2];
+
+			if (!emitted[j] && (cache[a] > i) + (cache[b] > i) + (cache[c] > i) >= 2)
+			{
+				next_key = (2 << 16) | unsigned(0xffff - j);
+				break;
+			}
+		}
+
+		// only triangles adjacent to cached vertices can have a non-zero score, and these are reachable from the last few emitted triangles
+		size_t recent = next_key ? 0 : (i < cache_cutoff ? i : cache_cutoff);
+
+		if (recent && !adjacency_ready)
+		{
+			buildMeshletAdjacency(adjacency_counts, adjacency_offsets, adjacency_data, source, triangle_count, vertex_count);
+			adjacency_ready = true;
+		}
+
+		for (size_t j = (i - recent) * 3; j < i * 3; ++j)
+		{
+			unsigned char v = indices[j];
+
+			// recent triangles share most vertices, so we skip vertices that were already visited during this step
+			if (visited[v] == i + 1)
+				continue;
+
+			visited[v] = (unsigned short)(i + 1);
+
+			unsigned short* neighbors = &adjacency_data[adjacency_offsets[v]];
+			size_t neighbor_count = adjacency_counts[v];
+
+			for (size_t k = 0; k < neighbor_count;)
+			{
+				unsigned int tri = neighbors[k];
+
+				// emitted triangles are removed lazily, so that each adjacency entry is removed at most once
+				if (emitted[tri])
+				{
+					neighbors[k] = neighbors[--neighbor_count];
+					continue;
+				}
+
+				unsigned char a = source[tri * 3 + 0], b = source[tri * 3 + 1], c = source[tri * 3 + 2];
+
+				// note that we could end up with all 3 vertices in the cache, but 2 is enough for ~strip traversal
+				unsigned int match = (cache[a] > i) + (cache[b] > i) + (cache[c] > i);
+				match = match < 2 ? match : 2;
+
+				unsigned int key = (match << 16) | (0xffff - tri);
+				next_key = key > next_key ? key : next_key;
+
+				k++;
+			}
+
+			adjacency_counts[v] = (unsigned short)neighbor_count;
+		}
+
+		// when no triangles are adjacent to the cache, continue with the first remaining triangle in input order
+		size_t next = next_key ? 0xffff - (next_key & 0xffff) : input_cursor;
+
+		assert(!emitted[next]);
+		emitted[next] = 1;
+
+		unsigned char a = source[next * 3 + 0], b = source[next * 3 + 1], c = source[next * 3 + 2];
+
+		indices[i * 3 + 0] = a;
+		indices[i * 3 + 1] = b;
+		indices[i * 3 + 2] = c;
+
+		cache[a] = (unsigned short)(i + 1 + cache_cutoff);
+		cache[b] = (unsigned short)(i + 1 + cache_cutoff);
+		cache[c] = (unsigned short)(i + 1 + cache_cutoff);
+	}
+
+	// reorder meshlet vertices for access locality assuming index buffer is scanned sequentially
+	unsigned int order[kMeshletMaxVertices];
+
+	unsigned char remap[kMeshletMaxVertices];
+	memset(remap, -1, vertex_count);
+
+	size_t vertex_offset = 0;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+	{
+		unsigned char& r = remap[indices[i]];
 
 		if (r == 0xff)
 		{
@@ -972,3 +1302,428 @@ void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* mesh
 	assert(vertex_offset <= vertex_count);
 	memcpy(vertices, order, vertex_offset * sizeof(unsigned int));
 }
+
+struct MeshletOptimizeBatch
+{
+	const meshopt_Meshlet* meshlets;
+	size_t meshlet_count;
+	unsigned int* meshlet_vertices;
+	unsigned char* meshlet_triangles;
+};
+
+static void optimizeMeshletsTask(void* context, size_t index)
+{
+	const MeshletOptimizeBatch& batch = *static_cast<const MeshletOptimizeBatch*>(context);
+
+	size_t begin = index * kMeshletOptimizeTaskSize;
+	size_t end = begin + kMeshletOptimizeTaskSize < batch.meshlet_count ? begin + kMeshletOptimizeTaskSize : batch.meshlet_count;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		const meshopt_Meshlet& meshlet = batch.meshlets[i];
+		assert(meshlet.vertex_count <= kMeshletMaxVertices && meshlet.triangle_count <= kMeshletMaxTriangles);
+
+		optimizeMeshlet(&batch.meshlet_vertices[meshlet.vertex_offset], &batch.meshlet_triangles[meshlet.triangle_offset], meshlet.triangle_count, meshlet.vertex_count);
+	}
+}
+
+} // namespace meshopt
+
+size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	(void)kMeshletMaxVertices;
+	(void)kMeshletMaxTriangles;
+
+	// meshlet construction is limited by max vertices and max triangles per meshlet
+	// the worst case is that the input is an unindexed stream since this equally stresses both limits
+	// note that we assume that in the worst case, we leave 2 vertices unpacked in each meshlet - if we have space for 3 we can pack any triangle
+	size_t max_vertices_conservative = max_vertices - 2;
+	size_t meshlet_limit_vertices = (index_count + max_vertices_conservative - 1) / max_vertices_conservative;
+	size_t meshlet_limit_triangles = (index_count / 3 + max_triangles - 1) / max_triangles;
+
+	return meshlet_limit_vertices > meshlet_limit_triangles ? meshlet_limit_vertices : meshlet_limit_triangles;
+}
+
+size_t meshopt_buildMeshlets(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	assert(cone_weight >= 0 && cone_weight <= 1);
+
+	meshopt_Allocator allocator;
+
+	MeshletScratch scratch = {};
+	allocateMeshletScratch(scratch, index_count, vertex_count, allocator);
+
+	size_t meshlet_offset = buildMeshletsGreedy(meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, cone_weight, scratch);
+
+	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
+	return meshlet_offset;
+}
+
+size_t meshopt_buildMeshletsSpatial(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, float* meshlet_boxes, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	meshopt_Allocator allocator;
+
+	MeshletScratch scratch = {};
+	allocateMeshletScratch(scratch, index_count, vertex_count, allocator);
+
+	scratch.boxes = allocator.allocate<Box>(index_count / 3);
+
+	size_t meshlet_offset = buildMeshletsGreedy(meshlets, meshlet_vertices, meshlet_triangles, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, max_vertices, max_triangles, 0.f, scratch);
+
+	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
+
+	if (meshlet_boxes)
+	{
+		size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+		// every meshlet vertex is referenced by a meshlet triangle, so vertex bounds are exact
+		for (size_t i = 0; i < meshlet_offset; ++i)
+		{
+			const meshopt_Meshlet& meshlet = meshlets[i];
+			Box box = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+
+			for (size_t j = 0; j < meshlet.vertex_count; ++j)
+			{
+				const float* p = vertex_positions + vertex_stride_float * meshlet_vertices[meshlet.vertex_offset + j];
+				Box point = {{p[0], p[1], p[2]}, {p[0], p[1], p[2]}};
+
+				mergeBox(box, point);
+			}
+
+			memcpy(&meshlet_boxes[i * 6 + 0], box.min, sizeof(float) * 3);
+			memcpy(&meshlet_boxes[i * 6 + 3], box.max, sizeof(float) * 3);
+		}
+	}
+
+	return meshlet_offset;
+}
+
+size_t meshopt_buildMeshletsParallelBound(size_t index_count, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+
+	size_t face_count = index_count / 3;
+	size_t region_count = (face_count + kMeshletRegionTriangles - 1) / kMeshletRegionTriangles;
+
+	size_t result = 0;
+
+	for (size_t i = 0; i < region_count; ++i)
+	{
+		size_t region_faces = getMeshletRegionStart(face_count, region_count, i + 1) - getMeshletRegionStart(face_count, region_count, i);
+
+		result += meshopt_buildMeshletsBound(region_faces * 3, max_vertices, max_triangles);
+	}
+
+	return result;
+}
+
+size_t meshopt_buildMeshletsParallel(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	assert(cone_weight >= 0 && cone_weight <= 1);
+
+	size_t face_count = index_count / 3;
+	size_t region_count = (face_count + kMeshletRegionTriangles - 1) / kMeshletRegionTriangles;
+
+	if (region_count == 0)
+		return 0;
+
+	meshopt_Allocator allocator;
+
+	// sort triangles along a space-filling curve so that consecutive triangle ranges form spatially coherent regions
+	unsigned int* local_indices = allocator.allocate<unsigned int>(index_count);
+	meshopt_spatialSortTriangles(local_indices, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride);
+
+	// remap each region to a compact range of local vertices so that per-region scratch memory is proportional to region size
+	unsigned int* local_vertices = allocator.allocate<unsigned int>(index_count);
+
+	unsigned int* vertex_region = allocator.allocate<unsigned int>(vertex_count);
+	memset(vertex_region, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int* vertex_local = allocator.allocate<unsigned int>(vertex_count);
+
+	size_t* region_triangles = allocator.allocate<size_t>(region_count + 1);
+	size_t* region_vertices = allocator.allocate<size_t>(region_count + 1);
+	size_t* region_meshlets = allocator.allocate<size_t>(region_count + 1);
+	size_t* meshlet_counts = allocator.allocate<size_t>(region_count);
+
+	size_t local_offset = 0;
+	size_t meshlet_offset = 0;
+
+	for (size_t r = 0; r < region_count; ++r)
+	{
+		size_t begin = getMeshletRegionStart(face_count, region_count, r);
+		size_t end = getMeshletRegionStart(face_count, region_count, r + 1);
+
+		region_triangles[r] = begin;
+		region_vertices[r] = local_offset;
+		region_meshlets[r] = meshlet_offset;
+
+		for (size_t i = begin * 3; i < end * 3; ++i)
+		{
+			unsigned int v = local_indices[i];
+			assert(v < vertex_count);
+
+			if (vertex_region[v] != r)
+			{
+				vertex_region[v] = unsigned(r);
+				vertex_local[v] = unsigned(local_offset - region_vertices[r]);
+				local_vertices[local_offset++] = v;
+			}
+
+			local_indices[i] = vertex_local[v];
+		}
+
+		meshlet_offset += meshopt_buildMeshletsBound((end - begin) * 3, max_vertices, max_triangles);
+	}
+
+	region_triangles[region_count] = face_count;
+	region_vertices[region_count] = local_offset;
+	region_meshlets[region_count] = meshlet_offset;
+
+	MeshletRegions regions = {};
+	regions.local_indices = local_indices;
+	regions.local_vertices = local_vertices;
+	regions.region_triangles = region_triangles;
+	regions.region_vertices = region_vertices;
+	regions.region_meshlets = region_meshlets;
+	regions.meshlet_counts = meshlet_counts;
+	regions.vertex_positions = vertex_positions;
+	regions.vertex_stride_float = vertex_positions_stride / sizeof(float);
+	regions.local_positions = allocator.allocate<float>(local_offset * 3);
+	regions.meshlets = meshlets;
+	regions.meshlet_vertices = meshlet_vertices;
+	regions.meshlet_triangles = meshlet_triangles;
+	regions.max_vertices = max_vertices;
+	regions.max_triangles = max_triangles;
+	regions.cone_weight = cone_weight;
+
+	// all regions share scratch arrays, so vertex-sized arrays are sized by the total local vertex count
+	allocateMeshletScratch(regions.scratch, index_count, local_offset, allocator);
+
+	meshopt_runTasks(scheduler, scheduler_context, buildMeshletsRegionTask, &regions, region_count);
+
+	// compact meshlets and their data; regions are processed in order and data only moves backwards, so this can be done in place
+	size_t result = 0;
+	size_t vertex_offset = 0;
+	size_t triangle_offset = 0;
+
+	for (size_t r = 0; r < region_count; ++r)
+	{
+		size_t count = meshlet_counts[r];
+
+		if (count == 0)
+			continue;
+
+		meshopt_Meshlet* region = meshlets + region_meshlets[r];
+		const meshopt_Meshlet& last = region[count - 1];
+
+		size_t region_vertex_count = last.vertex_offset + last.vertex_count;
+		size_t region_triangle_size = last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3);
+
+		memmove(meshlet_vertices + vertex_offset, meshlet_vertices + region_meshlets[r] * max_vertices, region_vertex_count * sizeof(unsigned int));
+		memmove(meshlet_triangles + triangle_offset, meshlet_triangles + region_meshlets[r] * max_triangles * 3, region_triangle_size);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			meshopt_Meshlet m = region[i];
+
+			m.vertex_offset += unsigned(vertex_offset);
+			m.triangle_offset += unsigned(triangle_offset);
+
+			meshlets[result++] = m;
+		}
+
+		vertex_offset += region_vertex_count;
+		triangle_offset += region_triangle_size;
+	}
+
+	assert(result <= meshlet_offset);
+	return result;
+}
+
+size_t meshopt_buildMeshletsScan(meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+
+	assert(max_vertices >= 3 && max_vertices <= kMeshletMaxVertices);
+	assert(max_triangles >= 1 && max_triangles <= kMeshletMaxTriangles);
+	assert(max_triangles % 4 == 0); // ensures the caller will compute output space properly as index data is 4b aligned
+
+	meshopt_Allocator allocator;
+
+	// index of the vertex in the meshlet, 0xff if the vertex isn't used
+	unsigned char* used = allocator.allocate<unsigned char>(vertex_count);
+	memset(used, -1, vertex_count);
+
+	meshopt_Meshlet meshlet = {};
+	size_t meshlet_offset = 0;
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+		// appends triangle to the meshlet and writes previous meshlet to the output if full
+		meshlet_offset += appendMeshlet(meshlet, a, b, c, used, meshlets, meshlet_vertices, meshlet_triangles, meshlet_offset, max_vertices, max_triangles);
+	}
+
+	if (meshlet.triangle_count)
+	{
+		finishMeshlet(meshlet, meshlet_triangles);
+
+		meshlets[meshlet_offset++] = meshlet;
+	}
+
+	assert(meshlet_offset <= meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles));
+	return meshlet_offset;
+}
+
+meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(index_count / 3 <= kMeshletMaxTriangles);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	(void)vertex_count;
+
+	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	// gather triangle corners in chunks that fit 8-bit local indices; chunks are a multiple of 4 triangles so that the normals match meshopt_computeMeshletBounds exactly
+	float positions[kClusterBoundsChunkSize * 3][4];
+	unsigned char local[kClusterBoundsChunkSize * 3];
+
+	for (size_t i = 0; i < kClusterBoundsChunkSize * 3; ++i)
+		local[i] = (unsigned char)(i);
+
+	float normals[kMeshletMaxTriangles][3];
+	float corners[kMeshletMaxTriangles][3][3];
+	size_t triangles = 0;
+
+	for (size_t offset = 0; offset < index_count; offset += kClusterBoundsChunkSize * 3)
+	{
+		size_t chunk_size = index_count - offset < kClusterBoundsChunkSize * 3 ? index_count - offset : kClusterBoundsChunkSize * 3;
+
+		for (size_t i = 0; i < chunk_size; ++i)
+		{
+			unsigned int index = indices[offset + i];
+			assert(index < vertex_count);
+
+			memcpy(positions[i], vertex_positions + vertex_stride_float * index, 3 * sizeof(float));
+			positions[i][3] = 0.f;
+		}
+
+		triangles += computeTriangleNormals(normals + triangles, corners + triangles, positions, local, chunk_size / 3);
+	}
+
+	return computeTriangleBounds(normals, corners, triangles);
+}
+
+meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
+
+	assert(triangle_count <= kMeshletMaxTriangles);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	// meshlet vertex count isn't known, but all referenced vertices precede the largest local index
+	size_t meshlet_vertex_count = 0;
+
+	for (size_t i = 0; i < triangle_count * 3; ++i)
+		meshlet_vertex_count = meshlet_triangles[i] >= meshlet_vertex_count ? meshlet_triangles[i] + 1 : meshlet_vertex_count;
+
+	float positions[kMeshletBoundsMaxVertices][4];
+	float normals[kMeshletMaxTriangles][3];
+	float corners[kMeshletMaxTriangles][3][3];
+
+	return computeMeshletBounds(positions, normals, corners, meshlet_vertices, meshlet_triangles, meshlet_vertex_count, triangle_count, vertex_positions, vertex_count, vertex_positions_stride / sizeof(float));
+}
+
+void meshopt_computeMeshletBoundsBatch(meshopt_Bounds* bounds, const meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	MeshletBoundsBatch batch = {};
+	batch.bounds = bounds;
+	batch.meshlets = meshlets;
+	batch.meshlet_count = meshlet_count;
+	batch.meshlet_vertices = meshlet_vertices;
+	batch.meshlet_triangles = meshlet_triangles;
+	batch.vertex_positions = vertex_positions;
+	batch.vertex_count = vertex_count;
+	batch.vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	meshopt_runTasks(scheduler, scheduler_context, computeMeshletBoundsTask, &batch, (meshlet_count + kMeshletBoundsTaskSize - 1) / kMeshletBoundsTaskSize);
+}
+
+void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, size_t triangle_count, size_t vertex_count)
+{
+	using namespace meshopt;
+
+	assert(triangle_count <= kMeshletMaxTriangles);
+	assert(vertex_count <= kMeshletMaxVertices);
+
+	optimizeMeshlet(meshlet_vertices, meshlet_triangles, triangle_count, vertex_count);
+}
+
+void meshopt_optimizeMeshletBatch(const meshopt_Meshlet* meshlets, size_t meshlet_count, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	MeshletOptimizeBatch batch = {};
+	batch.meshlets = meshlets;
+	batch.meshlet_count = meshlet_count;
+	batch.meshlet_vertices = meshlet_vertices;
+	batch.meshlet_triangles = meshlet_triangles;
+
+	meshopt_runTasks(scheduler, scheduler_context, optimizeMeshletsTask, &batch, (meshlet_count + kMeshletOptimizeTaskSize - 1) / kMeshletOptimizeTaskSize);
+}
+
+#undef SIMD_SSE
@@ -2,8 +2,82 @@
 #include "meshoptimizer.h"
 
 #include <assert.h>
+#include <math.h>
 #include <string.h>
 
+// The block below auto-detects hardware CRC32C and SIMD comparison support that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// CRC32C requires SSE4.2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE4_2__)
+#define HASH_CRC_SSE
+#endif
+
+// MSVC supports compiling SSE4.2 code regardless of compile options; we use a cpuid-based scalar fallback
+#if !defined(HASH_CRC_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define HASH_CRC_SSE
+#define HASH_CRC_FALLBACK
+#endif
+
+// GCC 4.9+ and clang 3.8+ support targeting SIMD ISA from individual functions; we use a cpuid-based scalar fallback
+#if !defined(HASH_CRC_SSE) && ((defined(__clang__) && __clang_major__ * 100 + __clang_minor__ >= 308) || (defined(__GNUC__) && __GNUC__ * 100 + __GNUC_MINOR__ >= 409)) && (defined(__i386__) || defined(__x86_64__))
+#define HASH_CRC_SSE
+#define HASH_CRC_FALLBACK
+#define HASH_CRC_TARGET __attribute__((target("sse4.2")))
+#endif
+
+// CRC32 extension is optional in ARMv8.0 and can't be detected at runtime portably, so we rely on compiler settings
+#if defined(__ARM_FEATURE_CRC32) && (defined(__aarch64__) || defined(_M_ARM64))
+#define HASH_CRC_ARM
+#endif
+
+// SSE2 is always available on x64 and is used for key comparisons
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HASH_EQUAL_SSE
+#endif
+
+#ifndef HASH_CRC_TARGET
+#define HASH_CRC_TARGET
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef HASH_CRC_SSE
+#include <nmmintrin.h>
+#endif
+
+#ifdef HASH_EQUAL_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(HASH_CRC_SSE) && defined(HASH_CRC_FALLBACK)
+#ifdef _MSC_VER
+#include <intrin.h> // __cpuid
+#else
+#include <cpuid.h> // __cpuid
+#endif
+#endif
+
+#ifdef HASH_CRC_ARM
+#include <arm_acle.h>
+#endif
+
+struct meshopt_VertexIndexer
+{
+	size_t vertex_size;
+	size_t generation_size;
+	size_t table_size;
+
+	// two generations of recent unique vertices; when the current one fills up, the previous one is discarded
+	unsigned char* vertices[2];
+	unsigned int* ids[2];
+	unsigned int* tables[2];
+	size_t counts[2];
+	int current;
+
+	unsigned int next_id;
+};
+
 // This work is based on:
 // John McDonald, Mark Kilgard. Crack-Free Point-Normal Triangles using Adjacent Edge Normals. 2010
 // John Hable. Variable Rate Shading with Visibility Buffer Rendering. 2024
@@ -18,7 +92,8 @@ static unsigned int hashUpdate4(unsigned int h, const unsigned char* key, size_t
 
 	while (len >= 4)
 	{
-		unsigned int k = *reinterpret_cast<const unsigned int*>(key);
+		unsigned int k;
+		memcpy(&k, key, sizeof(k));
 
 		k *= m;
 		k ^= k >> r;
@@ -34,6 +109,117 @@ static unsigned int hashUpdate4(unsigned int h, const unsigned char* key, size_t
 	return h;
 }
 
+#ifdef HASH_CRC_SSE
+HASH_CRC_TARGET static unsigned int hashUpdateCrc(unsigned int h, const unsigned char* key, size_t len)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	unsigned long long h64 = h;
+
+	while (len >= 8)
+	{
+		unsigned long long k;
+		memcpy(&k, key, sizeof(k));
+
+		h64 = _mm_crc32_u64(h64, k);
+
+		key += 8;
+		len -= 8;
+	}
+
+	h = unsigned(h64);
+#endif
+
+	while (len >= 4)
+	{
+		unsigned int k;
+		memcpy(&k, key, sizeof(k));
+
+		h = _mm_crc32_u32(h, k);
+
+		key += 4;
+		len -= 4;
+	}
+
+	return h;
+}
+#endif
+
+#ifdef HASH_CRC_ARM
+static unsigned int hashUpdateCrc(unsigned int h, const unsigned char* key, size_t len)
+{
+	while (len >= 8)
+	{
+		unsigned long long k;
+		memcpy(&k, key, sizeof(k));
+
+		h = __crc32cd(h, k);
+
+		key += 8;
+		len -= 8;
+	}
+
+	while (len >= 4)
+	{
+		unsigned int k;
+		memcpy(&k, key, sizeof(k));
+
+		h = __crc32cw(h, k);
+
+		key += 4;
+		len -= 4;
+	}
+
+	return h;
+}
+#endif
+
+#if defined(HASH_CRC_SSE) && defined(HASH_CRC_FALLBACK)
+static bool getHashCrcSupport()
+{
+	int cpuinfo[4] = {};
+#ifdef _MSC_VER
+	__cpuid(cpuinfo, 1);
+#else
+	__cpuid(1, cpuinfo[0], cpuinfo[1], cpuinfo[2], cpuinfo[3]);
+#endif
+	return (cpuinfo[2] & (1 << 20)) != 0;
+}
+
+static bool hash_crc = getHashCrcSupport();
+#endif
+
+// Hashes all complete 4-byte words of the key; the hash function depends on the platform, so it should not affect the output of any algorithm
+static unsigned int hashUpdate(unsigned int h, const unsigned char* key, size_t len)
+{
+#if defined(HASH_CRC_SSE) && defined(HASH_CRC_FALLBACK)
+	return hash_crc ? hashUpdateCrc(h, key, len) : hashUpdate4(h, key, len);
+#elif defined(HASH_CRC_SSE) || defined(HASH_CRC_ARM)
+	return hashUpdateCrc(h, key, len);
+#else
+	return hashUpdate4(h, key, len);
+#endif
+}
+
+static bool equalBytes(const unsigned char* lhs, const unsigned char* rhs, size_t len)
+{
+#ifdef HASH_EQUAL_SSE
+	while (len >= 16)
+	{
+		__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs));
+		__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs));
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xffff)
+			return false;
+
+		lhs += 16;
+		rhs += 16;
+		len -= 16;
+	}
+#endif
+
+	return memcmp(lhs, rhs, len) == 0;
+}
+
 struct VertexHasher
 {
 	const unsigned char* vertices;
@@ -42,12 +228,12 @@ struct VertexHasher
 
 	size_t hash(unsigned int index) const
 	{
-		return hashUpdate4(0, vertices + index * vertex_stride, vertex_size);
+		return hashUpdate(0, vertices + index * vertex_stride, vertex_size);
 	}
 
 	bool equal(unsigned int lhs, unsigned int rhs) const
 	{
-		return memcmp(vertices + lhs * vertex_stride, vertices + rhs * vertex_stride, vertex_size) == 0;
+		return equalBytes(vertices + lhs * vertex_stride, vertices + rhs * vertex_stride, vertex_size);
 	}
 };
 
@@ -65,7 +251,7 @@ struct VertexStreamHasher
 			const meshopt_Stream& s = streams[i];
 			const unsigned char* data = static_cast<const unsigned char*>(s.data);
 
-			h = hashUpdate4(h, data + index * s.stride, s.size);
+			h = hashUpdate(h, data + index * s.stride, s.size);
 		}
 
 		return h;
@@ -78,7 +264,7 @@ struct VertexStreamHasher
 			const meshopt_Stream& s = streams[i];
 			const unsigned char* data = static_cast<const unsigned char*>(s.data);
 
-			if (memcmp(data + lhs * s.stride, data + rhs * s.stride, s.size) != 0)
+			if (!equalBytes(data + lhs * s.stride, data + rhs * s.stride, s.size))
 				return false;
 		}
 
@@ -125,6 +311,86 @@ struct EdgeHasher
 	}
 };
 
+struct IndexerHasher
+{
+	const unsigned char* vertices;
+	size_t vertex_size;
+
+	// the query vertex is identified by a key past the end of the generation
+	const unsigned char* query;
+	unsigned int query_key;
+	unsigned int query_hash;
+
+	const unsigned char* data(unsigned int index) const
+	{
+		return index == query_key ? query : vertices + index * vertex_size;
+	}
+
+	size_t hash(unsigned int index) const
+	{
+		return index == query_key ? query_hash : hashUpdate(0, vertices + index * vertex_size, vertex_size);
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		return equalBytes(data(lhs), data(rhs), vertex_size);
+	}
+};
+
+struct FuzzyCellHasher
+{
+	const int* cells;
+
+	size_t hash(unsigned int index) const
+	{
+		return hashUpdate4(0, reinterpret_cast<const unsigned char*>(cells + index * 3), sizeof(int) * 3);
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		return memcmp(cells + lhs * 3, cells + rhs * 3, sizeof(int) * 3) == 0;
+	}
+};
+
+static void computeFuzzyCell(int* cell, const float* data, size_t components, float tolerance)
+{
+	cell[0] = cell[1] = cell[2] = 0;
+
+	for (size_t k = 0; k < components && k < 3; ++k)
+	{
+		// double precision keeps quotients exact enough that values within tolerance land in adjacent cells
+		double v = tolerance > 0 ? floor(double(data[k]) / double(tolerance)) : 0.0;
+
+		if (tolerance > 0 && fabs(v) < double(1 << 30))
+		{
+			cell[k] = int(v);
+		}
+		else
+		{
+			// exact matching: cell is the bit pattern of the value, with -0 folded into +0
+			// this is also used for values that are too large relative to tolerance (or not finite); float spacing exceeds tolerance there, so only equal values can match
+			float f = data[k] + 0.f;
+			memcpy(&cell[k], &f, sizeof(float));
+		}
+	}
+}
+
+static bool matchFuzzy(const meshopt_Stream* streams, size_t stream_count, const float* tolerances, unsigned int lhs, unsigned int rhs)
+{
+	for (size_t i = 0; i < stream_count; ++i)
+	{
+		const meshopt_Stream& s = streams[i];
+		const float* ld = reinterpret_cast<const float*>(static_cast<const unsigned char*>(s.data) + lhs * s.stride);
+		const float* rd = reinterpret_cast<const float*>(static_cast<const unsigned char*>(s.data) + rhs * s.stride);
+
+		for (size_t k = 0; k < s.size / sizeof(float); ++k)
+			if (!(fabsf(ld[k] - rd[k]) <= tolerances[i]))
+				return false;
+	}
+
+	return true;
+}
+
 static size_t hashBuckets(size_t count)
 {
 	size_t buckets = 1;
@@ -183,6 +449,200 @@ static void buildPositionRemap(unsigned int* remap, const float* vertex_position
 	allocator.deallocate(vertex_table);
 }
 
+template <typename Hasher>
+struct CachedHasher
+{
+	const unsigned int* hashes;
+	const Hasher* hasher;
+
+	size_t hash(unsigned int index) const
+	{
+		return hashes[index];
+	}
+
+	bool equal(unsigned int lhs, unsigned int rhs) const
+	{
+		return hasher->equal(lhs, rhs);
+	}
+};
+
+template <typename Hasher>
+struct ParallelRemap
+{
+	Hasher hasher;
+
+	const unsigned int* unique; // referenced vertices in order of first appearance
+	size_t unique_count;
+	size_t task_size;
+
+	unsigned int* hashes; // vertex => hash
+	unsigned int* rep; // vertex => first equivalent vertex
+
+	const unsigned int* parts; // referenced vertices sorted by partition, in order of first appearance within each partition
+	const size_t* part_offsets;
+	const size_t* table_offsets;
+	unsigned int* tables;
+
+	unsigned int* destination;
+};
+
+template <typename Hasher>
+static void remapHashTask(void* context, size_t index)
+{
+	const ParallelRemap<Hasher>& r = *static_cast<const ParallelRemap<Hasher>*>(context);
+
+	size_t begin = index * r.task_size;
+	size_t end = begin + r.task_size < r.unique_count ? begin + r.task_size : r.unique_count;
+
+	for (size_t i = begin; i < end; ++i)
+		r.hashes[r.unique[i]] = unsigned(r.hasher.hash(r.unique[i]));
+}
+
+template <typename Hasher>
+static void remapPartitionTask(void* context, size_t index)
+{
+	const ParallelRemap<Hasher>& r = *static_cast<const ParallelRemap<Hasher>*>(context);
+
+	CachedHasher<Hasher> hasher = {r.hashes, &r.hasher};
+
+	unsigned int* table = r.tables + r.table_offsets[index];
+	size_t table_size = r.table_offsets[index + 1] - r.table_offsets[index];
+	memset(table, -1, table_size * sizeof(unsigned int));
+
+	// vertices are inserted in order of first appearance, so the first vertex in each equivalence class becomes its representative
+	for (size_t i = r.part_offsets[index]; i < r.part_offsets[index + 1]; ++i)
+	{
+		unsigned int vertex = r.parts[i];
+		unsigned int* entry = hashLookup(table, table_size, hasher, vertex, ~0u);
+
+		if (*entry == ~0u)
+			*entry = vertex;
+
+		r.rep[vertex] = *entry;
+	}
+}
+
+template <typename Hasher>
+static void remapResolveTask(void* context, size_t index)
+{
+	const ParallelRemap<Hasher>& r = *static_cast<const ParallelRemap<Hasher>*>(context);
+
+	size_t begin = index * r.task_size;
+	size_t end = begin + r.task_size < r.unique_count ? begin + r.task_size : r.unique_count;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		unsigned int vertex = r.unique[i];
+
+		if (r.rep[vertex] != vertex)
+			r.destination[vertex] = r.destination[r.rep[vertex]];
+	}
+}
+
+template <typename Hasher>
+static size_t generateVertexRemapParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const Hasher& hasher, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	const size_t kTaskSize = 16384;
+	const size_t kPartitionSize = 65536;
+
+	meshopt_Allocator allocator;
+
+	memset(destination, -1, vertex_count * sizeof(unsigned int));
+
+	// collect referenced vertices in order of first appearance; rep doubles as a visited marker until partitions are processed
+	unsigned int* rep = allocator.allocate<unsigned int>(vertex_count);
+	memset(rep, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int* unique = allocator.allocate<unsigned int>(vertex_count);
+	size_t unique_count = 0;
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices ? indices[i] : unsigned(i);
+		assert(index < vertex_count);
+
+		if (rep[index] == ~0u)
+		{
+			rep[index] = index;
+			unique[unique_count++] = index;
+		}
+	}
+
+	unsigned int* hashes = allocator.allocate<unsigned int>(vertex_count);
+
+	ParallelRemap<Hasher> r = {};
+	r.hasher = hasher;
+	r.unique = unique;
+	r.unique_count = unique_count;
+	r.task_size = kTaskSize;
+	r.hashes = hashes;
+	r.rep = rep;
+	r.destination = destination;
+
+	size_t task_count = (unique_count + kTaskSize - 1) / kTaskSize;
+
+	meshopt_runTasks(scheduler, scheduler_context, remapHashTask<Hasher>, &r, task_count);
+
+	// split vertices into partitions by the top hash bits; the bottom bits are used for table lookups
+	int partition_bits = 0;
+	while (partition_bits < 8 && (unique_count >> partition_bits) > kPartitionSize)
+		partition_bits++;
+
+	size_t partition_count = size_t(1) << partition_bits;
+
+	size_t* part_offsets = allocator.allocate<size_t>(partition_count + 1);
+	memset(part_offsets, 0, (partition_count + 1) * sizeof(size_t));
+
+	for (size_t i = 0; i < unique_count; ++i)
+		part_offsets[partition_bits ? (hashes[unique[i]] >> (32 - partition_bits)) + 1 : 1]++;
+
+	size_t* table_offsets = allocator.allocate<size_t>(partition_count + 1);
+	table_offsets[0] = 0;
+
+	for (size_t i = 0; i < partition_count; ++i)
+	{
+		table_offsets[i + 1] = table_offsets[i] + hashBuckets(part_offsets[i + 1]);
+		part_offsets[i + 1] += part_offsets[i];
+	}
+
+	// stable counting sort keeps the order of first appearance within each partition
+	unsigned int* parts = allocator.allocate<unsigned int>(unique_count);
+
+	for (size_t i = 0; i < unique_count; ++i)
+	{
+		unsigned int partition = partition_bits ? hashes[unique[i]] >> (32 - partition_bits) : 0;
+
+		parts[part_offsets[partition]++] = unique[i];
+	}
+
+	for (size_t i = partition_count; i > 0; --i)
+		part_offsets[i] = part_offsets[i - 1];
+
+	part_offsets[0] = 0;
+
+	unsigned int* tables = allocator.allocate<unsigned int>(table_offsets[partition_count]);
+
+	r.parts = parts;
+	r.part_offsets = part_offsets;
+	r.table_offsets = table_offsets;
+	r.tables = tables;
+
+	meshopt_runTasks(scheduler, scheduler_context, remapPartitionTask<Hasher>, &r, partition_count);
+
+	// new indices are assigned in order of first appearance, matching the serial version
+	unsigned int next_vertex = 0;
+
+	for (size_t i = 0; i < unique_count; ++i)
+		if (rep[unique[i]] == unique[i])
+			destination[unique[i]] = next_vertex++;
+
+	meshopt_runTasks(scheduler, scheduler_context, remapResolveTask<Hasher>, &r, task_count);
+
+	assert(next_vertex <= vertex_count);
+
+	return next_vertex;
+}
+
 template <size_t BlockSize>
 static void remapVertices(void* destination, const void* vertices, size_t vertex_count, size_t vertex_size, const unsigned int* remap)
 {
@@ -303,6 +763,259 @@ size_t meshopt_generateVertexRemapMulti(unsigned int* destination, const unsigne
 	return next_vertex;
 }
 
+size_t meshopt_generateVertexRemapParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(indices || index_count == vertex_count);
+	assert(!indices || index_count % 3 == 0);
+	assert(vertex_size > 0 && vertex_size <= 256);
+
+	VertexHasher hasher = {static_cast<const unsigned char*>(vertices), vertex_size, vertex_size};
+
+	return generateVertexRemapParallel(destination, indices, index_count, vertex_count, hasher, scheduler, scheduler_context);
+}
+
+size_t meshopt_generateVertexRemapMultiParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(indices || index_count == vertex_count);
+	assert(index_count % 3 == 0);
+	assert(stream_count > 0 && stream_count <= 16);
+
+	for (size_t i = 0; i < stream_count; ++i)
+	{
+		assert(streams[i].size > 0 && streams[i].size <= 256);
+		assert(streams[i].size <= streams[i].stride);
+	}
+
+	VertexStreamHasher hasher = {streams, stream_count};
+
+	return generateVertexRemapParallel(destination, indices, index_count, vertex_count, hasher, scheduler, scheduler_context);
+}
+
+size_t meshopt_generateVertexRemapFuzzy(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count, const float* tolerances)
+{
+	using namespace meshopt;
+
+	assert(indices || index_count == vertex_count);
+	assert(index_count % 3 == 0);
+	assert(stream_count > 0 && stream_count <= 16);
+
+	for (size_t i = 0; i < stream_count; ++i)
+	{
+		assert(streams[i].size > 0 && streams[i].size <= 256);
+		assert(streams[i].size <= streams[i].stride);
+		assert(streams[i].size % sizeof(float) == 0);
+		assert(tolerances[i] >= 0);
+	}
+
+	meshopt_Allocator allocator;
+
+	memset(destination, -1, vertex_count * sizeof(unsigned int));
+
+	// grid over the first (up to) 3 components of the first stream; cell size matches the tolerance so matches are in adjacent cells
+	const meshopt_Stream& grid = streams[0];
+	size_t grid_dims = grid.size / sizeof(float) < 3 ? grid.size / sizeof(float) : 3;
+	int grid_radius = tolerances[0] > 0 ? 1 : 0;
+
+	// last cell is used as a lookup key for neighbor queries
+	int* cells = allocator.allocate<int>((vertex_count + 1) * 3);
+
+	FuzzyCellHasher hasher = {cells};
+
+	size_t table_size = hashBuckets(vertex_count);
+	unsigned int* table = allocator.allocate<unsigned int>(table_size);
+	memset(table, -1, table_size * sizeof(unsigned int));
+
+	// linked list of representative vertices in each cell
+	unsigned int* next = allocator.allocate<unsigned int>(vertex_count);
+
+	unsigned int query = unsigned(vertex_count);
+	int* query_cell = cells + vertex_count * 3;
+
+	unsigned int next_vertex = 0;
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices ? indices[i] : unsigned(i);
+		assert(index < vertex_count);
+
+		if (destination[index] != ~0u)
+			continue;
+
+		int* cell = cells + index * 3;
+		computeFuzzyCell(cell, reinterpret_cast<const float*>(static_cast<const unsigned char*>(grid.data) + index * grid.stride), grid_dims, tolerances[0]);
+
+		unsigned int match = ~0u;
+
+		for (int dz = grid_dims > 2 ? -grid_radius : 0; dz <= (grid_dims > 2 ? grid_radius : 0) && match == ~0u; ++dz)
+			for (int dy = grid_dims > 1 ? -grid_radius : 0; dy <= (grid_dims > 1 ? grid_radius : 0) && match == ~0u; ++dy)
+				for (int dx = -grid_radius; dx <= grid_radius && match == ~0u; ++dx)
+				{
+					// cells that store bit patterns may be close to integer limits, so offsets use unsigned math
+					query_cell[0] = int(unsigned(cell[0]) + unsigned(dx));
+					query_cell[1] = int(unsigned(cell[1]) + unsigned(dy));
+					query_cell[2] = int(unsigned(cell[2]) + unsigned(dz));
+
+					unsigned int* entry = hashLookup(table, table_size, hasher, query, ~0u);
+
+					for (unsigned int rep = *entry; rep != ~0u; rep = next[rep])
+						if (matchFuzzy(streams, stream_count, tolerances, index, rep))
+						{
+							match = rep;
+							break;
+						}
+				}
+
+		if (match != ~0u)
+		{
+			destination[index] = destination[match];
+		}
+		else
+		{
+			unsigned int* entry = hashLookup(table, table_size, hasher, index, ~0u);
+
+			next[index] = *entry;
+			*entry = index;
+
+			destination[index] = next_vertex++;
+		}
+	}
+
+	assert(next_vertex <= vertex_count);
+
+	return next_vertex;
+}
+
+meshopt_VertexIndexer* meshopt_createVertexIndexer(size_t vertex_size, size_t cache_size)
+{
+	using namespace meshopt;
+
+	assert(vertex_size > 0 && vertex_size <= 256);
+	assert(cache_size > 0);
+
+	size_t table_size = hashBuckets(cache_size);
+
+	// vertex data goes last so that the other arrays stay aligned
+	size_t size = sizeof(meshopt_VertexIndexer) + 2 * (cache_size + table_size) * sizeof(unsigned int) + 2 * cache_size * vertex_size;
+
+	char* data = static_cast<char*>(meshopt_Allocator::Storage::allocate(size));
+
+	meshopt_VertexIndexer* indexer = reinterpret_cast<meshopt_VertexIndexer*>(data);
+	data += sizeof(meshopt_VertexIndexer);
+
+	indexer->vertex_size = vertex_size;
+	indexer->generation_size = cache_size;
+	indexer->table_size = table_size;
+
+	for (int k = 0; k < 2; ++k)
+	{
+		indexer->ids[k] = reinterpret_cast<unsigned int*>(data);
+		data += cache_size * sizeof(unsigned int);
+
+		indexer->tables[k] = reinterpret_cast<unsigned int*>(data);
+		data += table_size * sizeof(unsigned int);
+
+		memset(indexer->tables[k], -1, table_size * sizeof(unsigned int));
+		indexer->counts[k] = 0;
+	}
+
+	for (int k = 0; k < 2; ++k)
+	{
+		indexer->vertices[k] = reinterpret_cast<unsigned char*>(data);
+		data += cache_size * vertex_size;
+	}
+
+	indexer->current = 0;
+	indexer->next_id = 0;
+
+	return indexer;
+}
+
+void meshopt_destroyVertexIndexer(meshopt_VertexIndexer* indexer)
+{
+	if (!indexer)
+		return;
+
+	meshopt_Allocator::Storage::deallocate(indexer);
+}
+
+size_t meshopt_indexVertexBatch(meshopt_VertexIndexer* indexer, unsigned int* destination_indices, void* destination_vertices, const void* vertices, size_t vertex_count)
+{
+	using namespace meshopt;
+
+	assert(indexer);
+
+	size_t vertex_size = indexer->vertex_size;
+	size_t generation_size = indexer->generation_size;
+	size_t table_size = indexer->table_size;
+
+	unsigned char* output = static_cast<unsigned char*>(destination_vertices);
+	size_t output_count = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		const unsigned char* vertex = static_cast<const unsigned char*>(vertices) + i * vertex_size;
+
+		int cur = indexer->current;
+		int prev = cur ^ 1;
+
+		IndexerHasher hasher = {indexer->vertices[cur], vertex_size, vertex, unsigned(generation_size), hashUpdate(0, vertex, vertex_size)};
+
+		unsigned int* entry = hashLookup(indexer->tables[cur], table_size, hasher, hasher.query_key, ~0u);
+
+		if (*entry != ~0u)
+		{
+			destination_indices[i] = indexer->ids[cur][*entry];
+			continue;
+		}
+
+		hasher.vertices = indexer->vertices[prev];
+
+		unsigned int* prev_entry = hashLookup(indexer->tables[prev], table_size, hasher, hasher.query_key, ~0u);
+		unsigned int id = 0;
+
+		if (*prev_entry != ~0u)
+		{
+			// vertex from the previous generation is reused, so it moves to the current generation to stay in cache
+			id = indexer->ids[prev][*prev_entry];
+		}
+		else
+		{
+			id = indexer->next_id++;
+
+			memcpy(output + output_count * vertex_size, vertex, vertex_size);
+			output_count++;
+		}
+
+		destination_indices[i] = id;
+
+		if (indexer->counts[cur] == generation_size)
+		{
+			// current generation is full; discard the previous generation and reuse its storage
+			cur = prev;
+			indexer->current = cur;
+
+			memset(indexer->tables[cur], -1, table_size * sizeof(unsigned int));
+			indexer->counts[cur] = 0;
+
+			hasher.vertices = indexer->vertices[cur];
+			entry = hashLookup(indexer->tables[cur], table_size, hasher, hasher.query_key, ~0u);
+		}
+
+		unsigned int slot = unsigned(indexer->counts[cur]++);
+
+		memcpy(indexer->vertices[cur] + slot * vertex_size, vertex, vertex_size);
+		indexer->ids[cur][slot] = id;
+
+		*entry = slot;
+	}
+
+	return output_count;
+}
+
 void meshopt_remapVertexBuffer(void* destination, const void* vertices, size_t vertex_count, size_t vertex_size, const unsigned int* remap)
 {
 	using namespace meshopt;
@@ -352,6 +1065,128 @@ void meshopt_remapIndexBuffer(unsigned int* destination, const unsigned int* ind
 	}
 }
 
+size_t meshopt_generateIndexedMesh(void* destination_indices, size_t index_size, void** destination_streams, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count)
+{
+	using namespace meshopt;
+
+	assert(indices || index_count == vertex_count);
+	assert(index_count % 3 == 0);
+	assert(index_size == 2 || index_size == 4);
+	assert(stream_count > 0 && stream_count <= 16);
+
+	for (size_t i = 0; i < stream_count; ++i)
+	{
+		assert(streams[i].size > 0 && streams[i].size <= 256);
+		assert(streams[i].size <= streams[i].stride);
+	}
+
+	meshopt_Allocator allocator;
+
+	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
+	memset(remap, -1, vertex_count * sizeof(unsigned int));
+
+	// new vertex => first old vertex that maps to it
+	unsigned int* reverse = allocator.allocate<unsigned int>(vertex_count);
+
+	VertexStreamHasher hasher = {streams, stream_count};
+
+	size_t table_size = hashBuckets(vertex_count);
+	unsigned int* table = allocator.allocate<unsigned int>(table_size);
+	memset(table, -1, table_size * sizeof(unsigned int));
+
+	unsigned int next_vertex = 0;
+	bool ordered = true;
+
+	for (size_t i = 0; i < index_count; ++i)
+	{
+		unsigned int index = indices ? indices[i] : unsigned(i);
+		assert(index < vertex_count);
+
+		if (remap[index] == ~0u)
+		{
+			unsigned int* entry = hashLookup(table, table_size, hasher, index, ~0u);
+
+			if (*entry == ~0u)
+			{
+				*entry = index;
+
+				ordered &= next_vertex == 0 || reverse[next_vertex - 1] < index;
+
+				reverse[next_vertex] = index;
+				remap[index] = next_vertex++;
+			}
+			else
+			{
+				assert(remap[*entry] != ~0u);
+
+				remap[index] = remap[*entry];
+			}
+		}
+	}
+
+	assert(next_vertex <= vertex_count);
+
+	if (index_size == 2 && next_vertex > 65536)
+		return next_vertex;
+
+	allocator.deallocate(table);
+
+	// when source vertices are in increasing order, each output vertex is written at or before its source and after all previous sources were read
+	unsigned char* scratch = NULL;
+
+	if (!ordered)
+	{
+		size_t scratch_size = 0;
+
+		for (size_t i = 0; i < stream_count; ++i)
+			if (destination_streams[i] == streams[i].data && scratch_size < streams[i].size)
+				scratch_size = streams[i].size;
+
+		scratch = scratch_size ? allocator.allocate<unsigned char>(next_vertex * scratch_size) : NULL;
+	}
+
+	for (size_t i = 0; i < stream_count; ++i)
+	{
+		const meshopt_Stream& s = streams[i];
+		const unsigned char* data = static_cast<const unsigned char*>(s.data);
+		unsigned char* target = static_cast<unsigned char*>(destination_streams[i]);
+
+		if (target == data)
+		{
+			unsigned char* temp = ordered ? target : scratch;
+
+			for (size_t j = 0; j < next_vertex; ++j)
+				memmove(temp + j * s.size, data + reverse[j] * s.stride, s.size);
+
+			if (temp != target)
+				memcpy(target, temp, next_vertex * s.size);
+		}
+		else
+		{
+			for (size_t j = 0; j < next_vertex; ++j)
+				memcpy(target + j * s.size, data + reverse[j] * s.stride, s.size);
+		}
+	}
+
+	// output index i never overlaps input indices after i, so this can be done in place for both index sizes
+	if (index_size == 2)
+	{
+		unsigned short* destination = static_cast<unsigned short*>(destination_indices);
+
+		for (size_t i = 0; i < index_count; ++i)
+			destination[i] = (unsigned short)(remap[indices ? indices[i] : unsigned(i)]);
+	}
+	else
+	{
+		unsigned int* destination = static_cast<unsigned int*>(destination_indices);
+
+		for (size_t i = 0; i < index_count; ++i)
+			destination[i] = remap[indices ? indices[i] : unsigned(i)];
+	}
+
+	return next_vertex;
+}
+
 void meshopt_generateShadowIndexBuffer(unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size, size_t vertex_stride)
 {
 	using namespace meshopt;
@@ -673,3 +1508,9 @@ size_t meshopt_generateProvokingIndexBuffer(unsigned int* destination, unsigned
 	assert(reorder_offset <= vertex_count + index_count / 3);
 	return reorder_offset;
 }
+
+#undef HASH_CRC_SSE
+#undef HASH_CRC_ARM
+#undef HASH_CRC_FALLBACK
+#undef HASH_CRC_TARGET
+#undef HASH_EQUAL_SSE
@@ -0,0 +1,219 @@
+// This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
+#include "meshoptimizer.h"
+
+#include <assert.h>
+#include <float.h>
+#include <string.h>
+
+namespace meshopt
+{
+
+// packed meshlet headers store vertex count in 8 bits, which matches meshlet builder limits
+const size_t kMeshletPackMaxVertices = 255;
+
+// meshlet builder limit; together with the vertex limit, this guarantees that any meshlet fits into a 4096 byte page
+const size_t kMeshletPackMaxTriangles = 512;
+
+static size_t getPackedMeshletSize(const meshopt_Meshlet& meshlet, int bits)
+{
+	// positions are a bit stream stored in 4-byte words, triangles are stored as 3 bytes each padded to 4 bytes
+	size_t vertex_size = (meshlet.vertex_count * 3 * bits + 31) / 32 * 4;
+	size_t triangle_size = (meshlet.triangle_count * 3 + 3) & ~3;
+
+	return sizeof(meshopt_PackedMeshlet) + vertex_size + triangle_size;
+}
+
+struct MeshletPageWriter
+{
+	unsigned char* pages;
+	meshopt_MeshletPage* page_directory;
+	size_t page_size;
+	int bits;
+
+	const meshopt_Meshlet* meshlets;
+	const unsigned int* meshlet_vertices;
+	const unsigned char* meshlet_triangles;
+
+	const float* vertex_positions;
+	size_t vertex_stride_float;
+};
+
+static void writeMeshletPage(const MeshletPageWriter& writer, size_t page_index, size_t meshlet_offset, size_t meshlet_count)
+{
+	unsigned char* page = writer.pages + page_index * writer.page_size;
+	memset(page, 0, writer.page_size);
+
+	meshopt_MeshletPage& entry = writer.page_directory[page_index];
+	entry.meshlet_offset = unsigned(meshlet_offset);
+	entry.meshlet_count = unsigned(meshlet_count);
+
+	for (int k = 0; k < 3; ++k)
+	{
+		entry.min[k] = FLT_MAX;
+		entry.max[k] = -FLT_MAX;
+	}
+
+	// per-meshlet headers are followed by vertex and triangle data for each meshlet
+	size_t data_offset = meshlet_count * sizeof(meshopt_PackedMeshlet);
+
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		const meshopt_Meshlet& meshlet = writer.meshlets[meshlet_offset + i];
+		assert(meshlet.vertex_count <= kMeshletPackMaxVertices && meshlet.triangle_count <= kMeshletPackMaxTriangles);
+
+		const unsigned int* vertices = &writer.meshlet_vertices[meshlet.vertex_offset];
+
+		float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t j = 0; j < meshlet.vertex_count; ++j)
+		{
+			const float* p = writer.vertex_positions + vertices[j] * writer.vertex_stride_float;
+
+			for (int k = 0; k < 3; ++k)
+			{
+				minv[k] = p[k] < minv[k] ? p[k] : minv[k];
+				maxv[k] = p[k] > maxv[k] ? p[k] : maxv[k];
+			}
+		}
+
+		meshopt_PackedMeshlet header = {};
+		float inv_scale[3];
+
+		for (int k = 0; k < 3; ++k)
+		{
+			float extent = meshlet.vertex_count ? maxv[k] - minv[k] : 0.f;
+
+			header.offset[k] = meshlet.vertex_count ? minv[k] : 0.f;
+			header.scale[k] = extent / float((1 << writer.bits) - 1);
+			inv_scale[k] = extent == 0.f ? 0.f : float((1 << writer.bits) - 1) / extent;
+
+			entry.min[k] = minv[k] < entry.min[k] ? minv[k] : entry.min[k];
+			entry.max[k] = maxv[k] > entry.max[k] ? maxv[k] : entry.max[k];
+		}
+
+		header.data_offset = unsigned(data_offset);
+		header.vertex_count = (unsigned char)meshlet.vertex_count;
+		header.bits = (unsigned char)writer.bits;
+		header.triangle_count = (unsigned short)meshlet.triangle_count;
+
+		memcpy(page + i * sizeof(meshopt_PackedMeshlet), &header, sizeof(header));
+
+		// quantized positions form a bit stream of 32-bit words, component by component; values may straddle word boundaries
+		unsigned int vertex_data[(kMeshletPackMaxVertices * 3 * 16 + 31) / 32 + 1] = {};
+		size_t bit = 0;
+
+		for (size_t j = 0; j < meshlet.vertex_count; ++j)
+		{
+			const float* p = writer.vertex_positions + vertices[j] * writer.vertex_stride_float;
+
+			for (int k = 0; k < 3; ++k)
+			{
+				unsigned int q = unsigned(int((p[k] - header.offset[k]) * inv_scale[k] + 0.5f));
+				q = q < (1u << writer.bits) ? q : (1u << writer.bits) - 1;
+
+				size_t shift = bit % 32;
+
+				vertex_data[bit / 32] |= q << shift;
+
+				if (shift + writer.bits > 32)
+					vertex_data[bit / 32 + 1] |= q >> (32 - shift);
+
+				bit += writer.bits;
+			}
+		}
+
+		size_t vertex_size = (meshlet.vertex_count * 3 * writer.bits + 31) / 32 * 4;
+
+		memcpy(page + data_offset, vertex_data, vertex_size);
+		memcpy(page + data_offset + vertex_size, &writer.meshlet_triangles[meshlet.triangle_offset], meshlet.triangle_count * 3);
+
+		data_offset += getPackedMeshletSize(meshlet, writer.bits) - sizeof(meshopt_PackedMeshlet);
+	}
+
+	assert(data_offset <= writer.page_size);
+}
+
+static size_t packMeshletPages(const meshopt_Meshlet* meshlets, size_t meshlet_count, size_t page_size, int bits, const MeshletPageWriter* writer)
+{
+	// meshlets that exceed builder limits may not fit into a page; reject the input before writing any pages
+	for (size_t i = 0; i < meshlet_count; ++i)
+	{
+		assert(meshlets[i].vertex_count <= kMeshletPackMaxVertices && meshlets[i].triangle_count <= kMeshletPackMaxTriangles);
+
+		if (meshlets[i].vertex_count > kMeshletPackMaxVertices || meshlets[i].triangle_count > kMeshletPackMaxTriangles)
+			return 0;
+	}
+
+	size_t page_count = 0;
+	size_t meshlet_offset = 0;
+
+	while (meshlet_offset < meshlet_count)
+	{
+		size_t page_meshlets = 0;
+		size_t page_bytes = 0;
+
+		// meshlets are placed into pages in order, so each page is a consecutive range of meshlets
+		while (meshlet_offset + page_meshlets < meshlet_count)
+		{
+			size_t size = getPackedMeshletSize(meshlets[meshlet_offset + page_meshlets], bits);
+
+			if (page_bytes + size > page_size)
+				break;
+
+			page_bytes += size;
+			page_meshlets++;
+		}
+
+		// unreachable given the limits above and the minimum page size, but an empty page would never make progress
+		assert(page_meshlets > 0);
+
+		if (page_meshlets == 0)
+			return 0;
+
+		if (writer)
+			writeMeshletPage(*writer, page_count, meshlet_offset, page_meshlets);
+
+		meshlet_offset += page_meshlets;
+		page_count++;
+	}
+
+	return page_count;
+}
+
+} // namespace meshopt
+
+size_t meshopt_packMeshletPagesBound(const meshopt_Meshlet* meshlets, size_t meshlet_count, size_t page_size, int bits)
+{
+	using namespace meshopt;
+
+	assert(page_size >= 4096 && page_size % 4 == 0);
+	assert(bits >= 1 && bits <= 16);
+
+	return packMeshletPages(meshlets, meshlet_count, page_size, bits, NULL);
+}
+
+size_t meshopt_packMeshletPages(unsigned char* pages, meshopt_MeshletPage* page_directory, const meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t page_size, int bits)
+{
+	using namespace meshopt;
+
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(page_size >= 4096 && page_size % 4 == 0);
+	assert(bits >= 1 && bits <= 16);
+
+	(void)vertex_count;
+
+	MeshletPageWriter writer = {};
+	writer.pages = pages;
+	writer.page_directory = page_directory;
+	writer.page_size = page_size;
+	writer.bits = bits;
+	writer.meshlets = meshlets;
+	writer.meshlet_vertices = meshlet_vertices;
+	writer.meshlet_triangles = meshlet_triangles;
+	writer.vertex_positions = vertex_positions;
+	writer.vertex_stride_float = vertex_positions_stride / sizeof(float);
+
+	return packMeshletPages(meshlets, meshlet_count, page_size, bits, &writer);
+}
@@ -49,6 +49,14 @@ struct meshopt_Stream
 	size_t stride;
 };
 
+/**
+ * Experimental: Task scheduler callback
+ * Algorithms that support parallel execution split the work into count independent tasks and pass them to the scheduler.
+ * The scheduler must call task(task_context, i) for every i in [0..count) and return once all tasks have completed; tasks can run in any order and on any thread.
+ * When the scheduler is NULL, tasks run serially on the calling thread. Unless noted otherwise, tasks don't allocate memory, so allocation callbacks don't need to be thread-safe.
+ */
+typedef void (*meshopt_TaskScheduler)(void* scheduler_context, void (*task)(void* task_context, size_t index), void* task_context, size_t count);
+
 /**
  * Generates a vertex remap table from the vertex buffer and an optional index buffer and returns number of unique vertices
  * As a result, all vertices that are binary equivalent map to the same (new) location, with no gaps in the resulting sequence.
@@ -73,6 +81,32 @@ MESHOPTIMIZER_API size_t meshopt_generateVertexRemap(unsigned int* destination,
  */
 MESHOPTIMIZER_API size_t meshopt_generateVertexRemapMulti(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count);
 
+/**
+ * Experimental: Generates a vertex remap table using multiple threads
+ * Produces the same remap table as meshopt_generateVertexRemap/meshopt_generateVertexRemapMulti, but hashes and deduplicates vertices in parallel using the scheduler.
+ * Vertices are partitioned by hash and each partition is deduplicated independently; this requires ~24 extra bytes of memory per vertex.
+ *
+ * destination must contain enough space for the resulting remap table (vertex_count elements)
+ * indices can be NULL if the input is unindexed
+ * scheduler can be NULL, in which case all work is performed on the calling thread
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateVertexRemapParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, const void* vertices, size_t vertex_count, size_t vertex_size, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateVertexRemapMultiParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
+/**
+ * Experimental: Generates a vertex remap table from multiple vertex streams, merging vertices that are equal within a tolerance
+ * Each stream is treated as an array of floats; two vertices are merged when every component of stream i differs by at most tolerances[i].
+ * Every vertex is compared against the first vertex of each merged group (in index order), so merged vertices never drift further than the tolerance from it.
+ * The first (up to) 3 components of the first stream, typically positions, are used to build a spatial grid; the expected time is linear for tolerances that are small relative to the vertex spacing.
+ * Grid components that exceed the tolerance by a factor of 2^30 or more are matched exactly, since float precision is coarser than the tolerance at that magnitude.
+ * Tolerance 0 merges vertices that have exactly equal values (including -0 and +0), which is similar to meshopt_generateVertexRemapMulti.
+ *
+ * destination must contain enough space for the resulting remap table (vertex_count elements)
+ * indices can be NULL if the input is unindexed
+ * stream sizes must be divisible by 4; tolerances must contain stream_count non-negative values
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateVertexRemapFuzzy(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count, const float* tolerances);
+
 /**
  * Generates vertex buffer from the source vertex buffer and remap table generated by meshopt_generateVertexRemap
  *
@@ -89,6 +123,44 @@ MESHOPTIMIZER_API void meshopt_remapVertexBuffer(void* destination, const void*
  */
 MESHOPTIMIZER_API void meshopt_remapIndexBuffer(unsigned int* destination, const unsigned int* indices, size_t index_count, const unsigned int* remap);
 
+/**
+ * Experimental: Generates an indexed mesh from multiple vertex streams and an optional index buffer and returns number of unique vertices
+ * This is equivalent to meshopt_generateVertexRemapMulti followed by meshopt_remapVertexBuffer for each stream and meshopt_remapIndexBuffer, but reads each stream only once and only allocates temporary vertex storage when remapping out of order in place.
+ * Vertices are written tightly packed (streams[i].size bytes per vertex) in order of first appearance in the index buffer.
+ * If index_size is 2 and the number of unique vertices exceeds 65536, nothing is written; the function still returns the number of unique vertices so that the call can be repeated with index_size 4.
+ *
+ * destination_indices must contain enough space for the resulting index buffer (index_count elements of index_size bytes); it can be equal to indices
+ * destination_streams must contain stream_count pointers with enough space for the resulting vertex data (vertex_count elements of streams[i].size bytes); destination_streams[i] can be equal to streams[i].data if the stream doesn't share memory with other streams
+ * indices can be NULL if the input is unindexed
+ * index_size must be 2 or 4
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_generateIndexedMesh(void* destination_indices, size_t index_size, void** destination_streams, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_Stream* streams, size_t stream_count);
+
+/**
+ * Experimental: Incremental vertex indexer
+ * Converts an unindexed vertex stream (triangle soup) that is too large to fit in memory into an indexed mesh, one batch at a time.
+ * Recently seen unique vertices are kept in a bounded cache; vertices that are evicted from the cache are emitted again if they reappear later, so the output may contain some duplicates.
+ * For inputs with good locality, such as STL files or marching cubes output, most duplicates are found with a cache of a few thousand vertices.
+ * The indexer uses ~2 * cache_size * (vertex_size + 8) bytes of memory; it can only be used by one thread at a time.
+ *
+ * vertex_size should be the size of each vertex in bytes (<= 256)
+ * cache_size should be the number of recent unique vertices that are guaranteed to be kept for deduplication
+ */
+struct meshopt_VertexIndexer;
+
+MESHOPTIMIZER_EXPERIMENTAL struct meshopt_VertexIndexer* meshopt_createVertexIndexer(size_t vertex_size, size_t cache_size);
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_destroyVertexIndexer(struct meshopt_VertexIndexer* indexer);
+
+/**
+ * Experimental: Indexes a batch of vertices and returns the number of new unique vertices
+ * Indices refer to the unique vertices emitted by all batches processed by the indexer so far, so the index buffers and vertex buffers of each batch can simply be concatenated.
+ *
+ * destination_indices must contain enough space for the resulting indices (vertex_count elements)
+ * destination_vertices must contain enough space for the new unique vertices (vertex_count elements of vertex_size bytes)
+ * vertex_count doesn't need to be a multiple of 3
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_indexVertexBatch(struct meshopt_VertexIndexer* indexer, unsigned int* destination_indices, void* destination_vertices, const void* vertices, size_t vertex_count);
+
 /**
  * Generate index buffer that can be used for more efficient rendering when only a subset of the vertex attributes is necessary
  * All vertices that are binary equivalent (wrt first vertex_size bytes) map to the first vertex in the original vertex buffer.
@@ -181,6 +253,18 @@ MESHOPTIMIZER_API void meshopt_optimizeVertexCacheStrip(unsigned int* destinatio
  */
 MESHOPTIMIZER_API void meshopt_optimizeVertexCacheFifo(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size);
 
+/**
+ * Experimental: Parallel vertex transform cache optimizer
+ * Reorders indices to reduce the number of GPU vertex shader invocations, splitting large meshes into spatially coherent regions that are optimized independently
+ * Regions are processed as independent tasks using the scheduler; the result is usually within ~1% of meshopt_optimizeVertexCache in terms of ACMR, and meshes with up to 64K triangles produce identical results.
+ * If index buffer contains multiple ranges for multiple draw calls, this functions needs to be called on each range individually.
+ *
+ * destination must contain enough space for the resulting index buffer (index_count elements)
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * scheduler can be NULL, in which case all work is performed on the calling thread
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeVertexCacheParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
 /**
  * Overdraw optimizer
  * Reorders indices to reduce the number of GPU vertex shader invocations and the pixel overdraw
@@ -349,6 +433,8 @@ enum
 	meshopt_SimplifySparse = 1 << 1,
 	/* Treat error limit and resulting error as absolute instead of relative to mesh extents. */
 	meshopt_SimplifyErrorAbsolute = 1 << 2,
+	/* Experimental: Reduce peak memory consumption by using a compact adjacency representation, at the cost of slower simplification. Results are identical to the default mode. */
+	meshopt_SimplifyLowMemory = 1 << 3,
 };
 
 /**
@@ -380,6 +466,97 @@ MESHOPTIMIZER_API size_t meshopt_simplify(unsigned int* destination, const unsig
  */
 MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyWithAttributes(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* result_error);
 
+/**
+ * Experimental: Simplifier context
+ * Owns scratch memory that is reused between simplification calls, which eliminates allocation overhead when simplifying many meshes.
+ * Scratch memory grows to accommodate the largest mesh simplified with the context and is only released when the context is destroyed.
+ * The context can only be used by one thread at a time; to simplify meshes in parallel, use a separate context for each thread.
+ */
+struct meshopt_SimplifierContext;
+
+MESHOPTIMIZER_EXPERIMENTAL struct meshopt_SimplifierContext* meshopt_createSimplifierContext(void);
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_destroySimplifierContext(struct meshopt_SimplifierContext* context);
+
+/**
+ * Experimental: Mesh simplifier with reusable context
+ * The algorithm is identical to meshopt_simplifyWithAttributes and produces the same results; see meshopt_simplifyWithAttributes documentation for details.
+ * Temporary memory is taken from the context instead of the allocator; use meshopt_simplifyScratchBound to estimate the amount of memory the context will need.
+ *
+ * vertex_attributes/attribute_weights can be NULL when attribute_count is 0
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyWithContext(struct meshopt_SimplifierContext* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* result_error);
+
+/**
+ * Experimental: Simplification statistics
+ * Describes the last meshopt_simplifyWithContext call made with the context; obtained via meshopt_getSimplifierStats.
+ * Statistics are always collected for context-based simplification and don't require a special build.
+ */
+enum
+{
+	/* Target index count was reached */
+	meshopt_SimplifyStopTarget = 0,
+	/* No edges can be collapsed due to topology restrictions (borders, seams, locked or complex vertices) */
+	meshopt_SimplifyStopTopology,
+	/* All remaining collapses exceed the error limit */
+	meshopt_SimplifyStopError,
+	/* All remaining collapses within the error limit would flip triangles */
+	meshopt_SimplifyStopFlip,
+	/* Simplification was cancelled by the callback set via meshopt_setSimplifierCallback */
+	meshopt_SimplifyStopCancel,
+};
+
+struct meshopt_SimplifyStats
+{
+	/* reason the simplification stopped, see meshopt_SimplifyStopX */
+	unsigned int stop_reason;
+	/* number of simplification passes */
+	unsigned int passes;
+
+	/* number of unique vertex positions that can't be moved, either due to topology or vertex_lock */
+	unsigned int locked_vertices;
+
+	/* number of edge collapses that were evaluated and performed across all passes */
+	unsigned int collapses_evaluated;
+	unsigned int collapses_performed;
+	/* number of collapses rejected because one of the vertices already moved during the same pass */
+	unsigned int collapses_rejected_locked;
+	/* number of collapses rejected because they would flip triangles */
+	unsigned int collapses_rejected_flip;
+
+	/* wall clock time spent in each phase of the call, in seconds; uses a monotonic clock where available and clock() otherwise */
+	float time_setup;
+	float time_quadrics;
+	float time_pick;
+	float time_rank;
+	float time_collapse;
+};
+
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_getSimplifierStats(const struct meshopt_SimplifierContext* context, struct meshopt_SimplifyStats* stats);
+
+/**
+ * Experimental: Set progress callback for context-based simplification
+ * The callback is called by meshopt_simplifyWithContext before every simplification pass with the current index count and error (in result_error units).
+ * When the callback returns 0, simplification stops and the intermediate result is returned along with its error; this can be used to cancel stale requests or implement time budgets.
+ * Intermediate results are always valid, but they are typically larger than target_index_count.
+ *
+ * callback can be NULL to disable the callback
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_setSimplifierCallback(struct meshopt_SimplifierContext* context, int (*callback)(void* callback_data, size_t index_count, float error), void* callback_data);
+
+/**
+ * Experimental: Streaming mesh simplifier
+ * Simplifies the mesh in chunks of chunk_index_count indices, keeping vertices shared between chunks locked, and writes the results incrementally.
+ * After the first pass, subsequent passes process the intermediate result with shifted chunk boundaries until the target is reached or no progress can be made.
+ * Temporary memory is proportional to the chunk size plus 5 bytes per vertex, and each chunk briefly allocates an additional vertex_count/8 bytes for the sparse vertex filter; this makes it possible to simplify meshes with index buffers that don't fit into memory (e.g. memory-mapped).
+ * For good results, input triangles need to be spatially coherent, for example sorted with meshopt_spatialSortTriangles or an equivalent out-of-core Morton sort.
+ * Errors are accumulated across passes, so result_error is a conservative estimate; see meshopt_simplifyWithAttributes documentation for other parameters.
+ *
+ * destination must contain enough space for the source index buffer (index_count elements); it may alias indices
+ * options must be a bitmask composed of meshopt_SimplifyX options except meshopt_SimplifySparse, which is implied for each chunk
+ * chunk_index_count must be a multiple of 3; larger chunks reduce the number of passes and improve the quality
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyStream(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, size_t chunk_index_count, float* result_error);
+
 /**
  * Experimental: Mesh simplifier (sloppy)
  * Reduces the number of triangles in the mesh, sacrificing mesh appearance for simplification performance
@@ -409,6 +586,65 @@ MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifySloppy(unsigned int* destinati
  */
 MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t target_vertex_count);
 
+/**
+ * Experimental: Point cloud simplifier for multiple targets
+ * Produces the same results as calling meshopt_simplifyPoints for each target, but analyzes the point cloud once, which is faster when building LOD pyramids.
+ * Returns the total number of points; results for each target are written to destination back to back, and destination_counts receives the number of points for each target.
+ *
+ * destination must contain enough space for the sum of all target_vertex_counts
+ * destination_counts must contain target_count elements
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyPointsMulti(unsigned int* destination, size_t* destination_counts, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, const size_t* target_vertex_counts, size_t target_count);
+
+struct meshopt_PointNode
+{
+	/* bounding box of all points in the node subtree */
+	float bounds_min[3];
+	float bounds_max[3];
+
+	/* approximate distance between points stored in this node and its ancestors */
+	float spacing;
+
+	/* depth of the node in the hierarchy; root has depth 0 */
+	unsigned int depth;
+
+	/* points stored in this node are destination[point_offset..point_offset+point_count) */
+	unsigned int point_offset;
+	unsigned int point_count;
+
+	/* children are stored contiguously; leaf nodes have no children */
+	unsigned int child_offset;
+	unsigned int child_count;
+};
+
+/**
+ * Experimental: Point cloud hierarchy builder
+ * Builds an octree-style level of detail hierarchy for the point cloud, similar to Potree; node 0 is the root, and children of every node are stored after it.
+ * Every point is stored in exactly one node; points in a node and all of its ancestors sample the node volume at the node spacing, so nodes can be streamed and rendered by screen-space error.
+ * Each interior node keeps one point for each of node_grid_size^3 cells of its volume, using the same color-aware selection as meshopt_simplifyPoints; leaf nodes store all remaining points.
+ * Interior nodes may have no points when all points in their volume are stored in their ancestors.
+ * Returns the number of nodes; destination receives indices of all points, grouped by node.
+ *
+ * nodes must contain enough space for the hierarchy; use meshopt_buildPointHierarchyBound to compute the worst case size
+ * destination must contain enough space for all points (vertex_count elements)
+ * vertex_colors can be NULL; when it's not NULL, it should have float3 color in the first 12 bytes of each vertex
+ * node_grid_size must be a power of two in [1..1024]; 16 is a reasonable default
+ * max_leaf_points determines the maximum number of points in the subtree of a leaf node; nodes at the maximum depth (10) are always leaves
+ * scheduler can be NULL; when it's not NULL, nodes at each depth are processed in parallel using the scheduler
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildPointHierarchy(struct meshopt_PointNode* nodes, unsigned int* destination, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t node_grid_size, size_t max_leaf_points, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildPointHierarchyBound(size_t vertex_count, size_t max_leaf_points);
+
+/**
+ * Experimental: Simplifier memory estimator
+ * Returns the upper bound on the total size (in bytes) of temporary allocations that meshopt_simplify/meshopt_simplifyWithAttributes make for the given input
+ * This can be used to check memory requirements before simplifying very large meshes; note that it doesn't account for allocator overhead.
+ *
+ * attribute_count should be the number of attributes with non-zero weights, or 0 when meshopt_simplify is used
+ * options must be a bitmask composed of meshopt_SimplifyX options; the amount of memory depends on meshopt_SimplifySparse and meshopt_SimplifyLowMemory
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_simplifyScratchBound(size_t index_count, size_t vertex_count, size_t attribute_count, unsigned int options);
+
 /**
  * Returns the error scaling factor used by the simplifier to convert between absolute and relative extents
  *
@@ -455,6 +691,32 @@ struct meshopt_VertexCacheStatistics
  */
 MESHOPTIMIZER_API struct meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size, unsigned int warp_size, unsigned int primgroup_size);
 
+enum meshopt_VertexCacheReplacement
+{
+	/* Vertices are evicted in the order they were added to the cache; this matches meshopt_analyzeVertexCache */
+	meshopt_VertexCacheFifo,
+	/* Vertices are evicted in the order they were last used */
+	meshopt_VertexCacheLru,
+};
+
+struct meshopt_VertexCacheProfile
+{
+	unsigned int cache_size;
+	unsigned int warp_size;
+	unsigned int primgroup_size;
+	enum meshopt_VertexCacheReplacement replacement;
+};
+
+/**
+ * Experimental: Vertex transform cache analyzer for multiple cache models
+ * Simulates all cache profiles in a single pass over the index buffer, and returns statistics for each profile in results
+ * FIFO profiles produce the same results as meshopt_analyzeVertexCache; they are simulated in groups of 4, using SIMD when available
+ *
+ * results must contain enough space for all profiles (profile_count elements)
+ * profiles use the same cache_size/warp_size/primgroup_size parameters as meshopt_analyzeVertexCache; cache_size must be at least 3
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_analyzeVertexCacheMulti(struct meshopt_VertexCacheStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const struct meshopt_VertexCacheProfile* profiles, size_t profile_count);
+
 struct meshopt_OverdrawStatistics
 {
 	unsigned int pixels_covered;
@@ -471,6 +733,18 @@ struct meshopt_OverdrawStatistics
  */
 MESHOPTIMIZER_API struct meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 
+/**
+ * Experimental: Overdraw analyzer with configurable views
+ * Returns overdraw statistics accumulated over orthographic views along each view direction, rasterized at viewport_size x viewport_size resolution
+ * meshopt_analyzeOverdraw is equivalent to three views along +X, +Y and +Z with a 256x256 viewport; views are rasterized as independent tasks using the scheduler
+ *
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * view_directions should contain view_count float3 directions; directions don't need to be normalized
+ * viewport_size must be between 1 and 1024
+ * scheduler can be NULL, in which case all work is performed on the calling thread; when scheduler is used, each view needs separate buffers of viewport_size^2 * 16 + vertex_count * 12 bytes
+ */
+MESHOPTIMIZER_EXPERIMENTAL struct meshopt_OverdrawStatistics meshopt_analyzeOverdrawViews(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, size_t viewport_size, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
 struct meshopt_VertexFetchStatistics
 {
 	unsigned int bytes_fetched;
@@ -521,9 +795,36 @@ MESHOPTIMIZER_API size_t meshopt_buildMeshlets(struct meshopt_Meshlet* meshlets,
 MESHOPTIMIZER_API size_t meshopt_buildMeshletsScan(struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, size_t vertex_count, size_t max_vertices, size_t max_triangles);
 MESHOPTIMIZER_API size_t meshopt_buildMeshletsBound(size_t index_count, size_t max_vertices, size_t max_triangles);
 
+/**
+ * Experimental: Meshlet builder for raytracing
+ * Splits the mesh into a set of meshlets using the same algorithm as meshopt_buildMeshlets, but grows each meshlet to minimize the surface area of its bounding box instead of its bounding sphere.
+ * This results in tighter cluster boxes, which reduces traversal cost when clusters are used as leaves of a bounding volume hierarchy.
+ *
+ * meshlets, meshlet_vertices and meshlet_triangles must contain enough space for all meshlets, see meshopt_buildMeshlets (the same bound applies)
+ * meshlet_boxes can be NULL; otherwise it must contain enough space for 6 floats per meshlet (min x/y/z, max x/y/z) which will receive bounding boxes of all meshlets
+ * max_vertices and max_triangles must not exceed implementation limits (max_vertices <= 255 - not 256!, max_triangles <= 512; max_triangles must be divisible by 4)
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsSpatial(struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, float* meshlet_boxes, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles);
+
+/**
+ * Experimental: Meshlet builder with parallel execution
+ * Splits the mesh into spatially coherent regions of ~64K triangles, builds meshlets for each region using the same algorithm as meshopt_buildMeshlets and concatenates the results.
+ * Regions are processed as independent tasks using the scheduler; the output doesn't depend on the order in which tasks are executed.
+ * Meshlets never cross region boundaries, so the results have slightly more meshlets than meshopt_buildMeshlets for large meshes; for meshes with <64K triangles, the only difference is the triangle order the algorithm starts from.
+ *
+ * meshlets must contain enough space for all meshlets, worst case size can be computed with meshopt_buildMeshletsParallelBound (which may exceed meshopt_buildMeshletsBound)
+ * meshlet_vertices must contain enough space for all meshlets, worst case size is equal to max_meshlets * max_vertices
+ * meshlet_triangles must contain enough space for all meshlets, worst case size is equal to max_meshlets * max_triangles * 3
+ * scheduler can be NULL, in which case all work is performed on the calling thread
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsParallel(struct meshopt_Meshlet* meshlets, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, float cone_weight, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildMeshletsParallelBound(size_t index_count, size_t max_vertices, size_t max_triangles);
+
 /**
  * Experimental: Meshlet optimizer
  * Reorders meshlet vertices and triangles to maximize locality to improve rasterizer throughput
+ * Triangles are reordered greedily using per-meshlet vertex adjacency; vertices are reordered in first use order.
+ * This usually takes time linear in the number of triangles, but incoherent input with high-valence vertices (such as a shuffled fan) takes quadratic time, bounded by meshlet limits.
  *
  * meshlet_triangles and meshlet_vertices must refer to meshlet triangle and vertex index data; when buildMeshlets* is used, these
  * need to be computed from meshlet's vertex_offset and triangle_offset
@@ -531,6 +832,57 @@ MESHOPTIMIZER_API size_t meshopt_buildMeshletsBound(size_t index_count, size_t m
  */
 MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeMeshlet(unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, size_t triangle_count, size_t vertex_count);
 
+/**
+ * Experimental: Meshlet optimizer for multiple meshlets
+ * Optimizes all meshlets in one call; the results are identical to calling meshopt_optimizeMeshlet for each meshlet.
+ * Meshlets are processed in batches as independent tasks using the scheduler.
+ *
+ * meshlets, meshlet_vertices and meshlet_triangles should be the output of meshopt_buildMeshlets* functions or use the same layout
+ * scheduler can be NULL, in which case all work is performed on the calling thread
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_optimizeMeshletBatch(const struct meshopt_Meshlet* meshlets, size_t meshlet_count, unsigned int* meshlet_vertices, unsigned char* meshlet_triangles, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
+struct meshopt_PackedMeshlet
+{
+	/* dequantized vertex position is offset + value * scale */
+	float offset[3];
+	float scale[3];
+
+	/* byte offset of meshlet data from the start of the page; vertex data is followed by triangle data at data_offset + (vertex_count * 3 * bits + 31) / 32 * 4 */
+	unsigned int data_offset;
+
+	unsigned char vertex_count;
+	unsigned char bits;
+	unsigned short triangle_count;
+};
+
+struct meshopt_MeshletPage
+{
+	/* bounding box of all meshlets in the page */
+	float min[3];
+	float max[3];
+
+	/* pages contain consecutive meshlets from the input */
+	unsigned int meshlet_offset;
+	unsigned int meshlet_count;
+};
+
+/**
+ * Experimental: Meshlet page packer
+ * Packs meshlets into fixed size pages that can be streamed and uploaded to the GPU as is; meshlets are stored in order, starting a new page when the next meshlet doesn't fit.
+ * Each page starts with meshopt_PackedMeshlet headers for all meshlets in the page, followed by data for each meshlet:
+ * vertex positions quantized relative to meshlet bounds to the given number of bits, stored as a bit stream of 32-bit words (x, y, z for each vertex in turn, least significant bits first),
+ * and triangles using the same format as meshlet_triangles (3 bytes per triangle, padded to 4 bytes). Unused page space is filled with zeroes.
+ * Returns the number of pages; page_directory receives page bounds and meshlet ranges. Returns 0 without writing any pages if a meshlet exceeds meshlet builder limits (255 vertices, 512 triangles).
+ *
+ * pages must contain enough space for page_count * page_size bytes, and page_directory for page_count entries; page_count can be computed with meshopt_packMeshletPagesBound
+ * meshlets, meshlet_vertices and meshlet_triangles should be the output of meshopt_buildMeshlets* functions or use the same layout; vertex indices are not stored, and can be fetched from meshlet_vertices using page meshlet ranges
+ * page_size must be divisible by 4 and be at least 4096 bytes, which guarantees that any meshlet fits into a page
+ * bits must be in [1..16] range; quantization error is at most half of the scale for each axis
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_packMeshletPages(unsigned char* pages, struct meshopt_MeshletPage* page_directory, const struct meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t page_size, int bits);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_packMeshletPagesBound(const struct meshopt_Meshlet* meshlets, size_t meshlet_count, size_t page_size, int bits);
+
 struct meshopt_Bounds
 {
 	/* bounding sphere, useful for frustum and occlusion culling */
@@ -573,6 +925,144 @@ struct meshopt_Bounds
 MESHOPTIMIZER_API struct meshopt_Bounds meshopt_computeClusterBounds(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 MESHOPTIMIZER_API struct meshopt_Bounds meshopt_computeMeshletBounds(const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, size_t triangle_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride);
 
+/**
+ * Experimental: Cluster bounds generator for multiple meshlets
+ * Computes bounds for all meshlets in one call; the results are identical to calling meshopt_computeMeshletBounds for each meshlet.
+ * Meshlets are processed in batches as independent tasks using the scheduler, and triangle normals are computed using SSE when available (there is no NEON path).
+ *
+ * bounds must contain enough space for all meshlets (meshlet_count elements)
+ * meshlets, meshlet_vertices and meshlet_triangles should be the output of meshopt_buildMeshlets* functions or use the same layout
+ * scheduler can be NULL, in which case all work is performed on the calling thread
+ */
+MESHOPTIMIZER_EXPERIMENTAL void meshopt_computeMeshletBoundsBatch(struct meshopt_Bounds* bounds, const struct meshopt_Meshlet* meshlets, size_t meshlet_count, const unsigned int* meshlet_vertices, const unsigned char* meshlet_triangles, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
+struct meshopt_DepthPyramid
+{
+	/* depth levels stored back to back, starting with width x height texels; each next level halves the dimensions, rounding down to a minimum of 1 */
+	const float* data;
+	size_t width;
+	size_t height;
+	size_t levels;
+
+	/* column-major matrix that transforms world space positions to clip space; clip space depth must be in [0..1] range, increasing with distance */
+	float view_projection[16];
+};
+
+/**
+ * Experimental: Cluster culling
+ * Tests cluster bounds against the frustum, the normal cone and, optionally, a depth pyramid; uses SIMD to test 4 clusters at a time when available.
+ * Returns the number of visible clusters; destination receives their indices in increasing order.
+ *
+ * destination must contain enough space for all visible clusters (bounds_count elements)
+ * frustum_planes should contain plane_count planes as 4 floats (a, b, c, d) each, with unit normals pointing inside; a cluster is culled when dot(center, normal) + d < -radius
+ * camera_position can be NULL to skip cone culling; otherwise uses the formula that doesn't need cone apex (see meshopt_computeClusterBounds)
+ * depth_pyramid can be NULL to skip occlusion culling; each texel must contain the farthest depth of the area it covers, and texel (x, y) of the first level covers NDC coordinates [x / width * 2 - 1, (x + 1) / width * 2 - 1] (same for y)
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_cullMeshlets(unsigned int* destination, const struct meshopt_Bounds* bounds, size_t bounds_count, const float* frustum_planes, size_t plane_count, const float* camera_position, const struct meshopt_DepthPyramid* depth_pyramid);
+
+/**
+ * Experimental: Cluster partitioner
+ * Partitions clusters into groups of connected clusters, which is useful for merging and simplifying groups of clusters when building cluster hierarchies.
+ * Uses a multilevel scheme: the cluster adjacency graph, weighted by the number of shared vertices, is coarsened using heavy edge matching until nodes reach the target size, and the partition is refined at each level on the way back using Fiduccia-Mattheyses passes.
+ * Returns the number of partitions; partition sizes are balanced around target_partition_size and never exceed it by more than 50%.
+ *
+ * destination must contain enough space for the resulting partition ids (cluster_count elements); ids are assigned in order of first appearance
+ * cluster_indices should have the vertex indices of all clusters concatenated, with cluster_index_counts[i] indices for cluster i
+ * clusters are only considered adjacent when they share vertex indices; to group clusters across attribute seams, use meshopt_generateShadowIndexBuffer to remap indices first
+ * scheduler can be NULL, in which case all work is performed on the calling thread; coarsening is performed in parallel and the result doesn't depend on the task order
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_partitionClusters(unsigned int* destination, const unsigned int* cluster_indices, size_t total_index_count, const unsigned int* cluster_index_counts, size_t cluster_count, size_t vertex_count, size_t target_partition_size, meshopt_TaskScheduler scheduler, void* scheduler_context);
+
+struct meshopt_BvhNode
+{
+	/* bounding boxes of 4 children in SoA layout for SIMD traversal; unused children have empty boxes (min > max) */
+	float min_x[4];
+	float min_y[4];
+	float min_z[4];
+	float max_x[4];
+	float max_y[4];
+	float max_z[4];
+
+	/* for leaf children, first element of the leaf in primitive_indices and number of elements; for inner children, node index and 0; unused children have ~0u and 0 */
+	unsigned int children[4];
+	unsigned int counts[4];
+};
+
+/**
+ * Experimental: Bounding volume hierarchy builder
+ * Builds a 4-wide BVH with binned SAH; returns the number of nodes, with the root at index 0 and nodes stored in depth-first order.
+ * Primitives are sorted along Morton curve and split into chunks of ~4K primitives; chunks are built as independent tasks using the scheduler and are combined with SAH over chunk bounds.
+ *
+ * nodes must contain enough space for the resulting tree, worst case size can be computed with meshopt_buildBvhBound
+ * primitive_indices must contain enough space for primitive_count elements; leaves refer to ranges of primitive indices
+ * primitive_boxes should contain 6 floats per primitive (min x/y/z, max x/y/z); for meshlets, use meshlet_boxes from meshopt_buildMeshletsSpatial or boxes around meshopt_Bounds spheres
+ * max_leaf_size limits the number of primitives per leaf; leaves may have fewer primitives when that is cheaper according to SAH
+ * scheduler can be NULL, in which case all work is performed on the calling thread; the result doesn't depend on the task order
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildBvh(struct meshopt_BvhNode* nodes, unsigned int* primitive_indices, const float* primitive_boxes, size_t primitive_count, size_t max_leaf_size, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildBvhTriangles(struct meshopt_BvhNode* nodes, unsigned int* primitive_indices, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_leaf_size, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildBvhBound(size_t primitive_count);
+
+struct meshopt_LODBounds
+{
+	/* bounding sphere of the geometry that the error applies to */
+	float center[3];
+	float radius;
+
+	/* simplification error in mesh units; FLT_MAX when there is no coarser representation */
+	float error;
+};
+
+struct meshopt_Cluster
+{
+	/* offset and count of cluster indices in cluster_indices array; indices refer to the original vertex buffer */
+	unsigned int index_offset;
+	unsigned int index_count;
+
+	/* hierarchy level the cluster was produced at; 0 for clusters of the original mesh */
+	unsigned int depth;
+
+	/* group the cluster was merged into, or ~0u if the cluster is part of the coarsest representation */
+	unsigned int group;
+
+	/* bounds of the cluster itself and of the coarser representation that replaces it */
+	/* a cluster should be rendered when its self error is acceptable and its parent error is not */
+	struct meshopt_LODBounds self;
+	struct meshopt_LODBounds parent;
+};
+
+struct meshopt_ClusterGroup
+{
+	/* clusters that were merged into the group; cluster ids are stored in consecutive range of group_clusters array */
+	unsigned int cluster_offset;
+	unsigned int cluster_count;
+
+	/* clusters that were produced by simplifying the group; stored in consecutive range of clusters array */
+	unsigned int result_offset;
+	unsigned int result_count;
+
+	/* bounds of the simplified geometry; equal to parent bounds of merged clusters and self bounds of resulting clusters */
+	struct meshopt_LODBounds bounds;
+};
+
+/**
+ * Experimental: Cluster hierarchy builder
+ * Splits the mesh into clusters and builds a DAG of progressively coarser clusters for continuous level of detail rendering.
+ * Each level partitions clusters into groups with meshopt_partitionClusters, simplifies each group with locked borders and splits the result into new clusters; groups that fail to simplify are retried at the next level.
+ * Bounds and errors are monotonic: parent error of every cluster is greater than or equal to its self error, which allows selecting a consistent cut through the DAG independently for each cluster.
+ * Returns the number of clusters; clusters are ordered by depth, and clusters with depth 0 cover the original mesh.
+ *
+ * clusters must contain enough space for all clusters, worst case size can be computed with meshopt_buildClusterHierarchyBound
+ * cluster_indices must contain enough space for all cluster indices, worst case size is equal to index_count * 20 / 3
+ * groups must contain enough space for max_clusters / 2 groups, group_clusters must contain enough space for max_clusters elements
+ * when there isn't enough space for the next level, construction stops early; the hierarchy remains valid but the coarsest level has more clusters
+ * vertex_positions should have float3 position in the first 12 bytes of each vertex
+ * max_vertices and max_triangles must not exceed implementation limits (max_vertices <= 255 - not 256!, max_triangles <= 512; max_triangles must be divisible by 4)
+ * scheduler can be NULL, in which case all work is performed on the calling thread; groups of each level are simplified in parallel, which allocates memory, so allocation callbacks must be thread-safe when scheduler is used
+ */
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildClusterHierarchy(struct meshopt_Cluster* clusters, unsigned int* cluster_indices, struct meshopt_ClusterGroup* groups, unsigned int* group_clusters, size_t* group_count, size_t max_clusters, size_t max_cluster_indices, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, size_t max_vertices, size_t max_triangles, meshopt_TaskScheduler scheduler, void* scheduler_context);
+MESHOPTIMIZER_EXPERIMENTAL size_t meshopt_buildClusterHierarchyBound(size_t index_count, size_t max_vertices, size_t max_triangles);
+
 /**
  * Spatial sorter
  * Generates a remap table that can be used to reorder points for spatial locality.
@@ -595,8 +1085,8 @@ MESHOPTIMIZER_EXPERIMENTAL void meshopt_spatialSortTriangles(unsigned int* desti
 /**
  * Set allocation callbacks
  * These callbacks will be used instead of the default operator new/operator delete for all temporary allocations in the library.
- * Note that all algorithms only allocate memory for temporary use.
- * allocate/deallocate are always called in a stack-like order - last pointer to be allocated is deallocated first.
+ * Note that all algorithms only allocate memory for temporary use; the only exceptions are meshopt_SimplifierContext and meshopt_VertexIndexer, which keep their memory until they are destroyed.
+ * allocate/deallocate are always called in a stack-like order - last pointer to be allocated is deallocated first - with the exception of memory owned by meshopt_SimplifierContext and meshopt_VertexIndexer.
  */
 MESHOPTIMIZER_API void meshopt_setAllocator(void* (MESHOPTIMIZER_ALLOC_CALLCONV *allocate)(size_t), void (MESHOPTIMIZER_ALLOC_CALLCONV *deallocate)(void*));
 
@@ -790,6 +1280,16 @@ template <typename T>
 void* (MESHOPTIMIZER_ALLOC_CALLCONV *meshopt_Allocator::StorageT<T>::allocate)(size_t) = operator new;
 template <typename T>
 void (MESHOPTIMIZER_ALLOC_CALLCONV *meshopt_Allocator::StorageT<T>::deallocate)(void*) = operator delete;
+
+// Runs all tasks through the scheduler when one is provided, and serially on the calling thread otherwise
+inline void meshopt_runTasks(meshopt_TaskScheduler scheduler, void* scheduler_context, void (*task)(void*, size_t), void* task_context, size_t count)
+{
+	if (scheduler)
+		scheduler(scheduler_context, task, task_context, count);
+	else
+		for (size_t i = 0; i < count; ++i)
+			task(task_context, i);
+}
 #endif
 
 /* Inline implementation for C++ templated wrappers */
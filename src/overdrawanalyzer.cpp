@@ -3,8 +3,28 @@
 
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <string.h>
 
+// The block below auto-detects SIMD ISA that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// The SIMD implementation requires SSE2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE2__)
+#define SIMD_SSE
+#endif
+
+// MSVC supports compiling SSE2 code regardless of compile options; we assume all 32-bit CPUs support SSE2
+#if !defined(SIMD_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define SIMD_SSE
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef SIMD_SSE
+#include <emmintrin.h>
+#endif
+
 // This work is based on:
 // Nicolas Capens. Advanced Rasterization. 2004
 namespace meshopt
@@ -12,10 +32,20 @@ namespace meshopt
 
 const int kViewport = 256;
 
+// fixed point edge equations overflow for larger viewports
+const size_t kViewportMax = 1024;
+
+// rows are padded so that 4-wide spans that start inside the viewport don't cross into the next row
+const int kViewportPadding = 4;
+
 struct OverdrawBuffer
 {
-	float z[kViewport][kViewport][2];
-	unsigned int overdraw[kViewport][kViewport][2];
+	// separate planes for front (0) and back (1) facing triangles, viewport rows of stride elements each
+	float* z[2];
+	unsigned int* overdraw[2];
+
+	int viewport;
+	int stride;
 };
 
 #ifndef min
@@ -42,8 +72,77 @@ static float computeDepthGradients(float& dzdx, float& dzdy, float x1, float y1,
 	return det;
 }
 
+#ifdef SIMD_SSE
+static void rasterizeRow(float* z, unsigned int* overdraw, int minx, int maxx, int CX1, int CX2, int CX3, int SX1, int SX2, int SX3, float ZX, float DZx)
+{
+	// edge values for 4 consecutive pixels; signed overflow is avoided by using unsigned math
+	__m128i cx1 = _mm_setr_epi32(CX1, int(unsigned(CX1) - unsigned(SX1)), int(unsigned(CX1) - unsigned(SX1) * 2), int(unsigned(CX1) - unsigned(SX1) * 3));
+	__m128i cx2 = _mm_setr_epi32(CX2, int(unsigned(CX2) - unsigned(SX2)), int(unsigned(CX2) - unsigned(SX2) * 2), int(unsigned(CX2) - unsigned(SX2) * 3));
+	__m128i cx3 = _mm_setr_epi32(CX3, int(unsigned(CX3) - unsigned(SX3)), int(unsigned(CX3) - unsigned(SX3) * 2), int(unsigned(CX3) - unsigned(SX3) * 3));
+
+	__m128i sx1 = _mm_set1_epi32(int(unsigned(SX1) * 4));
+	__m128i sx2 = _mm_set1_epi32(int(unsigned(SX2) * 4));
+	__m128i sx3 = _mm_set1_epi32(int(unsigned(SX3) * 4));
+
+	// number of pixels left in the row for each lane; lanes past the end of the row are masked out
+	__m128i left = _mm_sub_epi32(_mm_set1_epi32(maxx - minx), _mm_setr_epi32(0, 1, 2, 3));
+
+	for (int x = minx; x < maxx; x += 4)
+	{
+		__m128i inside = _mm_or_si128(_mm_or_si128(cx1, cx2), cx3);
+		__m128i mask = _mm_andnot_si128(_mm_srai_epi32(inside, 31), _mm_cmpgt_epi32(left, _mm_setzero_si128()));
+
+		// depth is accumulated serially to get the exact same values as the scalar rasterizer
+		float z0 = ZX;
+		float z1 = z0 + DZx;
+		float z2 = z1 + DZx;
+		float z3 = z2 + DZx;
+		ZX = z3 + DZx;
+
+		if (_mm_movemask_epi8(mask))
+		{
+			__m128 zv = _mm_setr_ps(z0, z1, z2, z3);
+			__m128 zb = _mm_loadu_ps(&z[x]);
+			__m128 pass = _mm_and_ps(_mm_cmpge_ps(zv, zb), _mm_castsi128_ps(mask));
+
+			_mm_storeu_ps(&z[x], _mm_or_ps(_mm_and_ps(pass, zv), _mm_andnot_ps(pass, zb)));
+
+			// passing lanes are all ones, so subtracting the mask increments the counters
+			__m128i ob = _mm_loadu_si128(reinterpret_cast<__m128i*>(&overdraw[x]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&overdraw[x]), _mm_sub_epi32(ob, _mm_castps_si128(pass)));
+		}
+
+		cx1 = _mm_sub_epi32(cx1, sx1);
+		cx2 = _mm_sub_epi32(cx2, sx2);
+		cx3 = _mm_sub_epi32(cx3, sx3);
+		left = _mm_sub_epi32(left, _mm_set1_epi32(4));
+	}
+}
+#else
+static void rasterizeRow(float* z, unsigned int* overdraw, int minx, int maxx, int CX1, int CX2, int CX3, int SX1, int SX2, int SX3, float ZX, float DZx)
+{
+	for (int x = minx; x < maxx; x++)
+	{
+		// check if all CXn are non-negative
+		if ((CX1 | CX2 | CX3) >= 0)
+		{
+			if (ZX >= z[x])
+			{
+				z[x] = ZX;
+				overdraw[x]++;
+			}
+		}
+
+		CX1 -= SX1;
+		CX2 -= SX2;
+		CX3 -= SX3;
+		ZX += DZx;
+	}
+}
+#endif
+
 // half-space fixed point triangle rasterizer
-static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, float v2x, float v2y, float v2z, float v3x, float v3y, float v3z)
+static void rasterize(const OverdrawBuffer& buffer, float v1x, float v1y, float v1z, float v2x, float v2y, float v2z, float v3x, float v3y, float v3z)
 {
 	// compute depth gradients
 	float DZx, DZy;
@@ -59,7 +158,7 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 		t = v2y, v2y = v3y, v3y = t;
 
 		// flip depth since we rasterize backfacing triangles to second buffer with reverse Z; only v1z is used below
-		v1z = kViewport - v1z;
+		v1z = float(buffer.viewport) - v1z;
 		DZx = -DZx;
 		DZy = -DZy;
 	}
@@ -78,9 +177,9 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 	// as for max, due to top-left filling convention we will never rasterize right/bottom edges
 	// so max >= 0.5 should round down
 	int minx = max((min(X1, min(X2, X3)) + 7) >> 4, 0);
-	int maxx = min((max(X1, max(X2, X3)) + 7) >> 4, kViewport);
+	int maxx = min((max(X1, max(X2, X3)) + 7) >> 4, buffer.viewport);
 	int miny = max((min(Y1, min(Y2, Y3)) + 7) >> 4, 0);
-	int maxy = min((max(Y1, max(Y2, Y3)) + 7) >> 4, kViewport);
+	int maxy = min((max(Y1, max(Y2, Y3)) + 7) >> 4, buffer.viewport);
 
 	// deltas, 28.4 fixed point
 	int DX12 = X1 - X2;
@@ -105,31 +204,16 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 	int CY3 = DX31 * (FY - Y3) - DY31 * (FX - X3) + TL3 - 1;
 	float ZY = v1z + (DZx * float(FX - X1) + DZy * float(FY - Y1)) * (1 / 16.f);
 
+	// signed left shift is UB for negative numbers so use unsigned-signed casts
+	int SX1 = int(unsigned(DY12) << 4);
+	int SX2 = int(unsigned(DY23) << 4);
+	int SX3 = int(unsigned(DY31) << 4);
+
 	for (int y = miny; y < maxy; y++)
 	{
-		int CX1 = CY1;
-		int CX2 = CY2;
-		int CX3 = CY3;
-		float ZX = ZY;
-
-		for (int x = minx; x < maxx; x++)
-		{
-			// check if all CXn are non-negative
-			if ((CX1 | CX2 | CX3) >= 0)
-			{
-				if (ZX >= buffer->z[y][x][sign])
-				{
-					buffer->z[y][x][sign] = ZX;
-					buffer->overdraw[y][x][sign]++;
-				}
-			}
+		size_t row = size_t(y) * buffer.stride;
 
-			// signed left shift is UB for negative numbers so use unsigned-signed casts
-			CX1 -= int(unsigned(DY12) << 4);
-			CX2 -= int(unsigned(DY23) << 4);
-			CX3 -= int(unsigned(DY31) << 4);
-			ZX += DZx;
-		}
+		rasterizeRow(buffer.z[sign] + row, buffer.overdraw[sign] + row, minx, maxx, CY1, CY2, CY3, SX1, SX2, SX3, ZY, DZx);
 
 		// signed left shift is UB for negative numbers so use unsigned-signed casts
 		CY1 += int(unsigned(DX12) << 4);
@@ -139,91 +223,193 @@ static void rasterize(OverdrawBuffer* buffer, float v1x, float v1y, float v1z, f
 	}
 }
 
-} // namespace meshopt
+static void computeViewBasis(float basis[9], const float* direction)
+{
+	float length = sqrtf(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+	assert(length > 0);
 
-meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+	float d[3] = {direction[0] / length, direction[1] / length, direction[2] / length};
+
+	// screen axes are derived from the dominant axis so that views along +X/+Y/+Z match the projections of meshopt_analyzeOverdraw exactly
+	int k = (fabsf(d[0]) >= fabsf(d[1]) && fabsf(d[0]) >= fabsf(d[2])) ? 0 : (fabsf(d[1]) >= fabsf(d[2])) ? 1 : 2;
+	int a = (k + 2) % 3;
+
+	float u[3] = {-d[a] * d[0], -d[a] * d[1], -d[a] * d[2]};
+	u[a] += 1;
+
+	float ul = sqrtf(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+	u[0] /= ul, u[1] /= ul, u[2] /= ul;
+
+	// screen x, screen y, depth
+	basis[0] = u[0], basis[1] = u[1], basis[2] = u[2];
+	basis[3] = u[1] * d[2] - u[2] * d[1];
+	basis[4] = u[2] * d[0] - u[0] * d[2];
+	basis[5] = u[0] * d[1] - u[1] * d[0];
+	basis[6] = d[0], basis[7] = d[1], basis[8] = d[2];
+}
+
+struct OverdrawViews
 {
-	using namespace meshopt;
+	const unsigned int* indices;
+	size_t index_count;
 
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
+	const float* vertex_positions;
+	size_t vertex_count;
+	size_t vertex_stride_float;
 
-	meshopt_Allocator allocator;
+	const float* view_directions;
 
-	size_t vertex_stride_float = vertex_positions_stride / sizeof(float);
+	int viewport;
+	int stride;
 
-	meshopt_OverdrawStatistics result = {};
+	// when tasks run serially, all views share the same buffers
+	float* z;
+	unsigned int* overdraw;
+	float* positions;
+	size_t buffer_count;
+
+	unsigned int* pixels_covered;
+	unsigned int* pixels_shaded;
+};
+
+static void analyzeOverdrawViewTask(void* context, size_t index)
+{
+	const OverdrawViews& views = *static_cast<const OverdrawViews*>(context);
+
+	float basis[9];
+	computeViewBasis(basis, &views.view_directions[index * 3]);
+
+	size_t buffer_index = index % views.buffer_count;
+
+	// vertices are transformed to view space once; triangles are scaled to the viewport when rasterizing
+	float* positions = views.positions + buffer_index * views.vertex_count * 3;
 
 	float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
 	float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
 
-	for (size_t i = 0; i < vertex_count; ++i)
+	for (size_t i = 0; i < views.vertex_count; ++i)
 	{
-		const float* v = vertex_positions + i * vertex_stride_float;
+		const float* v = views.vertex_positions + i * views.vertex_stride_float;
 
 		for (int j = 0; j < 3; ++j)
 		{
-			minv[j] = min(minv[j], v[j]);
-			maxv[j] = max(maxv[j], v[j]);
+			float p = v[0] * basis[j * 3 + 0] + v[1] * basis[j * 3 + 1] + v[2] * basis[j * 3 + 2];
+
+			positions[i * 3 + j] = p;
+			minv[j] = min(minv[j], p);
+			maxv[j] = max(maxv[j], p);
 		}
 	}
 
 	float extent = max(maxv[0] - minv[0], max(maxv[1] - minv[1], maxv[2] - minv[2]));
-	float scale = kViewport / extent;
-
-	float* triangles = allocator.allocate<float>(index_count * 3);
+	float scale = float(views.viewport) / extent;
 
-	for (size_t i = 0; i < index_count; ++i)
-	{
-		unsigned int index = indices[i];
-		assert(index < vertex_count);
-
-		const float* v = vertex_positions + index * vertex_stride_float;
+	size_t plane_size = size_t(views.viewport) * views.stride;
 
-		triangles[i * 3 + 0] = (v[0] - minv[0]) * scale;
-		triangles[i * 3 + 1] = (v[1] - minv[1]) * scale;
-		triangles[i * 3 + 2] = (v[2] - minv[2]) * scale;
-	}
+	OverdrawBuffer buffer;
+	buffer.z[0] = views.z + buffer_index * plane_size * 2;
+	buffer.z[1] = buffer.z[0] + plane_size;
+	buffer.overdraw[0] = views.overdraw + buffer_index * plane_size * 2;
+	buffer.overdraw[1] = buffer.overdraw[0] + plane_size;
+	buffer.viewport = views.viewport;
+	buffer.stride = views.stride;
 
-	OverdrawBuffer* buffer = allocator.allocate<OverdrawBuffer>(1);
+	memset(buffer.z[0], 0, plane_size * 2 * sizeof(float));
+	memset(buffer.overdraw[0], 0, plane_size * 2 * sizeof(unsigned int));
 
-	for (int axis = 0; axis < 3; ++axis)
+	for (size_t i = 0; i < views.index_count; i += 3)
 	{
-		memset(buffer, 0, sizeof(OverdrawBuffer));
+		float tri[3][3];
 
-		for (size_t i = 0; i < index_count; i += 3)
+		for (int k = 0; k < 3; ++k)
 		{
-			const float* vn0 = &triangles[3 * (i + 0)];
-			const float* vn1 = &triangles[3 * (i + 1)];
-			const float* vn2 = &triangles[3 * (i + 2)];
+			unsigned int vi = views.indices[i + k];
+			assert(vi < views.vertex_count);
+
+			for (int j = 0; j < 3; ++j)
+				tri[k][j] = (positions[vi * 3 + j] - minv[j]) * scale;
+		}
+
+		rasterize(buffer, tri[0][0], tri[0][1], tri[0][2], tri[1][0], tri[1][1], tri[1][2], tri[2][0], tri[2][1], tri[2][2]);
+	}
 
-			switch (axis)
+	unsigned int pixels_covered = 0;
+	unsigned int pixels_shaded = 0;
+
+	for (int s = 0; s < 2; ++s)
+		for (int y = 0; y < views.viewport; ++y)
+			for (int x = 0; x < views.viewport; ++x)
 			{
-			case 0:
-				rasterize(buffer, vn0[2], vn0[1], vn0[0], vn1[2], vn1[1], vn1[0], vn2[2], vn2[1], vn2[0]);
-				break;
-			case 1:
-				rasterize(buffer, vn0[0], vn0[2], vn0[1], vn1[0], vn1[2], vn1[1], vn2[0], vn2[2], vn2[1]);
-				break;
-			case 2:
-				rasterize(buffer, vn0[1], vn0[0], vn0[2], vn1[1], vn1[0], vn1[2], vn2[1], vn2[0], vn2[2]);
-				break;
+				unsigned int overdraw = buffer.overdraw[s][size_t(y) * views.stride + x];
+
+				pixels_covered += overdraw > 0;
+				pixels_shaded += overdraw;
 			}
-		}
 
-		for (int y = 0; y < kViewport; ++y)
-			for (int x = 0; x < kViewport; ++x)
-				for (int s = 0; s < 2; ++s)
-				{
-					unsigned int overdraw = buffer->overdraw[y][x][s];
+	views.pixels_covered[index] = pixels_covered;
+	views.pixels_shaded[index] = pixels_shaded;
+}
+
+} // namespace meshopt
+
+meshopt_OverdrawStatistics meshopt_analyzeOverdraw(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
+{
+	using namespace meshopt;
+
+	static const float kAxisViews[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+	return meshopt_analyzeOverdrawViews(indices, index_count, vertex_positions, vertex_count, vertex_positions_stride, kAxisViews, 3, kViewport, NULL, NULL);
+}
+
+meshopt_OverdrawStatistics meshopt_analyzeOverdrawViews(const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, const float* view_directions, size_t view_count, size_t viewport_size, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(viewport_size >= 1 && viewport_size <= kViewportMax);
+
+	meshopt_Allocator allocator;
+
+	meshopt_OverdrawStatistics result = {};
+
+	if (view_count == 0)
+		return result;
+
+	OverdrawViews views = {};
+	views.indices = indices;
+	views.index_count = index_count;
+	views.vertex_positions = vertex_positions;
+	views.vertex_count = vertex_count;
+	views.vertex_stride_float = vertex_positions_stride / sizeof(float);
+	views.view_directions = view_directions;
+	views.viewport = int(viewport_size);
+	views.stride = int(viewport_size) + kViewportPadding;
 
-					result.pixels_covered += overdraw > 0;
-					result.pixels_shaded += overdraw;
-				}
+	// tasks don't allocate memory, so each view needs its own buffer when tasks may run concurrently
+	views.buffer_count = scheduler ? view_count : 1;
+
+	size_t plane_size = viewport_size * views.stride;
+
+	// depth and counter planes share one allocation, which keeps allocators from returning the memory to the OS between calls
+	views.z = allocator.allocate<float>(plane_size * 4 * views.buffer_count);
+	views.overdraw = reinterpret_cast<unsigned int*>(views.z + plane_size * 2 * views.buffer_count);
+	views.positions = allocator.allocate<float>(vertex_count * 3 * views.buffer_count);
+	views.pixels_covered = allocator.allocate<unsigned int>(view_count);
+	views.pixels_shaded = allocator.allocate<unsigned int>(view_count);
+
+	meshopt_runTasks(scheduler, scheduler_context, analyzeOverdrawViewTask, &views, view_count);
+
+	for (size_t i = 0; i < view_count; ++i)
+	{
+		result.pixels_covered += views.pixels_covered[i];
+		result.pixels_shaded += views.pixels_shaded[i];
 	}
 
 	result.overdraw = result.pixels_covered ? float(result.pixels_shaded) / float(result.pixels_covered) : 0.f;
 
 	return result;
 }
+
+#undef SIMD_SSE
@@ -0,0 +1,679 @@
+// This file is part of meshoptimizer library; see meshoptimizer.h for version/license details
+#include "meshoptimizer.h"
+
+#include <assert.h>
+#include <string.h>
+
+// This work is based on:
+// George Karypis, Vipin Kumar. A Fast and High Quality Multilevel Scheme for Partitioning Irregular Graphs. 1998
+// Charles Fiduccia, Robert Mattheyses. A Linear-Time Heuristic for Improving Network Partitions. 1982
+namespace meshopt
+{
+
+const size_t kPartitionMaxLevels = 12;
+const size_t kPartitionMatchRounds = 4;
+const size_t kPartitionRefinePasses = 4;
+const size_t kPartitionTaskNodes = 4096;
+
+// FM passes stop after this many consecutive moves that don't improve the best cut
+const size_t kPartitionRefineStall = 64;
+
+// gains are kept in buckets for [-kPartitionGainRange, kPartitionGainRange); larger gains share the extreme buckets
+const int kPartitionGainRange = 256;
+
+// special bucket values for nodes that aren't in the gain buckets
+const unsigned int kPartitionNodeIdle = ~0u;
+const unsigned int kPartitionNodeLocked = ~0u - 1;
+struct PartitionGraph
+{
+	size_t node_count;
+
+	// number of clusters represented by each node
+	unsigned int* sizes;
+
+	// neighbors of each node are stored in offsets[i]..offsets[i]+counts[i] range of adjacency/weights
+	unsigned int* offsets;
+	unsigned int* counts;
+	unsigned int* adjacency;
+	unsigned int* weights;
+
+	// node id at the next (coarser) level
+	unsigned int* coarse;
+};
+
+struct PartitionMatching
+{
+	const PartitionGraph* graph;
+	size_t max_size;
+
+	unsigned int* choice;
+	unsigned int* match;
+};
+
+struct PartitionRefiner
+{
+	unsigned int* part;
+	unsigned int* part_sizes;
+
+	// connectivity of the current node to each partition; touched lists partitions with non-zero entries
+	unsigned int* part_weights;
+	unsigned int* touched;
+
+	size_t target_size;
+	size_t min_size;
+	size_t max_size;
+
+	// gain buckets are doubly linked lists of nodes; bucket stores the current bucket of each node
+	unsigned int* heads;
+	unsigned int* next;
+	unsigned int* prev;
+	unsigned int* bucket;
+	int top;
+
+	// target partition of each queued node; after a node is moved, this stores its original partition for rollback
+	unsigned int* target;
+	unsigned int* moves;
+};
+
+struct PartitionContraction
+{
+	const PartitionGraph* fine;
+	PartitionGraph* coarse;
+
+	const unsigned int* members;
+	const unsigned int* match;
+};
+
+static void allocateGraph(PartitionGraph& graph, size_t node_count, size_t adjacency_size, meshopt_Allocator& allocator)
+{
+	// each level takes a single allocation to keep the number of allocator blocks bounded
+	unsigned int* data = allocator.allocate<unsigned int>(node_count * 4 + adjacency_size * 2);
+
+	graph.node_count = node_count;
+	graph.sizes = data;
+	graph.offsets = data + node_count;
+	graph.counts = data + node_count * 2;
+	graph.coarse = data + node_count * 3;
+	graph.adjacency = data + node_count * 4;
+	graph.weights = data + node_count * 4 + adjacency_size;
+}
+
+static void buildClusterGraph(PartitionGraph& graph, const unsigned int* cluster_indices, const unsigned int* cluster_index_counts, size_t cluster_count, size_t vertex_count, unsigned int* cluster_weights, unsigned int* cluster_touched, meshopt_Allocator& allocator)
+{
+	unsigned int* vertex_data = allocator.allocate<unsigned int>(vertex_count * 3 + 1);
+	unsigned int* vertex_offsets = vertex_data;
+	unsigned int* vertex_marker = vertex_data + vertex_count + 1;
+	unsigned int* vertex_fill = vertex_data + vertex_count * 2 + 1;
+
+	memset(vertex_offsets, 0, (vertex_count + 1) * sizeof(unsigned int));
+	memset(vertex_marker, -1, vertex_count * sizeof(unsigned int));
+
+	// count the number of clusters that reference each vertex
+	for (size_t i = 0, offset = 0; i < cluster_count; offset += cluster_index_counts[i++])
+		for (size_t j = 0; j < cluster_index_counts[i]; ++j)
+		{
+			unsigned int v = cluster_indices[offset + j];
+			assert(v < vertex_count);
+
+			if (vertex_marker[v] != i)
+			{
+				vertex_marker[v] = unsigned(i);
+				vertex_offsets[v + 1]++;
+			}
+		}
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		vertex_offsets[i + 1] += vertex_offsets[i];
+
+	// fill vertex -> cluster references; since clusters are processed in order, cluster lists are sorted
+	unsigned int* vertex_clusters = allocator.allocate<unsigned int>(vertex_offsets[vertex_count]);
+
+	memcpy(vertex_fill, vertex_offsets, vertex_count * sizeof(unsigned int));
+	memset(vertex_marker, -1, vertex_count * sizeof(unsigned int));
+
+	for (size_t i = 0, offset = 0; i < cluster_count; offset += cluster_index_counts[i++])
+		for (size_t j = 0; j < cluster_index_counts[i]; ++j)
+		{
+			unsigned int v = cluster_indices[offset + j];
+
+			if (vertex_marker[v] != i)
+			{
+				vertex_marker[v] = unsigned(i);
+				vertex_clusters[vertex_fill[v]++] = unsigned(i);
+			}
+		}
+
+	// edge weights are the number of shared vertices, which is proportional to the length of the shared boundary
+	// we need two passes since we don't know the number of unique neighbors in advance; cluster_weights must be zero-initialized and is left zeroed
+	size_t adjacency_size = 0;
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		memset(vertex_marker, -1, vertex_count * sizeof(unsigned int));
+
+		if (pass == 1)
+			allocateGraph(graph, cluster_count, adjacency_size, allocator);
+
+		size_t fill = 0;
+
+		for (size_t i = 0, offset = 0; i < cluster_count; offset += cluster_index_counts[i++])
+		{
+			size_t touched = 0;
+
+			for (size_t j = 0; j < cluster_index_counts[i]; ++j)
+			{
+				unsigned int v = cluster_indices[offset + j];
+
+				if (vertex_marker[v] == i)
+					continue;
+
+				vertex_marker[v] = unsigned(i);
+
+				for (unsigned int k = vertex_offsets[v]; k < vertex_offsets[v + 1]; ++k)
+				{
+					unsigned int c = vertex_clusters[k];
+
+					if (c != i && cluster_weights[c]++ == 0)
+						cluster_touched[touched++] = c;
+				}
+			}
+
+			if (pass == 1)
+			{
+				graph.sizes[i] = 1;
+				graph.offsets[i] = unsigned(fill);
+				graph.counts[i] = unsigned(touched);
+
+				for (size_t j = 0; j < touched; ++j)
+				{
+					graph.adjacency[fill + j] = cluster_touched[j];
+					graph.weights[fill + j] = cluster_weights[cluster_touched[j]];
+				}
+			}
+
+			for (size_t j = 0; j < touched; ++j)
+				cluster_weights[cluster_touched[j]] = 0;
+
+			fill += touched;
+		}
+
+		adjacency_size = fill;
+	}
+}
+
+static unsigned int hashEdge(unsigned int a, unsigned int b)
+{
+	unsigned int h = (a < b ? a : b) * 0x9e3779b1 ^ (a < b ? b : a);
+
+	// MurmurHash3 finalizer
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+
+	return h;
+}
+
+static void chooseMatchTask(void* context, size_t index)
+{
+	const PartitionMatching& matching = *static_cast<const PartitionMatching*>(context);
+	const PartitionGraph& graph = *matching.graph;
+
+	size_t begin = index * kPartitionTaskNodes;
+	size_t end = begin + kPartitionTaskNodes < graph.node_count ? begin + kPartitionTaskNodes : graph.node_count;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		unsigned int best = ~0u;
+		float best_score = 0.f;
+		unsigned int best_hash = 0;
+
+		if (matching.match[i] == ~0u)
+		{
+			for (unsigned int j = graph.offsets[i]; j < graph.offsets[i] + graph.counts[i]; ++j)
+			{
+				unsigned int n = graph.adjacency[j];
+				unsigned int size = graph.sizes[i] + graph.sizes[n];
+
+				if (matching.match[n] != ~0u || size > matching.max_size)
+					continue;
+
+				// heavy edge matching; normalizing by the combined size prefers merging small nodes, which keeps the nodes balanced
+				float score = float(graph.weights[j]) / float(size);
+
+				// ties are broken with a symmetric edge hash; on regular meshes, many edges have the same score and breaking ties by id results in few mutual choices
+				unsigned int hash = hashEdge(unsigned(i), n);
+
+				if (score > best_score || (score == best_score && (hash > best_hash || (hash == best_hash && n < best))))
+				{
+					best = n;
+					best_score = score;
+					best_hash = hash;
+				}
+			}
+		}
+
+		matching.choice[i] = best;
+	}
+}
+
+static void resolveMatchTask(void* context, size_t index)
+{
+	const PartitionMatching& matching = *static_cast<const PartitionMatching*>(context);
+	const PartitionGraph& graph = *matching.graph;
+
+	size_t begin = index * kPartitionTaskNodes;
+	size_t end = begin + kPartitionTaskNodes < graph.node_count ? begin + kPartitionTaskNodes : graph.node_count;
+
+	// nodes are matched when their choices are mutual; this only writes to the node itself so nodes can be processed in parallel
+	for (size_t i = begin; i < end; ++i)
+	{
+		unsigned int c = matching.choice[i];
+
+		if (matching.match[i] == ~0u && c != ~0u && matching.choice[c] == i)
+			matching.match[i] = c;
+	}
+}
+
+static void contractGraphTask(void* context, size_t index)
+{
+	const PartitionContraction& contraction = *static_cast<const PartitionContraction*>(context);
+	const PartitionGraph& fine = *contraction.fine;
+	PartitionGraph& coarse = *contraction.coarse;
+
+	size_t begin = index * kPartitionTaskNodes;
+	size_t end = begin + kPartitionTaskNodes < coarse.node_count ? begin + kPartitionTaskNodes : coarse.node_count;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		unsigned int members[2] = {contraction.members[i], contraction.match[contraction.members[i]]};
+
+		unsigned int* adjacency = coarse.adjacency + coarse.offsets[i];
+		unsigned int* weights = coarse.weights + coarse.offsets[i];
+		size_t count = 0;
+
+		for (int m = 0; m < 2 && members[m] != ~0u; ++m)
+		{
+			unsigned int node = members[m];
+
+			for (unsigned int j = fine.offsets[node]; j < fine.offsets[node] + fine.counts[node]; ++j)
+			{
+				unsigned int n = fine.coarse[fine.adjacency[j]];
+				unsigned int w = fine.weights[j];
+
+				if (n == i)
+					continue;
+
+				// insertion sort keeps the list sorted by id; lists are short since node sizes are bounded by the partition size
+				size_t k = count;
+				while (k > 0 && adjacency[k - 1] > n)
+					k--;
+
+				if (k > 0 && adjacency[k - 1] == n)
+				{
+					weights[k - 1] += w;
+					continue;
+				}
+
+				for (size_t l = count; l > k; --l)
+				{
+					adjacency[l] = adjacency[l - 1];
+					weights[l] = weights[l - 1];
+				}
+
+				adjacency[k] = n;
+				weights[k] = w;
+				count++;
+			}
+		}
+
+		coarse.counts[i] = unsigned(count);
+	}
+}
+
+static size_t coarsenGraph(PartitionGraph& coarse, PartitionGraph& fine, size_t max_size, unsigned int* choice, unsigned int* match, unsigned int* members, meshopt_Allocator& allocator, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	size_t task_count = (fine.node_count + kPartitionTaskNodes - 1) / kPartitionTaskNodes;
+
+	memset(match, -1, fine.node_count * sizeof(unsigned int));
+
+	PartitionMatching matching = {&fine, max_size, choice, match};
+
+	// every round matches some of the remaining nodes; since choices are made independently, the results don't depend on task order
+	for (size_t round = 0; round < kPartitionMatchRounds; ++round)
+	{
+		meshopt_runTasks(scheduler, scheduler_context, chooseMatchTask, &matching, task_count);
+		meshopt_runTasks(scheduler, scheduler_context, resolveMatchTask, &matching, task_count);
+	}
+
+	size_t coarse_count = 0;
+
+	for (size_t i = 0; i < fine.node_count; ++i)
+		if (match[i] == ~0u || i < match[i])
+		{
+			members[coarse_count] = unsigned(i);
+			fine.coarse[i] = unsigned(coarse_count++);
+		}
+		else
+			fine.coarse[i] = fine.coarse[match[i]];
+
+	// stop coarsening once matching stops making progress
+	if ((fine.node_count - coarse_count) * 20 < fine.node_count)
+		return 0;
+
+	size_t adjacency_size = 0;
+	for (size_t i = 0; i < fine.node_count; ++i)
+		adjacency_size += fine.counts[i];
+
+	allocateGraph(coarse, coarse_count, adjacency_size, allocator);
+
+	// each coarse node needs enough space for the adjacency of both fine nodes; duplicate edges are merged during contraction
+	for (size_t i = 0, offset = 0; i < coarse_count; ++i)
+	{
+		unsigned int a = members[i], b = match[a];
+
+		coarse.sizes[i] = fine.sizes[a] + (b == ~0u ? 0 : fine.sizes[b]);
+		coarse.offsets[i] = unsigned(offset);
+
+		offset += fine.counts[a] + (b == ~0u ? 0 : fine.counts[b]);
+	}
+
+	PartitionContraction contraction = {&fine, &coarse, members, match};
+
+	meshopt_runTasks(scheduler, scheduler_context, contractGraphTask, &contraction, (coarse_count + kPartitionTaskNodes - 1) / kPartitionTaskNodes);
+
+	return coarse_count;
+}
+
+static bool computePartitionMove(const PartitionGraph& graph, PartitionRefiner& r, unsigned int i, unsigned int& target, int& gain)
+{
+	unsigned int own = r.part[i];
+	unsigned int size = graph.sizes[i];
+	size_t touched_count = 0;
+
+	for (unsigned int j = graph.offsets[i]; j < graph.offsets[i] + graph.counts[i]; ++j)
+	{
+		unsigned int p = r.part[graph.adjacency[j]];
+
+		if (r.part_weights[p] == 0)
+			r.touched[touched_count++] = p;
+
+		r.part_weights[p] += graph.weights[j];
+	}
+
+	// undersized partitions may be dissolved into neighbors that have some slack; otherwise moves must keep both partitions balanced
+	bool alone = r.part_sizes[own] == size && size < r.min_size;
+	bool movable = r.part_sizes[own] - size >= r.min_size;
+
+	unsigned int best = ~0u;
+	unsigned int best_weight = 0;
+
+	for (size_t j = 0; j < touched_count; ++j)
+	{
+		unsigned int p = r.touched[j];
+		unsigned int limit = unsigned(alone ? r.max_size : r.target_size);
+
+		if (p == own || r.part_sizes[p] + size > limit || (!alone && !movable))
+			continue;
+
+		if (best == ~0u || r.part_weights[p] > best_weight || (r.part_weights[p] == best_weight && p < best))
+		{
+			best = p;
+			best_weight = r.part_weights[p];
+		}
+	}
+
+	unsigned int own_weight = r.part_weights[own];
+
+	for (size_t j = 0; j < touched_count; ++j)
+		r.part_weights[r.touched[j]] = 0;
+
+	target = best;
+	gain = int(best_weight) - int(own_weight);
+
+	return best != ~0u;
+}
+
+static unsigned int getGainBucket(int gain)
+{
+	gain = gain < -kPartitionGainRange ? -kPartitionGainRange : gain;
+	gain = gain > kPartitionGainRange - 1 ? kPartitionGainRange - 1 : gain;
+
+	return unsigned(gain + kPartitionGainRange);
+}
+
+static void insertGainBucket(PartitionRefiner& r, unsigned int i, int gain)
+{
+	unsigned int b = getGainBucket(gain);
+
+	r.next[i] = r.heads[b];
+	r.prev[i] = ~0u;
+
+	if (r.heads[b] != ~0u)
+		r.prev[r.heads[b]] = i;
+
+	r.heads[b] = i;
+	r.bucket[i] = b;
+	r.top = int(b) > r.top ? int(b) : r.top;
+}
+
+static void removeGainBucket(PartitionRefiner& r, unsigned int i)
+{
+	unsigned int b = r.bucket[i];
+	assert(b < unsigned(kPartitionGainRange * 2));
+
+	if (r.prev[i] != ~0u)
+		r.next[r.prev[i]] = r.next[i];
+	else
+		r.heads[b] = r.next[i];
+
+	if (r.next[i] != ~0u)
+		r.prev[r.next[i]] = r.prev[i];
+
+	r.bucket[i] = kPartitionNodeIdle;
+}
+
+static void updatePartitionMove(const PartitionGraph& graph, PartitionRefiner& r, unsigned int i)
+{
+	if (r.bucket[i] == kPartitionNodeLocked)
+		return;
+
+	if (r.bucket[i] != kPartitionNodeIdle)
+		removeGainBucket(r, i);
+
+	unsigned int target;
+	int gain;
+
+	if (computePartitionMove(graph, r, i, target, gain))
+	{
+		r.target[i] = target;
+		insertGainBucket(r, i, gain);
+	}
+}
+
+// Fiduccia-Mattheyses pass: moves the node with the highest gain (which may be negative) and locks it, then rolls back to the best cut seen
+static bool refinePartitionPass(const PartitionGraph& graph, PartitionRefiner& r)
+{
+	for (int b = 0; b < kPartitionGainRange * 2; ++b)
+		r.heads[b] = ~0u;
+
+	r.top = -1;
+
+	for (size_t i = 0; i < graph.node_count; ++i)
+	{
+		r.bucket[i] = kPartitionNodeIdle;
+		updatePartitionMove(graph, r, unsigned(i));
+	}
+
+	size_t move_count = 0;
+	size_t best_moves = 0;
+	long long total_gain = 0;
+	long long best_gain = 0;
+
+	for (;;)
+	{
+		while (r.top >= 0 && r.heads[r.top] == ~0u)
+			r.top--;
+
+		if (r.top < 0)
+			break;
+
+		unsigned int i = r.heads[r.top];
+		removeGainBucket(r, i);
+
+		// gains of queued nodes are refreshed when their neighbors move, but moves elsewhere may change partition sizes and invalidate the move
+		unsigned int target;
+		int gain;
+
+		if (!computePartitionMove(graph, r, i, target, gain))
+			continue;
+
+		if (getGainBucket(gain) != unsigned(r.top))
+		{
+			r.target[i] = target;
+			insertGainBucket(r, i, gain);
+			continue;
+		}
+
+		unsigned int own = r.part[i];
+
+		r.part[i] = target;
+		r.part_sizes[own] -= graph.sizes[i];
+		r.part_sizes[target] += graph.sizes[i];
+
+		r.bucket[i] = kPartitionNodeLocked;
+		r.target[i] = own;
+		r.moves[move_count++] = i;
+
+		total_gain += gain;
+
+		if (total_gain > best_gain)
+		{
+			best_gain = total_gain;
+			best_moves = move_count;
+		}
+		else if (move_count - best_moves >= kPartitionRefineStall)
+			break;
+
+		for (unsigned int j = graph.offsets[i]; j < graph.offsets[i] + graph.counts[i]; ++j)
+			updatePartitionMove(graph, r, graph.adjacency[j]);
+	}
+
+	// undo the moves made after the best cut
+	for (size_t k = move_count; k > best_moves; --k)
+	{
+		unsigned int i = r.moves[k - 1];
+		unsigned int own = r.target[i];
+
+		r.part_sizes[r.part[i]] -= graph.sizes[i];
+		r.part_sizes[own] += graph.sizes[i];
+		r.part[i] = own;
+	}
+
+	return best_moves > 0;
+}
+
+static void refinePartition(const PartitionGraph& graph, PartitionRefiner& r)
+{
+	for (size_t pass = 0; pass < kPartitionRefinePasses; ++pass)
+		if (!refinePartitionPass(graph, r))
+			break;
+}
+
+} // namespace meshopt
+
+size_t meshopt_partitionClusters(unsigned int* destination, const unsigned int* cluster_indices, size_t total_index_count, const unsigned int* cluster_index_counts, size_t cluster_count, size_t vertex_count, size_t target_partition_size, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(target_partition_size > 0);
+
+	size_t index_sum = 0;
+	for (size_t i = 0; i < cluster_count; ++i)
+		index_sum += cluster_index_counts[i];
+
+	assert(index_sum == total_index_count);
+	(void)index_sum;
+	(void)total_index_count;
+
+	if (cluster_count == 0)
+		return 0;
+
+	meshopt_Allocator allocator;
+
+	unsigned int* scratch = allocator.allocate<unsigned int>(cluster_count * 12 + kPartitionGainRange * 2);
+	unsigned int* choice = scratch;
+	unsigned int* match = scratch + cluster_count;
+	unsigned int* members = scratch + cluster_count * 2;
+	unsigned int* part = scratch + cluster_count * 3;
+	unsigned int* part_sizes = scratch + cluster_count * 4;
+	unsigned int* part_weights = scratch + cluster_count * 5;
+	unsigned int* touched = scratch + cluster_count * 6;
+
+	memset(part_weights, 0, cluster_count * sizeof(unsigned int));
+
+	PartitionGraph levels[kPartitionMaxLevels];
+	buildClusterGraph(levels[0], cluster_indices, cluster_index_counts, cluster_count, vertex_count, part_weights, touched, allocator);
+
+	// coarsening: contract pairs of strongly connected nodes until nodes reach the target size
+	size_t level_count = 1;
+
+	while (level_count < kPartitionMaxLevels && coarsenGraph(levels[level_count], levels[level_count - 1], target_partition_size, choice, match, members, allocator, scheduler, scheduler_context))
+		level_count++;
+
+	// initial partition: every node at the coarsest level is a separate partition
+	const PartitionGraph& coarsest = levels[level_count - 1];
+
+	for (size_t i = 0; i < coarsest.node_count; ++i)
+	{
+		part[i] = unsigned(i);
+		part_sizes[i] = coarsest.sizes[i];
+	}
+
+	PartitionRefiner refiner = {};
+	refiner.part = part;
+	refiner.part_sizes = part_sizes;
+	refiner.part_weights = part_weights;
+	refiner.touched = touched;
+	refiner.target_size = target_partition_size;
+	refiner.min_size = target_partition_size - target_partition_size / 4;
+	refiner.max_size = target_partition_size + target_partition_size / 2;
+	refiner.next = scratch + cluster_count * 7;
+	refiner.prev = scratch + cluster_count * 8;
+	refiner.bucket = scratch + cluster_count * 9;
+	refiner.target = scratch + cluster_count * 10;
+	refiner.moves = scratch + cluster_count * 11;
+	refiner.heads = scratch + cluster_count * 12;
+
+	// uncoarsening: project the partition to finer levels and refine it at each level
+	for (size_t level = level_count; level > 0; --level)
+	{
+		const PartitionGraph& graph = levels[level - 1];
+
+		if (level < level_count)
+		{
+			// coarse node ids are assigned in order of their first member, so projection can be done in place in reverse order
+			for (size_t i = graph.node_count; i > 0; --i)
+				part[i - 1] = part[graph.coarse[i - 1]];
+		}
+
+		refinePartition(graph, refiner);
+	}
+
+	// renumber partitions in order of first appearance
+	unsigned int* remap = part_weights;
+	memset(remap, -1, cluster_count * sizeof(unsigned int));
+
+	size_t partition_count = 0;
+
+	for (size_t i = 0; i < cluster_count; ++i)
+	{
+		if (remap[part[i]] == ~0u)
+			remap[part[i]] = unsigned(partition_count++);
+
+		destination[i] = remap[part[i]];
+	}
+
+	return partition_count;
+}
@@ -5,6 +5,7 @@
 #include <float.h>
 #include <math.h>
 #include <string.h>
+#include <time.h>
 
 #ifndef TRACE
 #define TRACE 0
@@ -27,9 +28,130 @@
 // Matthias Teschner, Bruno Heidelberger, Matthias Mueller, Danat Pomeranets, Markus Gross. Optimized Spatial Hashing for Collision Detection of Deformable Objects. 2003
 // Peter Van Sandt, Yannis Chronis, Jignesh M. Patel. Efficiently Searching In-Memory Sorted Arrays: Revenge of the Interpolation Search? 2019
 // Hugues Hoppe. New Quadric Metric for Simplifying Meshes with Appearance Attributes. 1999
+struct meshopt_SimplifierContext
+{
+	char* scratch;
+	size_t scratch_size;
+
+	meshopt_SimplifyStats stats;
+
+	int (*callback)(void* callback_data, size_t index_count, float error);
+	void* callback_data;
+};
+
 namespace meshopt
 {
 
+// Stack allocator that uses meshopt_SimplifierContext scratch memory when available, and meshopt_Allocator otherwise
+class ScratchAllocator
+{
+public:
+	static const size_t kAlignment = 16;
+	static const size_t kMaxBlocks = 24;
+
+	// worst case alignment padding for all allocations
+	static const size_t kPadding = kAlignment * kMaxBlocks;
+
+	ScratchAllocator(meshopt_SimplifierContext* context_)
+	    : context(context_)
+	    , offsets()
+	    , fallback()
+	    , count(0)
+	    , top(0)
+	{
+	}
+
+	template <typename T>
+	T* allocate(size_t size)
+	{
+		if (!context)
+			return allocator.allocate<T>(size);
+
+		assert(count < kMaxBlocks);
+
+		size_t offset = (top + kAlignment - 1) & ~(kAlignment - 1);
+
+		// requests that don't fit into scratch memory (which means meshopt_simplifyScratchBound is out of sync) use the regular allocator
+		if (offset > context->scratch_size || size > (context->scratch_size - offset) / sizeof(T))
+		{
+			offsets[count] = top;
+			fallback[count] = true;
+			count++;
+
+			return allocator.allocate<T>(size);
+		}
+
+		offsets[count] = top;
+		fallback[count] = false;
+		count++;
+
+		top = offset + size * sizeof(T);
+
+		return reinterpret_cast<T*>(context->scratch + offset);
+	}
+
+	void deallocate(void* ptr)
+	{
+		if (!context)
+			return allocator.deallocate(ptr);
+
+		assert(count > 0);
+		count--;
+
+		if (fallback[count])
+			return allocator.deallocate(ptr);
+
+		top = offsets[count];
+		assert(ptr == context->scratch + ((top + kAlignment - 1) & ~(kAlignment - 1)));
+		(void)ptr;
+	}
+
+private:
+	meshopt_Allocator allocator;
+	meshopt_SimplifierContext* context;
+
+	size_t offsets[kMaxBlocks];
+	bool fallback[kMaxBlocks];
+	size_t count;
+	size_t top;
+};
+
+static void reserveScratch(meshopt_SimplifierContext* context, size_t size)
+{
+	if (context->scratch_size >= size)
+		return;
+
+	// grow geometrically to avoid frequent reallocations when mesh sizes increase gradually
+	size_t new_size = context->scratch_size + context->scratch_size / 2;
+	new_size = new_size < size ? size : new_size;
+
+	if (context->scratch)
+		meshopt_Allocator::Storage::deallocate(context->scratch);
+
+	context->scratch = static_cast<char*>(meshopt_Allocator::Storage::allocate(new_size));
+	context->scratch_size = new_size;
+}
+
+// wall clock time in seconds; clock() measures process CPU time on POSIX systems, which includes other threads, but it measures wall time on Windows
+static double getTimestamp()
+{
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
+#else
+	return double(clock()) / double(CLOCKS_PER_SEC);
+#endif
+}
+
+// adds the time elapsed since the last call to the phase total; used for meshopt_SimplifyStats
+static void updatePhaseTime(float& phase_time, double& last)
+{
+	double now = getTimestamp();
+	phase_time += float(now - last);
+	last = now;
+}
+
 struct EdgeAdjacency
 {
 	struct Edge
@@ -40,12 +162,21 @@ struct EdgeAdjacency
 
 	unsigned int* offsets;
 	Edge* data;
+
+	// compact representation: instead of storing edges, store corner indices and reconstruct edges from the index buffer
+	unsigned int* corners;
+	const unsigned int* indices;
+	const unsigned int* remap;
 };
 
-static void prepareEdgeAdjacency(EdgeAdjacency& adjacency, size_t index_count, size_t vertex_count, meshopt_Allocator& allocator)
+static void prepareEdgeAdjacency(EdgeAdjacency& adjacency, size_t index_count, size_t vertex_count, bool compact, ScratchAllocator& allocator)
 {
 	adjacency.offsets = allocator.allocate<unsigned int>(vertex_count + 1);
-	adjacency.data = allocator.allocate<EdgeAdjacency::Edge>(index_count);
+
+	if (compact)
+		adjacency.corners = allocator.allocate<unsigned int>(index_count);
+	else
+		adjacency.data = allocator.allocate<EdgeAdjacency::Edge>(index_count);
 }
 
 static void updateEdgeAdjacency(EdgeAdjacency& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count, const unsigned int* remap)
@@ -53,6 +184,7 @@ static void updateEdgeAdjacency(EdgeAdjacency& adjacency, const unsigned int* in
 	size_t face_count = index_count / 3;
 	unsigned int* offsets = adjacency.offsets + 1;
 	EdgeAdjacency::Edge* data = adjacency.data;
+	unsigned int* corners = adjacency.corners;
 
 	// fill edge counts
 	memset(offsets, 0, vertex_count * sizeof(unsigned int));
@@ -89,6 +221,14 @@ static void updateEdgeAdjacency(EdgeAdjacency& adjacency, const unsigned int* in
 			c = remap[c];
 		}
 
+		if (corners)
+		{
+			corners[offsets[a]++] = unsigned(i * 3 + 0);
+			corners[offsets[b]++] = unsigned(i * 3 + 1);
+			corners[offsets[c]++] = unsigned(i * 3 + 2);
+			continue;
+		}
+
 		data[offsets[a]].next = b;
 		data[offsets[a]].prev = c;
 		offsets[a]++;
@@ -105,6 +245,27 @@ static void updateEdgeAdjacency(EdgeAdjacency& adjacency, const unsigned int* in
 	// finalize offsets
 	adjacency.offsets[0] = 0;
 	assert(adjacency.offsets[vertex_count] == index_count);
+
+	// compact adjacency reconstructs edges from the index data, so it needs to stay alive until the next update
+	adjacency.indices = indices;
+	adjacency.remap = remap;
+}
+
+static EdgeAdjacency::Edge getEdge(const EdgeAdjacency& adjacency, unsigned int offset)
+{
+	if (adjacency.data)
+		return adjacency.data[offset];
+
+	static const unsigned int next[4] = {1, 2, 0, 1};
+
+	unsigned int corner = adjacency.corners[offset];
+	unsigned int base = corner - corner % 3;
+
+	unsigned int b = adjacency.indices[base + next[corner % 3]];
+	unsigned int c = adjacency.indices[base + next[corner % 3 + 1]];
+
+	EdgeAdjacency::Edge result = {adjacency.remap ? adjacency.remap[b] : b, adjacency.remap ? adjacency.remap[c] : c};
+	return result;
 }
 
 struct PositionHasher
@@ -187,7 +348,7 @@ static T* hashLookup2(T* table, size_t buckets, const Hash& hash, const T& key,
 	return NULL;
 }
 
-static void buildPositionRemap(unsigned int* remap, unsigned int* wedge, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const unsigned int* sparse_remap, meshopt_Allocator& allocator)
+static void buildPositionRemap(unsigned int* remap, unsigned int* wedge, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const unsigned int* sparse_remap, ScratchAllocator& allocator)
 {
 	PositionHasher hasher = {vertex_positions_data, vertex_positions_stride / sizeof(float), sparse_remap};
 
@@ -225,7 +386,7 @@ static void buildPositionRemap(unsigned int* remap, unsigned int* wedge, const f
 	allocator.deallocate(table);
 }
 
-static unsigned int* buildSparseRemap(unsigned int* indices, size_t index_count, size_t vertex_count, size_t* out_vertex_count, meshopt_Allocator& allocator)
+static unsigned int* buildSparseRemap(unsigned int* indices, size_t index_count, size_t vertex_count, size_t* out_vertex_count, ScratchAllocator& allocator)
 {
 	// use a bit set to compute the precise number of unique vertices
 	unsigned char* filter = allocator.allocate<unsigned char>((vertex_count + 7) / 8);
@@ -241,6 +402,9 @@ static unsigned int* buildSparseRemap(unsigned int* indices, size_t index_count,
 		filter[index / 8] |= 1 << (index % 8);
 	}
 
+	// filter is only needed to compute the unique count; release it early to reduce peak memory
+	allocator.deallocate(filter);
+
 	unsigned int* remap = allocator.allocate<unsigned int>(unique);
 	size_t offset = 0;
 
@@ -313,11 +477,8 @@ const unsigned char kHasOpposite[Kind_Count][Kind_Count] = {
 
 static bool hasEdge(const EdgeAdjacency& adjacency, unsigned int a, unsigned int b)
 {
-	unsigned int count = adjacency.offsets[a + 1] - adjacency.offsets[a];
-	const EdgeAdjacency::Edge* edges = adjacency.data + adjacency.offsets[a];
-
-	for (size_t i = 0; i < count; ++i)
-		if (edges[i].next == b)
+	for (unsigned int i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; ++i)
+		if (getEdge(adjacency, i).next == b)
 			return true;
 
 	return false;
@@ -338,12 +499,9 @@ static void classifyVertices(unsigned char* result, unsigned int* loop, unsigned
 	{
 		unsigned int vertex = unsigned(i);
 
-		unsigned int count = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
-		const EdgeAdjacency::Edge* edges = adjacency.data + adjacency.offsets[vertex];
-
-		for (size_t j = 0; j < count; ++j)
+		for (unsigned int j = adjacency.offsets[vertex]; j < adjacency.offsets[vertex + 1]; ++j)
 		{
-			unsigned int target = edges[j].next;
+			unsigned int target = getEdge(adjacency, j).next;
 
 			if (target == vertex)
 			{
@@ -903,13 +1061,12 @@ static bool hasTriangleFlips(const EdgeAdjacency& adjacency, const Vector3* vert
 	const Vector3& v0 = vertex_positions[i0];
 	const Vector3& v1 = vertex_positions[i1];
 
-	const EdgeAdjacency::Edge* edges = &adjacency.data[adjacency.offsets[i0]];
-	size_t count = adjacency.offsets[i0 + 1] - adjacency.offsets[i0];
-
-	for (size_t i = 0; i < count; ++i)
+	for (unsigned int i = adjacency.offsets[i0]; i < adjacency.offsets[i0 + 1]; ++i)
 	{
-		unsigned int a = collapse_remap[edges[i].next];
-		unsigned int b = collapse_remap[edges[i].prev];
+		EdgeAdjacency::Edge edge = getEdge(adjacency, i);
+
+		unsigned int a = collapse_remap[edge.next];
+		unsigned int b = collapse_remap[edge.prev];
 
 		// skip triangles that will get collapsed by i0->i1 collapse or already got collapsed previously
 		if (a == i1 || b == i1 || a == b)
@@ -1110,7 +1267,7 @@ static void sortEdgeCollapses(unsigned int* sort_order, const Collapse* collapse
 	}
 }
 
-static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char* collapse_locked, Quadric* vertex_quadrics, Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, size_t attribute_count, const Collapse* collapses, size_t collapse_count, const unsigned int* collapse_order, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, const unsigned int* loop, const unsigned int* loopback, const Vector3* vertex_positions, const EdgeAdjacency& adjacency, size_t triangle_collapse_goal, float error_limit, float& result_error)
+static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char* collapse_locked, Quadric* vertex_quadrics, Quadric* attribute_quadrics, QuadricGrad* attribute_gradients, size_t attribute_count, const Collapse* collapses, size_t collapse_count, const unsigned int* collapse_order, const unsigned int* remap, const unsigned int* wedge, const unsigned char* vertex_kind, const unsigned int* loop, const unsigned int* loopback, const Vector3* vertex_positions, const EdgeAdjacency& adjacency, size_t triangle_collapse_goal, float error_limit, float& result_error, meshopt_SimplifyStats* out_stats)
 {
 	size_t edge_collapses = 0;
 	size_t triangle_collapses = 0;
@@ -1119,25 +1276,24 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 	// note that edge_collapse_goal is an estimate; triangle_collapse_goal will be used to actually limit collapses
 	size_t edge_collapse_goal = triangle_collapse_goal / 2;
 
-#if TRACE
+	// note: these are cheap to maintain so we always collect them; they are used for tracing and runtime statistics
 	size_t stats[7] = {};
-#endif
 
 	for (size_t i = 0; i < collapse_count; ++i)
 	{
 		const Collapse& c = collapses[collapse_order[i]];
 
-		TRACESTATS(0);
+		stats[0]++;
 
 		if (c.error > error_limit)
 		{
-			TRACESTATS(4);
+			stats[4]++;
 			break;
 		}
 
 		if (triangle_collapses >= triangle_collapse_goal)
 		{
-			TRACESTATS(5);
+			stats[5]++;
 			break;
 		}
 
@@ -1149,7 +1305,7 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 		// topology, we only abort if we got over 1/6 collapses accordingly.
 		if (c.error > error_goal && c.error > result_error && triangle_collapses > triangle_collapse_goal / 6)
 		{
-			TRACESTATS(6);
+			stats[6]++;
 			break;
 		}
 
@@ -1166,7 +1322,7 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 		// it's important to not move other vertices towards a moved vertex to preserve error since we don't re-rank collapses mid-pass
 		if (collapse_locked[r0] | collapse_locked[r1])
 		{
-			TRACESTATS(1);
+			stats[1]++;
 			continue;
 		}
 
@@ -1175,7 +1331,7 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 			// adjust collapse goal since this collapse is invalid and shouldn't factor into error goal
 			edge_collapse_goal++;
 
-			TRACESTATS(2);
+			stats[2]++;
 			continue;
 		}
 
@@ -1271,6 +1427,19 @@ static size_t performEdgeCollapses(unsigned int* collapse_remap, unsigned char*
 	    stats[4] ? "error limit" : (stats[5] ? "count limit" : (stats[6] ? "error goal" : "out of collapses")));
 #endif
 
+	if (out_stats)
+	{
+		out_stats->collapses_evaluated += unsigned(stats[0]);
+		out_stats->collapses_performed += unsigned(edge_collapses);
+		out_stats->collapses_rejected_locked += unsigned(stats[1]);
+		out_stats->collapses_rejected_flip += unsigned(stats[2]);
+
+		// when nothing was collapsed, the caller stops and the reason depends on why this pass ended
+		// the pass may reject some collapses due to flips before breaking out of the loop, so loop exit conditions take precedence
+		if (edge_collapses == 0)
+			out_stats->stop_reason = stats[5] ? meshopt_SimplifyStopTarget : (stats[4] ? meshopt_SimplifyStopError : (stats[2] ? meshopt_SimplifyStopFlip : meshopt_SimplifyStopTopology));
+	}
+
 	return edge_collapses;
 }
 
@@ -1400,6 +1569,155 @@ static void computeVertexIds(unsigned int* vertex_ids, const Vector3* vertex_pos
 	}
 }
 
+// quantizes positions to a 1024^3 grid; unlike computeVertexIds, this uses truncation so that cells for power-of-two grid levels are nested
+static void computeVertexCodes(unsigned int* vertex_codes, const Vector3* vertex_positions, size_t vertex_count)
+{
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		const Vector3& v = vertex_positions[i];
+
+		int xi = int(v.x * 1024.f);
+		int yi = int(v.y * 1024.f);
+		int zi = int(v.z * 1024.f);
+
+		xi = xi > 1023 ? 1023 : xi;
+		yi = yi > 1023 ? 1023 : yi;
+		zi = zi > 1023 ? 1023 : zi;
+
+		vertex_codes[i] = (xi << 20) | (yi << 10) | zi;
+	}
+}
+
+static unsigned int bitLength(unsigned int v)
+{
+	unsigned int result = 0;
+
+	while (v)
+	{
+		result++;
+		v >>= 1;
+	}
+
+	return result;
+}
+
+// computes the number of non-degenerate triangles for grids with 2^k cells per axis, k=0..10, in a single pass
+static void countTriangleLevels(size_t* level_counts, const unsigned int* vertex_codes, const unsigned int* indices, size_t index_count)
+{
+	size_t hist[11] = {};
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int c0 = vertex_codes[indices[i + 0]];
+		unsigned int c1 = vertex_codes[indices[i + 1]];
+		unsigned int c2 = vertex_codes[indices[i + 2]];
+
+		// two vertices are in different cells on level k iff they differ in top k bits of any axis
+		unsigned int d01 = c0 ^ c1, d12 = c1 ^ c2, d20 = c2 ^ c0;
+		d01 = (d01 | (d01 >> 10) | (d01 >> 20)) & 1023;
+		d12 = (d12 | (d12 >> 10) | (d12 >> 20)) & 1023;
+		d20 = (d20 | (d20 >> 10) | (d20 >> 20)) & 1023;
+
+		// triangle is non-degenerate on level k iff all its edges are, which depends on the smallest difference
+		unsigned int dm = d01 < d12 ? d01 : d12;
+		dm = dm < d20 ? dm : d20;
+
+		hist[bitLength(dm)]++;
+	}
+
+	// triangles with difference of b bits are non-degenerate on levels 11-b and above
+	level_counts[0] = 0;
+
+	for (int k = 1; k <= 10; ++k)
+		level_counts[k] = level_counts[k - 1] + hist[11 - k];
+}
+
+inline unsigned int spreadBits3(unsigned int x)
+{
+	x &= 0x000003ff;
+	x = (x ^ (x << 16)) & 0xff0000ff;
+	x = (x ^ (x << 8)) & 0x0300f00f;
+	x = (x ^ (x << 4)) & 0x030c30c3;
+	x = (x ^ (x << 2)) & 0x09249249;
+	return x;
+}
+
+// computes the number of occupied cells for grids with 2^k cells per axis, k=0..10; vertex_codes are converted to Morton order and sorted in place
+static void countVertexLevels(size_t* level_counts, unsigned int* vertex_codes, unsigned int* scratch, size_t vertex_count)
+{
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		unsigned int c = vertex_codes[i];
+		vertex_codes[i] = (spreadBits3(c >> 20) << 2) | (spreadBits3(c >> 10) << 1) | spreadBits3(c);
+	}
+
+	// 3 passes of 10-bit radix sort; cells on every level form contiguous ranges in sorted Morton order
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		unsigned int hist[1024] = {};
+
+		for (size_t i = 0; i < vertex_count; ++i)
+			hist[(vertex_codes[i] >> (pass * 10)) & 1023]++;
+
+		unsigned int sum = 0;
+
+		for (int i = 0; i < 1024; ++i)
+		{
+			unsigned int h = hist[i];
+			hist[i] = sum;
+			sum += h;
+		}
+
+		for (size_t i = 0; i < vertex_count; ++i)
+			scratch[hist[(vertex_codes[i] >> (pass * 10)) & 1023]++] = vertex_codes[i];
+
+		unsigned int* temp = vertex_codes;
+		vertex_codes = scratch;
+		scratch = temp;
+	}
+
+	// note: after an odd number of passes, sorted codes are in the original scratch buffer
+	size_t hist[11] = {};
+
+	for (size_t i = 1; i < vertex_count; ++i)
+	{
+		// adjacent points start a new cell on level k iff their codes differ in top 3k bits
+		unsigned int b = bitLength(vertex_codes[i - 1] ^ vertex_codes[i]);
+
+		hist[(b + 2) / 3]++;
+	}
+
+	// points that differ in d top-most 3-bit groups are in different cells on levels 11-d and above
+	level_counts[0] = vertex_count > 0;
+
+	for (int k = 1; k <= 10; ++k)
+		level_counts[k] = level_counts[k - 1] + hist[11 - k];
+}
+
+// estimates grid size that produces the target count from counts for power-of-two grid levels
+static int estimateGridSize(const size_t* level_counts, size_t target_count)
+{
+	int level = 0;
+	while (level < 10 && level_counts[level + 1] <= target_count)
+		level++;
+
+	if (level == 10)
+		return 1024;
+
+	// counts grow polynomially with grid size, so we interpolate between levels in log space
+	float c0 = level_counts[level] > 1 ? float(level_counts[level]) : 1.f;
+	float c1 = float(level_counts[level + 1]);
+	float t = float(target_count) > c0 ? float(target_count) : c0;
+
+	// counts don't grow between the levels (or the target is 0), so there is nothing to interpolate
+	if (target_count == 0 || c1 <= c0)
+		return 1 << level;
+
+	float grid_size = float(1 << level) * powf(2.f, logf(t / c0) / logf(c1 / c0));
+
+	return int(grid_size + 0.5f);
+}
+
 static size_t countTriangles(const unsigned int* vertex_ids, const unsigned int* indices, size_t index_count)
 {
 	size_t result = 0;
@@ -1628,103 +1946,406 @@ static float interpolate(float y, float x0, float y0, float x1, float y1, float
 	return x1 + num / den;
 }
 
-} // namespace meshopt
-
-// Note: this is only exposed for debug visualization purposes; do *not* use
-enum
-{
-	meshopt_SimplifyInternalDebug = 1 << 30
-};
-
-size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+static size_t simplifyPointsGrid(unsigned int* destination, const Vector3* vertex_positions, size_t vertex_count, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t target_vertex_count, const size_t* level_counts, unsigned int* vertex_ids, unsigned int* vertex_cells, unsigned int* table, size_t table_size, meshopt_Allocator& allocator)
 {
-	using namespace meshopt;
+	if (target_vertex_count == 0)
+		return 0;
 
-	assert(index_count % 3 == 0);
-	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
-	assert(vertex_positions_stride % sizeof(float) == 0);
-	assert(target_index_count <= index_count);
-	assert(target_error >= 0);
-	assert((options & ~(meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute | meshopt_SimplifyInternalDebug)) == 0);
-	assert(vertex_attributes_stride >= attribute_count * sizeof(float) && vertex_attributes_stride <= 256);
-	assert(vertex_attributes_stride % sizeof(float) == 0);
-	assert(attribute_count <= kMaxAttributes);
-	for (size_t i = 0; i < attribute_count; ++i)
-		assert(attribute_weights[i] >= 0);
+	// find the optimal grid size using guided binary search
+#if TRACE
+	printf("target: %d cells\n", int(target_vertex_count));
+#endif
 
-	meshopt_Allocator allocator;
+	const int kInterpolationPasses = 5;
 
-	unsigned int* result = destination;
-	if (result != indices)
-		memcpy(result, indices, index_count * sizeof(unsigned int));
+	// invariant: # of vertices in min_grid <= target_count
+	int min_grid = 0;
+	int max_grid = 1025;
+	size_t min_vertices = 0;
+	size_t max_vertices = vertex_count;
 
-	// build an index remap and update indices/vertex_count to minimize the subsequent work
-	// note: as a consequence, errors will be computed relative to the subset extent
-	unsigned int* sparse_remap = NULL;
-	if (options & meshopt_SimplifySparse)
-		sparse_remap = buildSparseRemap(result, index_count, vertex_count, &vertex_count, allocator);
+	// instead of starting in the middle, let's guess as to what the answer might be based on power-of-two levels
+	int next_grid_size = estimateGridSize(level_counts, target_vertex_count);
 
-	// build adjacency information
-	EdgeAdjacency adjacency = {};
-	prepareEdgeAdjacency(adjacency, index_count, vertex_count, allocator);
-	updateEdgeAdjacency(adjacency, result, index_count, vertex_count, NULL);
+	for (int pass = 0; pass < 10 + kInterpolationPasses; ++pass)
+	{
+		assert(min_vertices < target_vertex_count);
+		assert(max_grid - min_grid > 1);
 
-	// build position remap that maps each vertex to the one with identical position
-	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
-	unsigned int* wedge = allocator.allocate<unsigned int>(vertex_count);
-	buildPositionRemap(remap, wedge, vertex_positions_data, vertex_count, vertex_positions_stride, sparse_remap, allocator);
+		// we clamp the prediction of the grid size to make sure that the search converges
+		int grid_size = next_grid_size;
+		grid_size = (grid_size <= min_grid) ? min_grid + 1 : (grid_size >= max_grid ? max_grid - 1 : grid_size);
 
-	// classify vertices; vertex kind determines collapse rules, see kCanCollapse
-	unsigned char* vertex_kind = allocator.allocate<unsigned char>(vertex_count);
-	unsigned int* loop = allocator.allocate<unsigned int>(vertex_count);
-	unsigned int* loopback = allocator.allocate<unsigned int>(vertex_count);
-	classifyVertices(vertex_kind, loop, loopback, vertex_count, adjacency, remap, wedge, vertex_lock, sparse_remap, options);
+		computeVertexIds(vertex_ids, vertex_positions, vertex_count, grid_size);
+		size_t vertices = countVertexCells(table, table_size, vertex_ids, vertex_count);
 
 #if TRACE
-	size_t unique_positions = 0;
-	for (size_t i = 0; i < vertex_count; ++i)
-		unique_positions += remap[i] == i;
-
-	printf("position remap: %d vertices => %d positions\n", int(vertex_count), int(unique_positions));
-
-	size_t kinds[Kind_Count] = {};
-	for (size_t i = 0; i < vertex_count; ++i)
-		kinds[vertex_kind[i]] += remap[i] == i;
-
-	printf("kinds: manifold %d, border %d, seam %d, complex %d, locked %d\n",
-	    int(kinds[Kind_Manifold]), int(kinds[Kind_Border]), int(kinds[Kind_Seam]), int(kinds[Kind_Complex]), int(kinds[Kind_Locked]));
+		printf("pass %d (%s): grid size %d, vertices %d, %s\n",
+		    pass, (pass == 0) ? "guess" : (pass <= kInterpolationPasses ? "lerp" : "binary"),
+		    grid_size, int(vertices),
+		    (vertices <= target_vertex_count) ? "under" : "over");
 #endif
 
-	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
-	float vertex_scale = rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride, sparse_remap);
-
-	float* vertex_attributes = NULL;
+		float tip = interpolate(float(target_vertex_count), float(min_grid), float(min_vertices), float(grid_size), float(vertices), float(max_grid), float(max_vertices));
 
-	if (attribute_count)
-	{
-		unsigned int attribute_remap[kMaxAttributes];
+		if (vertices <= target_vertex_count)
+		{
+			min_grid = grid_size;
+			min_vertices = vertices;
+		}
+		else
+		{
+			max_grid = grid_size;
+			max_vertices = vertices;
+		}
 
-		// remap attributes to only include ones with weight > 0 to minimize memory/compute overhead for quadrics
-		size_t attributes_used = 0;
-		for (size_t i = 0; i < attribute_count; ++i)
-			if (attribute_weights[i] > 0)
-				attribute_remap[attributes_used++] = unsigned(i);
+		if (vertices == target_vertex_count || max_grid - min_grid <= 1)
+			break;
 
-		attribute_count = attributes_used;
-		vertex_attributes = allocator.allocate<float>(vertex_count * attribute_count);
-		rescaleAttributes(vertex_attributes, vertex_attributes_data, vertex_count, vertex_attributes_stride, attribute_weights, attribute_count, attribute_remap, sparse_remap);
+		// we start by using interpolation search - it usually converges faster
+		// however, interpolation search has a worst case of O(N) so we switch to binary search after a few iterations which converges in O(logN)
+		next_grid_size = (pass < kInterpolationPasses) ? int(tip + 0.5f) : (min_grid + max_grid) / 2;
 	}
 
-	Quadric* vertex_quadrics = allocator.allocate<Quadric>(vertex_count);
-	memset(vertex_quadrics, 0, vertex_count * sizeof(Quadric));
+	if (min_vertices == 0)
+		return 0;
 
-	Quadric* attribute_quadrics = NULL;
-	QuadricGrad* attribute_gradients = NULL;
+	// build vertex->cell association by mapping all vertices with the same quantized position to the same cell
+	computeVertexIds(vertex_ids, vertex_positions, vertex_count, min_grid);
+	size_t cell_count = fillVertexCells(table, table_size, vertex_cells, vertex_ids, vertex_count);
 
-	if (attribute_count)
-	{
-		attribute_quadrics = allocator.allocate<Quadric>(vertex_count);
-		memset(attribute_quadrics, 0, vertex_count * sizeof(Quadric));
+	// accumulate points into a reservoir for each target cell
+	Reservoir* cell_reservoirs = allocator.allocate<Reservoir>(cell_count);
+	memset(cell_reservoirs, 0, cell_count * sizeof(Reservoir));
+
+	fillCellReservoirs(cell_reservoirs, cell_count, vertex_positions, vertex_colors, vertex_colors_stride, vertex_count, vertex_cells);
+
+	// for each target cell, find the vertex with the minimal error
+	unsigned int* cell_remap = allocator.allocate<unsigned int>(cell_count);
+	float* cell_errors = allocator.allocate<float>(cell_count);
+
+	// we scale the color weight to bring it to the same scale as position so that error addition makes sense
+	float color_weight_scaled = color_weight * (min_grid == 1 ? 1.f : 1.f / (min_grid - 1));
+
+	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_reservoirs, vertex_positions, vertex_colors, vertex_colors_stride, color_weight_scaled * color_weight_scaled, vertex_count);
+
+	// copy results to the output
+	assert(cell_count <= target_vertex_count);
+	memcpy(destination, cell_remap, sizeof(unsigned int) * cell_count);
+
+#if TRACE
+	// compute error
+	float result_error = 0.f;
+
+	for (size_t i = 0; i < cell_count; ++i)
+		result_error = result_error < cell_errors[i] ? cell_errors[i] : result_error;
+
+	printf("result: %d cells, %e error\n", int(cell_count), sqrtf(result_error));
+#endif
+
+	allocator.deallocate(cell_errors);
+	allocator.deallocate(cell_remap);
+	allocator.deallocate(cell_reservoirs);
+
+	return cell_count;
+}
+
+struct PointHierarchy
+{
+	meshopt_PointNode* nodes;
+	const unsigned int* node_ranges; // [begin, end) in sorted order for each node
+
+	const unsigned int* codes; // Morton codes in sorted order
+	const unsigned int* order; // sorted order => original point index
+	const Vector3* positions; // normalized positions in sorted order
+
+	const float* vertex_positions_data;
+	size_t vertex_positions_stride_float;
+	const float* vertex_colors;
+	size_t vertex_colors_stride_float;
+	float color_weight;
+
+	float extent;
+	unsigned int grid_bits;
+
+	unsigned int* owner; // sorted order => node that stores the point
+
+	// nodes of the depth that is being processed, split into tasks by point ranges
+	size_t level_begin, level_end;
+	size_t task_points;
+};
+
+static size_t upperBoundCode(const unsigned int* codes, size_t begin, size_t end, unsigned int key, int shift)
+{
+	while (begin < end)
+	{
+		size_t mid = begin + (end - begin) / 2;
+
+		if ((codes[mid] >> shift) <= key)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	return begin;
+}
+
+static void samplePointNode(const PointHierarchy& h, size_t node_index)
+{
+	static const float dummy_color[] = {0.f, 0.f, 0.f};
+
+	meshopt_PointNode& node = h.nodes[node_index];
+
+	size_t begin = h.node_ranges[node_index * 2 + 0];
+	size_t end = h.node_ranges[node_index * 2 + 1];
+
+	unsigned int* owner = h.owner;
+
+	if (node.child_count == 0)
+	{
+		// leaf nodes store all remaining points; their bounds are propagated to ancestors later
+		float minv[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+		float maxv[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			if (owner[i] == ~0u)
+				owner[i] = unsigned(node_index);
+
+			const float* v = h.vertex_positions_data + h.order[i] * h.vertex_positions_stride_float;
+
+			for (int k = 0; k < 3; ++k)
+			{
+				minv[k] = minv[k] > v[k] ? v[k] : minv[k];
+				maxv[k] = maxv[k] < v[k] ? v[k] : maxv[k];
+			}
+		}
+
+		memcpy(node.bounds_min, minv, sizeof(minv));
+		memcpy(node.bounds_max, maxv, sizeof(maxv));
+		return;
+	}
+
+	// cells of the node grid form contiguous ranges in sorted Morton order
+	unsigned int cell_depth = node.depth + h.grid_bits > 10 ? 10 : node.depth + h.grid_bits;
+	int shift = 3 * (10 - cell_depth);
+
+	// we scale the color weight to bring it to the same scale as position so that error addition makes sense
+	float color_weight = h.color_weight / float(1 << cell_depth);
+	color_weight *= color_weight;
+
+	for (size_t cell_begin = begin; cell_begin < end;)
+	{
+		unsigned int key = h.codes[cell_begin] >> shift;
+		size_t cell_end = cell_begin + 1;
+
+		while (cell_end < end && (h.codes[cell_end] >> shift) == key)
+			cell_end++;
+
+		// accumulate all remaining points in the cell into a reservoir and pick the point closest to the average
+		Reservoir r = {};
+
+		for (size_t i = cell_begin; i < cell_end; ++i)
+		{
+			if (owner[i] != ~0u)
+				continue;
+
+			const Vector3& v = h.positions[i];
+			const float* color = h.vertex_colors ? &h.vertex_colors[h.order[i] * h.vertex_colors_stride_float] : dummy_color;
+
+			r.x += v.x;
+			r.y += v.y;
+			r.z += v.z;
+			r.r += color[0];
+			r.g += color[1];
+			r.b += color[2];
+			r.w += 1.f;
+		}
+
+		if (r.w > 0.f)
+		{
+			float iw = 1.f / r.w;
+
+			r.x *= iw;
+			r.y *= iw;
+			r.z *= iw;
+			r.r *= iw;
+			r.g *= iw;
+			r.b *= iw;
+
+			size_t best = ~size_t(0);
+			float best_error = FLT_MAX;
+
+			for (size_t i = cell_begin; i < cell_end; ++i)
+			{
+				if (owner[i] != ~0u)
+					continue;
+
+				const Vector3& v = h.positions[i];
+				const float* color = h.vertex_colors ? &h.vertex_colors[h.order[i] * h.vertex_colors_stride_float] : dummy_color;
+
+				float pos_error = (v.x - r.x) * (v.x - r.x) + (v.y - r.y) * (v.y - r.y) + (v.z - r.z) * (v.z - r.z);
+				float col_error = (color[0] - r.r) * (color[0] - r.r) + (color[1] - r.g) * (color[1] - r.g) + (color[2] - r.b) * (color[2] - r.b);
+				float error = pos_error + color_weight * col_error;
+
+				if (best == ~size_t(0) || error < best_error)
+				{
+					best = i;
+					best_error = error;
+				}
+			}
+
+			owner[best] = unsigned(node_index);
+		}
+
+		cell_begin = cell_end;
+	}
+}
+
+static void samplePointNodesTask(void* context, size_t index)
+{
+	const PointHierarchy& h = *static_cast<const PointHierarchy*>(context);
+
+	// each task processes nodes of the current depth that start in its range of points
+	size_t first_point = h.node_ranges[h.level_begin * 2];
+	size_t task_begin = first_point + index * h.task_points;
+	size_t task_end = task_begin + h.task_points;
+
+	size_t node_begin = h.level_begin, node_end = h.level_end;
+
+	while (node_begin < node_end)
+	{
+		size_t mid = node_begin + (node_end - node_begin) / 2;
+
+		if (h.node_ranges[mid * 2] < task_begin)
+			node_begin = mid + 1;
+		else
+			node_end = mid;
+	}
+
+	for (size_t i = node_begin; i < h.level_end && h.node_ranges[i * 2] < task_end; ++i)
+		samplePointNode(h, i);
+}
+
+} // namespace meshopt
+
+// Note: this is only exposed for debug visualization purposes; do *not* use
+enum
+{
+	meshopt_SimplifyInternalDebug = 1 << 30
+};
+
+size_t meshopt_simplifyEdge(meshopt_SimplifierContext* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(target_index_count <= index_count);
+	assert(target_error >= 0);
+	assert((options & ~(meshopt_SimplifyLockBorder | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute | meshopt_SimplifyLowMemory | meshopt_SimplifyInternalDebug)) == 0);
+	assert(vertex_attributes_stride >= attribute_count * sizeof(float) && vertex_attributes_stride <= 256);
+	assert(vertex_attributes_stride % sizeof(float) == 0);
+	assert(attribute_count <= kMaxAttributes);
+	for (size_t i = 0; i < attribute_count; ++i)
+		assert(attribute_weights[i] >= 0);
+
+	// context scratch memory is sized upfront so that allocations never need to grow it mid-flight
+	if (context)
+		reserveScratch(context, meshopt_simplifyScratchBound(index_count, vertex_count, attribute_count, options) + ScratchAllocator::kPadding);
+
+	ScratchAllocator allocator(context);
+
+	// statistics are collected for context-based simplification; phase timing is skipped otherwise to avoid timer overhead
+	meshopt_SimplifyStats* stats = context ? &context->stats : NULL;
+	double time_last = 0;
+
+	if (stats)
+	{
+		memset(stats, 0, sizeof(meshopt_SimplifyStats));
+		time_last = getTimestamp();
+	}
+
+	unsigned int* result = destination;
+	if (result != indices)
+		memcpy(result, indices, index_count * sizeof(unsigned int));
+
+	// build an index remap and update indices/vertex_count to minimize the subsequent work
+	// note: as a consequence, errors will be computed relative to the subset extent
+	unsigned int* sparse_remap = NULL;
+	if (options & meshopt_SimplifySparse)
+		sparse_remap = buildSparseRemap(result, index_count, vertex_count, &vertex_count, allocator);
+
+	// build adjacency information
+	EdgeAdjacency adjacency = {};
+	prepareEdgeAdjacency(adjacency, index_count, vertex_count, (options & meshopt_SimplifyLowMemory) != 0, allocator);
+	updateEdgeAdjacency(adjacency, result, index_count, vertex_count, NULL);
+
+	// build position remap that maps each vertex to the one with identical position
+	unsigned int* remap = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* wedge = allocator.allocate<unsigned int>(vertex_count);
+	buildPositionRemap(remap, wedge, vertex_positions_data, vertex_count, vertex_positions_stride, sparse_remap, allocator);
+
+	// classify vertices; vertex kind determines collapse rules, see kCanCollapse
+	unsigned char* vertex_kind = allocator.allocate<unsigned char>(vertex_count);
+	unsigned int* loop = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* loopback = allocator.allocate<unsigned int>(vertex_count);
+	classifyVertices(vertex_kind, loop, loopback, vertex_count, adjacency, remap, wedge, vertex_lock, sparse_remap, options);
+
+	if (stats)
+	{
+		for (size_t i = 0; i < vertex_count; ++i)
+			stats->locked_vertices += remap[i] == i && vertex_kind[i] == Kind_Locked;
+
+		updatePhaseTime(stats->time_setup, time_last);
+	}
+
+#if TRACE
+	size_t unique_positions = 0;
+	for (size_t i = 0; i < vertex_count; ++i)
+		unique_positions += remap[i] == i;
+
+	printf("position remap: %d vertices => %d positions\n", int(vertex_count), int(unique_positions));
+
+	size_t kinds[Kind_Count] = {};
+	for (size_t i = 0; i < vertex_count; ++i)
+		kinds[vertex_kind[i]] += remap[i] == i;
+
+	printf("kinds: manifold %d, border %d, seam %d, complex %d, locked %d\n",
+	    int(kinds[Kind_Manifold]), int(kinds[Kind_Border]), int(kinds[Kind_Seam]), int(kinds[Kind_Complex]), int(kinds[Kind_Locked]));
+#endif
+
+	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
+	float vertex_scale = rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride, sparse_remap);
+
+	float* vertex_attributes = NULL;
+
+	if (attribute_count)
+	{
+		unsigned int attribute_remap[kMaxAttributes];
+
+		// remap attributes to only include ones with weight > 0 to minimize memory/compute overhead for quadrics
+		size_t attributes_used = 0;
+		for (size_t i = 0; i < attribute_count; ++i)
+			if (attribute_weights[i] > 0)
+				attribute_remap[attributes_used++] = unsigned(i);
+
+		attribute_count = attributes_used;
+		vertex_attributes = allocator.allocate<float>(vertex_count * attribute_count);
+		rescaleAttributes(vertex_attributes, vertex_attributes_data, vertex_count, vertex_attributes_stride, attribute_weights, attribute_count, attribute_remap, sparse_remap);
+	}
+
+	Quadric* vertex_quadrics = allocator.allocate<Quadric>(vertex_count);
+	memset(vertex_quadrics, 0, vertex_count * sizeof(Quadric));
+
+	Quadric* attribute_quadrics = NULL;
+	QuadricGrad* attribute_gradients = NULL;
+
+	if (attribute_count)
+	{
+		attribute_quadrics = allocator.allocate<Quadric>(vertex_count);
+		memset(attribute_quadrics, 0, vertex_count * sizeof(Quadric));
 
 		attribute_gradients = allocator.allocate<QuadricGrad>(vertex_count * attribute_count);
 		memset(attribute_gradients, 0, vertex_count * attribute_count * sizeof(QuadricGrad));
@@ -1736,6 +2357,9 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 	if (attribute_count)
 		fillAttributeQuadrics(attribute_quadrics, attribute_gradients, result, index_count, vertex_positions, vertex_attributes, attribute_count);
 
+	if (stats)
+		updatePhaseTime(stats->time_quadrics, time_last);
+
 #if TRACE
 	size_t pass_count = 0;
 #endif
@@ -1756,15 +2380,33 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 
 	while (result_count > target_index_count)
 	{
+		// the callback can cancel the simplification between passes; the result so far is valid since passes are never interrupted
+		if (context && context->callback && !context->callback(context->callback_data, result_count, sqrtf(result_error) * error_scale))
+		{
+			if (stats)
+				stats->stop_reason = meshopt_SimplifyStopCancel;
+			break;
+		}
+
 		// note: throughout the simplification process adjacency structure reflects welded topology for result-in-progress
 		updateEdgeAdjacency(adjacency, result, result_count, vertex_count, remap);
 
 		size_t edge_collapse_count = pickEdgeCollapses(edge_collapses, collapse_capacity, result, result_count, remap, vertex_kind, loop, loopback);
 		assert(edge_collapse_count <= collapse_capacity);
 
+		if (stats)
+			updatePhaseTime(stats->time_pick, time_last);
+
 		// no edges can be collapsed any more due to topology restrictions
 		if (edge_collapse_count == 0)
+		{
+			if (stats)
+				stats->stop_reason = meshopt_SimplifyStopTopology;
 			break;
+		}
+
+		if (stats)
+			stats->passes++;
 
 #if TRACE
 		printf("pass %d:%c", int(pass_count++), TRACE >= 2 ? '\n' : ' ');
@@ -1774,6 +2416,9 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 
 		sortEdgeCollapses(collapse_order, edge_collapses, edge_collapse_count);
 
+		if (stats)
+			updatePhaseTime(stats->time_rank, time_last);
+
 		size_t triangle_collapse_goal = (result_count - target_index_count) / 3;
 
 		for (size_t i = 0; i < vertex_count; ++i)
@@ -1781,11 +2426,15 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 
 		memset(collapse_locked, 0, vertex_count);
 
-		size_t collapses = performEdgeCollapses(collapse_remap, collapse_locked, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, edge_collapses, edge_collapse_count, collapse_order, remap, wedge, vertex_kind, loop, loopback, vertex_positions, adjacency, triangle_collapse_goal, error_limit, result_error);
+		size_t collapses = performEdgeCollapses(collapse_remap, collapse_locked, vertex_quadrics, attribute_quadrics, attribute_gradients, attribute_count, edge_collapses, edge_collapse_count, collapse_order, remap, wedge, vertex_kind, loop, loopback, vertex_positions, adjacency, triangle_collapse_goal, error_limit, result_error, stats);
 
 		// no edges can be collapsed any more due to hitting the error limit or triangle collapse limit
 		if (collapses == 0)
+		{
+			if (stats)
+				updatePhaseTime(stats->time_collapse, time_last);
 			break;
+		}
 
 		remapEdgeLoops(loop, vertex_count, collapse_remap);
 		remapEdgeLoops(loopback, vertex_count, collapse_remap);
@@ -1793,6 +2442,9 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 		size_t new_count = remapIndexBuffer(result, result_count, collapse_remap);
 		assert(new_count < result_count);
 
+		if (stats)
+			updatePhaseTime(stats->time_collapse, time_last);
+
 		result_count = new_count;
 	}
 
@@ -1829,12 +2481,174 @@ size_t meshopt_simplifyEdge(unsigned int* destination, const unsigned int* indic
 
 size_t meshopt_simplify(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
 {
-	return meshopt_simplifyEdge(destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, NULL, 0, NULL, 0, NULL, target_index_count, target_error, options, out_result_error);
+	return meshopt_simplifyEdge(NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, NULL, 0, NULL, 0, NULL, target_index_count, target_error, options, out_result_error);
 }
 
 size_t meshopt_simplifyWithAttributes(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
 {
-	return meshopt_simplifyEdge(destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, vertex_lock, target_index_count, target_error, options, out_result_error);
+	return meshopt_simplifyEdge(NULL, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, vertex_lock, target_index_count, target_error, options, out_result_error);
+}
+
+meshopt_SimplifierContext* meshopt_createSimplifierContext()
+{
+	meshopt_SimplifierContext* context = static_cast<meshopt_SimplifierContext*>(meshopt_Allocator::Storage::allocate(sizeof(meshopt_SimplifierContext)));
+	memset(context, 0, sizeof(meshopt_SimplifierContext));
+
+	return context;
+}
+
+void meshopt_destroySimplifierContext(meshopt_SimplifierContext* context)
+{
+	if (!context)
+		return;
+
+	if (context->scratch)
+		meshopt_Allocator::Storage::deallocate(context->scratch);
+
+	meshopt_Allocator::Storage::deallocate(context);
+}
+
+size_t meshopt_simplifyWithContext(meshopt_SimplifierContext* context, unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, float* out_result_error)
+{
+	assert(context);
+
+	return meshopt_simplifyEdge(context, destination, indices, index_count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, vertex_lock, target_index_count, target_error, options, out_result_error);
+}
+
+void meshopt_getSimplifierStats(const meshopt_SimplifierContext* context, meshopt_SimplifyStats* stats)
+{
+	assert(context);
+
+	*stats = context->stats;
+}
+
+void meshopt_setSimplifierCallback(meshopt_SimplifierContext* context, int (*callback)(void* callback_data, size_t index_count, float error), void* callback_data)
+{
+	assert(context);
+
+	context->callback = callback;
+	context->callback_data = callback_data;
+}
+
+size_t meshopt_simplifyStream(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_attributes_data, size_t vertex_attributes_stride, const float* attribute_weights, size_t attribute_count, const unsigned char* vertex_lock, size_t target_index_count, float target_error, unsigned int options, size_t chunk_index_count, float* out_result_error)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(target_index_count <= index_count);
+	assert(target_error >= 0);
+	assert(chunk_index_count >= 3 && chunk_index_count % 3 == 0);
+	assert((options & (meshopt_SimplifySparse | meshopt_SimplifyInternalDebug)) == 0);
+
+	meshopt_Allocator allocator;
+
+	// chunks are simplified in sparse mode, which makes errors relative to chunk extents; to keep errors consistent, we use absolute errors internally
+	float error_scale = (options & meshopt_SimplifyErrorAbsolute) ? 1.f : rescalePositions(NULL, vertex_positions_data, vertex_count, vertex_positions_stride);
+	float error_budget = target_error * error_scale;
+	float result_error = 0;
+
+	// owner[] tracks the chunk each vertex belongs to; vertices that are shared between chunks must stay locked to keep chunks connected
+	const unsigned int kShared = ~0u - 1;
+
+	unsigned int* owner = allocator.allocate<unsigned int>(vertex_count);
+	unsigned char* chunk_lock = allocator.allocate<unsigned char>(vertex_count);
+	unsigned int* chunk = allocator.allocate<unsigned int>(chunk_index_count);
+
+	const unsigned int* source = indices;
+	size_t source_count = index_count;
+
+	unsigned int chunk_options = options | meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute;
+
+	// all chunks reuse the same scratch memory; it's released before the allocator releases the blocks above to maintain stack order
+	meshopt_SimplifierContext context = {};
+
+	int stalled_passes = 0;
+
+	// every other pass shifts chunk boundaries by half a chunk so that vertices locked during the previous pass end up in chunk interiors
+	for (int pass = 0; source_count > target_index_count && stalled_passes < 2; ++pass)
+	{
+		size_t chunk_offset = (pass & 1) ? (chunk_index_count / 6) * 3 : 0;
+		size_t chunk_first = chunk_offset ? chunk_offset : chunk_index_count;
+
+		memset(owner, -1, vertex_count * sizeof(unsigned int));
+
+		unsigned int chunk_id = 0;
+
+		for (size_t begin = 0; begin < source_count; ++chunk_id)
+		{
+			size_t end = begin == 0 ? chunk_first : begin + chunk_index_count;
+			end = end < source_count ? end : source_count;
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				unsigned int v = source[i];
+				assert(v < vertex_count);
+
+				owner[v] = (owner[v] == ~0u || owner[v] == chunk_id) ? chunk_id : kShared;
+			}
+
+			begin = end;
+		}
+
+		size_t write = 0;
+		float pass_error = 0;
+
+		for (size_t begin = 0; begin < source_count;)
+		{
+			size_t end = begin == 0 ? chunk_first : begin + chunk_index_count;
+			end = end < source_count ? end : source_count;
+
+			size_t count = end - begin;
+
+			// the chunk is copied to a separate buffer since output may overwrite the source when destination aliases indices
+			memcpy(chunk, source + begin, count * sizeof(unsigned int));
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				unsigned int v = chunk[i];
+				chunk_lock[v] = (owner[v] == kShared) | (vertex_lock && vertex_lock[v]);
+			}
+
+			// each chunk gets a share of the target proportional to its size
+			size_t chunk_target = size_t(double(count) * double(target_index_count) / double(source_count)) / 3 * 3;
+			float chunk_limit = error_budget > result_error ? error_budget - result_error : 0.f;
+			float chunk_error = 0;
+
+			size_t result = meshopt_simplifyEdge(&context, chunk, chunk, count, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_attributes_data, vertex_attributes_stride, attribute_weights, attribute_count, chunk_lock, chunk_target, chunk_limit, chunk_options, &chunk_error);
+
+			// write is always behind begin, so this never overwrites source data that hasn't been read yet
+			assert(write + result <= end);
+			memmove(destination + write, chunk, result * sizeof(unsigned int));
+
+			write += result;
+			pass_error = pass_error < chunk_error ? chunk_error : pass_error;
+
+			begin = end;
+		}
+
+		// each pass starts from scratch, so the errors accumulate across passes
+		result_error += pass_error;
+
+		stalled_passes = (write == source_count) ? stalled_passes + 1 : 0;
+
+		// if the entire mesh fits into one chunk, the next pass would produce the same result
+		if (chunk_id == 1)
+			stalled_passes = 2;
+
+		source = destination;
+		source_count = write;
+	}
+
+	if (context.scratch)
+		meshopt_Allocator::Storage::deallocate(context.scratch);
+
+	if (source != destination)
+		memcpy(destination, source, source_count * sizeof(unsigned int));
+
+	if (out_result_error)
+		*out_result_error = error_scale == 0.f ? 0.f : result_error / error_scale;
+
+	return source_count;
 }
 
 size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, size_t target_index_count, float target_error, float* out_result_error)
@@ -1846,9 +2660,6 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 	assert(vertex_positions_stride % sizeof(float) == 0);
 	assert(target_index_count <= index_count);
 
-	// we expect to get ~2 triangles/vertex in the output
-	size_t target_cell_count = target_index_count / 6;
-
 	meshopt_Allocator allocator;
 
 	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
@@ -1857,11 +2668,17 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 	// find the optimal grid size using guided binary search
 #if TRACE
 	printf("source: %d vertices, %d triangles\n", int(vertex_count), int(index_count / 3));
-	printf("target: %d cells, %d triangles\n", int(target_cell_count), int(target_index_count / 3));
+	// we expect to get ~2 triangles/vertex in the output
+	printf("target: %d cells, %d triangles\n", int(target_index_count / 6), int(target_index_count / 3));
 #endif
 
 	unsigned int* vertex_ids = allocator.allocate<unsigned int>(vertex_count);
 
+	// count triangles for all power-of-two grid levels in a single pass; this gives a close initial guess for the search
+	size_t level_counts[11];
+	computeVertexCodes(vertex_ids, vertex_positions, vertex_count);
+	countTriangleLevels(level_counts, vertex_ids, indices, index_count);
+
 	const int kInterpolationPasses = 5;
 
 	// invariant: # of triangles in min_grid <= target_count
@@ -1877,8 +2694,8 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 		min_triangles = countTriangles(vertex_ids, indices, index_count);
 	}
 
-	// instead of starting in the middle, let's guess as to what the answer might be! triangle count usually grows as a square of grid size...
-	int next_grid_size = int(sqrtf(float(target_cell_count)) + 0.5f);
+	// instead of starting in the middle, let's guess as to what the answer might be based on power-of-two levels
+	int next_grid_size = estimateGridSize(level_counts, target_index_count / 3);
 
 	for (int pass = 0; pass < 10 + kInterpolationPasses; ++pass)
 	{
@@ -1970,6 +2787,16 @@ size_t meshopt_simplifySloppy(unsigned int* destination, const unsigned int* ind
 }
 
 size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t target_vertex_count)
+{
+	assert(target_vertex_count <= vertex_count);
+
+	size_t result = 0;
+	meshopt_simplifyPointsMulti(destination, &result, vertex_positions_data, vertex_count, vertex_positions_stride, vertex_colors, vertex_colors_stride, color_weight, &target_vertex_count, 1);
+
+	return result;
+}
+
+size_t meshopt_simplifyPointsMulti(unsigned int* destination, size_t* destination_counts, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, const size_t* target_vertex_counts, size_t target_count)
 {
 	using namespace meshopt;
 
@@ -1978,11 +2805,18 @@ size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_pos
 	assert(vertex_colors_stride == 0 || (vertex_colors_stride >= 12 && vertex_colors_stride <= 256));
 	assert(vertex_colors_stride % sizeof(float) == 0);
 	assert(vertex_colors == NULL || vertex_colors_stride != 0);
-	assert(target_vertex_count <= vertex_count);
 
-	size_t target_cell_count = target_vertex_count;
+	size_t max_target = 0;
+
+	for (size_t i = 0; i < target_count; ++i)
+	{
+		assert(target_vertex_counts[i] <= vertex_count);
 
-	if (target_cell_count == 0)
+		max_target = max_target < target_vertex_counts[i] ? target_vertex_counts[i] : max_target;
+		destination_counts[i] = 0;
+	}
+
+	if (max_target == 0)
 		return 0;
 
 	meshopt_Allocator allocator;
@@ -1990,107 +2824,314 @@ size_t meshopt_simplifyPoints(unsigned int* destination, const float* vertex_pos
 	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
 	rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
 
-	// find the optimal grid size using guided binary search
 #if TRACE
 	printf("source: %d vertices\n", int(vertex_count));
-	printf("target: %d cells\n", int(target_cell_count));
 #endif
 
 	unsigned int* vertex_ids = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* vertex_cells = allocator.allocate<unsigned int>(vertex_count);
 
 	size_t table_size = hashBuckets2(vertex_count);
 	unsigned int* table = allocator.allocate<unsigned int>(table_size);
 
-	const int kInterpolationPasses = 5;
+	// count cells for all power-of-two grid levels once; this gives a close initial guess for the search for every target
+	size_t level_counts[11];
+	computeVertexCodes(vertex_ids, vertex_positions, vertex_count);
+	countVertexLevels(level_counts, vertex_ids, table, vertex_count);
 
-	// invariant: # of vertices in min_grid <= target_count
-	int min_grid = 0;
-	int max_grid = 1025;
-	size_t min_vertices = 0;
-	size_t max_vertices = vertex_count;
+	size_t result = 0;
 
-	// instead of starting in the middle, let's guess as to what the answer might be! triangle count usually grows as a square of grid size...
-	int next_grid_size = int(sqrtf(float(target_cell_count)) + 0.5f);
+	for (size_t i = 0; i < target_count; ++i)
+	{
+		size_t count = simplifyPointsGrid(destination + result, vertex_positions, vertex_count, vertex_colors, vertex_colors_stride, color_weight, target_vertex_counts[i], level_counts, vertex_ids, vertex_cells, table, table_size, allocator);
 
-	for (int pass = 0; pass < 10 + kInterpolationPasses; ++pass)
+		destination_counts[i] = count;
+		result += count;
+	}
+
+	return result;
+}
+
+size_t meshopt_buildPointHierarchyBound(size_t vertex_count, size_t max_leaf_points)
+{
+	if (vertex_count == 0)
+		return 0;
+
+	// interior nodes at each depth contain more than max_leaf_points points each, and only depths 0..9 can have interior nodes
+	size_t max_interior = 10 * (vertex_count / (max_leaf_points + 1));
+
+	// each interior node has at most 8 children; leaf nodes partition the points so there are at most vertex_count of them
+	size_t max_leaves = max_interior * 8 + 1;
+	max_leaves = max_leaves < vertex_count ? max_leaves : vertex_count;
+
+	return max_interior + max_leaves;
+}
+
+size_t meshopt_buildPointHierarchy(meshopt_PointNode* nodes, unsigned int* destination, const float* vertex_positions_data, size_t vertex_count, size_t vertex_positions_stride, const float* vertex_colors, size_t vertex_colors_stride, float color_weight, size_t node_grid_size, size_t max_leaf_points, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+	assert(vertex_colors_stride == 0 || (vertex_colors_stride >= 12 && vertex_colors_stride <= 256));
+	assert(vertex_colors_stride % sizeof(float) == 0);
+	assert(vertex_colors == NULL || vertex_colors_stride != 0);
+	assert(node_grid_size >= 1 && node_grid_size <= 1024 && (node_grid_size & (node_grid_size - 1)) == 0);
+
+	if (vertex_count == 0)
+		return 0;
+
+	// large enough to amortize scheduling overhead, small enough to balance the work between threads
+	const size_t kTaskPoints = 16384;
+
+	meshopt_Allocator allocator;
+
+	Vector3* vertex_positions = allocator.allocate<Vector3>(vertex_count);
+	float extent = rescalePositions(vertex_positions, vertex_positions_data, vertex_count, vertex_positions_stride);
+
+	// sort points in Morton order so that every node covers a contiguous range of points
+	unsigned int* codes = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* order = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* codes_temp = allocator.allocate<unsigned int>(vertex_count);
+	unsigned int* order_temp = allocator.allocate<unsigned int>(vertex_count);
+
+	computeVertexCodes(codes, vertex_positions, vertex_count);
+
+	for (size_t i = 0; i < vertex_count; ++i)
 	{
-		assert(min_vertices < target_vertex_count);
-		assert(max_grid - min_grid > 1);
+		unsigned int c = codes[i];
+		codes[i] = (spreadBits3(c >> 20) << 2) | (spreadBits3(c >> 10) << 1) | spreadBits3(c);
+		order[i] = unsigned(i);
+	}
 
-		// we clamp the prediction of the grid size to make sure that the search converges
-		int grid_size = next_grid_size;
-		grid_size = (grid_size <= min_grid) ? min_grid + 1 : (grid_size >= max_grid ? max_grid - 1 : grid_size);
+	// 3 passes of 10-bit radix sort; the sort is stable so the results don't depend on the scheduler
+	for (int pass = 0; pass < 3; ++pass)
+	{
+		unsigned int hist[1024] = {};
 
-		computeVertexIds(vertex_ids, vertex_positions, vertex_count, grid_size);
-		size_t vertices = countVertexCells(table, table_size, vertex_ids, vertex_count);
+		for (size_t i = 0; i < vertex_count; ++i)
+			hist[(codes[i] >> (pass * 10)) & 1023]++;
 
-#if TRACE
-		printf("pass %d (%s): grid size %d, vertices %d, %s\n",
-		    pass, (pass == 0) ? "guess" : (pass <= kInterpolationPasses ? "lerp" : "binary"),
-		    grid_size, int(vertices),
-		    (vertices <= target_vertex_count) ? "under" : "over");
-#endif
+		unsigned int sum = 0;
 
-		float tip = interpolate(float(target_vertex_count), float(min_grid), float(min_vertices), float(grid_size), float(vertices), float(max_grid), float(max_vertices));
+		for (int i = 0; i < 1024; ++i)
+		{
+			unsigned int h = hist[i];
+			hist[i] = sum;
+			sum += h;
+		}
 
-		if (vertices <= target_vertex_count)
+		for (size_t i = 0; i < vertex_count; ++i)
 		{
-			min_grid = grid_size;
-			min_vertices = vertices;
+			unsigned int slot = hist[(codes[i] >> (pass * 10)) & 1023]++;
+
+			codes_temp[slot] = codes[i];
+			order_temp[slot] = order[i];
 		}
-		else
+
+		unsigned int* temp = codes;
+		codes = codes_temp;
+		codes_temp = temp;
+
+		temp = order;
+		order = order_temp;
+		order_temp = temp;
+	}
+
+	// positions in sorted order to make node sampling cache-friendly; original positions are no longer needed after this
+	Vector3* sorted_positions = allocator.allocate<Vector3>(vertex_count);
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		sorted_positions[i] = vertex_positions[order[i]];
+
+	// build the node structure breadth-first; it only depends on point counts, so it can be computed before sampling
+	size_t node_capacity = meshopt_buildPointHierarchyBound(vertex_count, max_leaf_points);
+	unsigned int* node_ranges = allocator.allocate<unsigned int>(node_capacity * 2);
+
+	unsigned int grid_bits = 0;
+	while ((size_t(1) << grid_bits) < node_grid_size)
+		grid_bits++;
+
+	memset(&nodes[0], 0, sizeof(meshopt_PointNode));
+	node_ranges[0] = 0;
+	node_ranges[1] = unsigned(vertex_count);
+
+	size_t node_count = 1;
+
+	for (size_t i = 0; i < node_count; ++i)
+	{
+		unsigned int begin = node_ranges[i * 2 + 0], end = node_ranges[i * 2 + 1];
+		unsigned int depth = nodes[i].depth;
+
+		unsigned int cell_depth = depth + grid_bits > 10 ? 10 : depth + grid_bits;
+		nodes[i].spacing = extent / float(1 << cell_depth);
+
+		if (end - begin <= max_leaf_points || depth == 10)
+			continue;
+
+		nodes[i].child_offset = unsigned(node_count);
+
+		// children are split by the next 3 bits of the Morton code
+		int shift = 3 * (9 - depth);
+
+		for (size_t child_begin = begin; child_begin < end;)
 		{
-			max_grid = grid_size;
-			max_vertices = vertices;
+			size_t child_end = upperBoundCode(codes, child_begin, end, codes[child_begin] >> shift, shift);
+
+			assert(node_count < node_capacity);
+			meshopt_PointNode& child = nodes[node_count];
+
+			memset(&child, 0, sizeof(meshopt_PointNode));
+			child.depth = depth + 1;
+
+			node_ranges[node_count * 2 + 0] = unsigned(child_begin);
+			node_ranges[node_count * 2 + 1] = unsigned(child_end);
+
+			node_count++;
+			nodes[i].child_count++;
+
+			child_begin = child_end;
 		}
+	}
 
-		if (vertices == target_vertex_count || max_grid - min_grid <= 1)
-			break;
+	// sample nodes top-down; nodes of the same depth cover disjoint point ranges, so they can be processed in parallel
+	unsigned int* owner = allocator.allocate<unsigned int>(vertex_count);
+	memset(owner, -1, vertex_count * sizeof(unsigned int));
+
+	PointHierarchy h = {};
+	h.nodes = nodes;
+	h.node_ranges = node_ranges;
+	h.codes = codes;
+	h.order = order;
+	h.positions = sorted_positions;
+	h.vertex_positions_data = vertex_positions_data;
+	h.vertex_positions_stride_float = vertex_positions_stride / sizeof(float);
+	h.vertex_colors = vertex_colors;
+	h.vertex_colors_stride_float = vertex_colors_stride / sizeof(float);
+	h.color_weight = color_weight;
+	h.grid_bits = grid_bits;
+	h.owner = owner;
+	h.task_points = kTaskPoints;
+
+	for (size_t level_begin = 0; level_begin < node_count;)
+	{
+		size_t level_end = level_begin + 1;
+		while (level_end < node_count && nodes[level_end].depth == nodes[level_begin].depth)
+			level_end++;
 
-		// we start by using interpolation search - it usually converges faster
-		// however, interpolation search has a worst case of O(N) so we switch to binary search after a few iterations which converges in O(logN)
-		next_grid_size = (pass < kInterpolationPasses) ? int(tip + 0.5f) : (min_grid + max_grid) / 2;
+		h.level_begin = level_begin;
+		h.level_end = level_end;
+
+		size_t level_points = node_ranges[level_end * 2 - 1] - node_ranges[level_begin * 2];
+		size_t task_count = (level_points + kTaskPoints - 1) / kTaskPoints;
+
+		meshopt_runTasks(scheduler, scheduler_context, samplePointNodesTask, &h, task_count);
+
+		level_begin = level_end;
 	}
 
-	if (min_vertices == 0)
-		return 0;
+	// propagate leaf bounds to ancestors; children are always stored after their parents
+	for (size_t i = node_count; i > 0; --i)
+	{
+		meshopt_PointNode& node = nodes[i - 1];
 
-	// build vertex->cell association by mapping all vertices with the same quantized position to the same cell
-	unsigned int* vertex_cells = allocator.allocate<unsigned int>(vertex_count);
+		if (node.child_count == 0)
+			continue;
 
-	computeVertexIds(vertex_ids, vertex_positions, vertex_count, min_grid);
-	size_t cell_count = fillVertexCells(table, table_size, vertex_cells, vertex_ids, vertex_count);
+		for (int k = 0; k < 3; ++k)
+		{
+			node.bounds_min[k] = FLT_MAX;
+			node.bounds_max[k] = -FLT_MAX;
+		}
 
-	// accumulate points into a reservoir for each target cell
-	Reservoir* cell_reservoirs = allocator.allocate<Reservoir>(cell_count);
-	memset(cell_reservoirs, 0, cell_count * sizeof(Reservoir));
+		for (size_t j = node.child_offset; j < node.child_offset + node.child_count; ++j)
+			for (int k = 0; k < 3; ++k)
+			{
+				node.bounds_min[k] = node.bounds_min[k] > nodes[j].bounds_min[k] ? nodes[j].bounds_min[k] : node.bounds_min[k];
+				node.bounds_max[k] = node.bounds_max[k] < nodes[j].bounds_max[k] ? nodes[j].bounds_max[k] : node.bounds_max[k];
+			}
+	}
 
-	fillCellReservoirs(cell_reservoirs, cell_count, vertex_positions, vertex_colors, vertex_colors_stride, vertex_count, vertex_cells);
+	// group points by node using a counting sort; points within each node stay in Morton order
+	for (size_t i = 0; i < vertex_count; ++i)
+		nodes[owner[i]].point_count++;
 
-	// for each target cell, find the vertex with the minimal error
-	unsigned int* cell_remap = allocator.allocate<unsigned int>(cell_count);
-	float* cell_errors = allocator.allocate<float>(cell_count);
+	unsigned int offset = 0;
 
-	// we scale the color weight to bring it to the same scale as position so that error addition makes sense
-	float color_weight_scaled = color_weight * (min_grid == 1 ? 1.f : 1.f / (min_grid - 1));
+	for (size_t i = 0; i < node_count; ++i)
+	{
+		nodes[i].point_offset = offset;
+		offset += nodes[i].point_count;
+	}
 
-	fillCellRemap(cell_remap, cell_errors, cell_count, vertex_cells, cell_reservoirs, vertex_positions, vertex_colors, vertex_colors_stride, color_weight_scaled * color_weight_scaled, vertex_count);
+	assert(offset == vertex_count);
 
-	// copy results to the output
-	assert(cell_count <= target_vertex_count);
-	memcpy(destination, cell_remap, sizeof(unsigned int) * cell_count);
+	for (size_t i = 0; i < node_count; ++i)
+		nodes[i].point_count = 0;
 
-#if TRACE
-	// compute error
-	float result_error = 0.f;
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		meshopt_PointNode& node = nodes[owner[i]];
 
-	for (size_t i = 0; i < cell_count; ++i)
-		result_error = result_error < cell_errors[i] ? cell_errors[i] : result_error;
+		destination[node.point_offset + node.point_count++] = order[i];
+	}
 
-	printf("result: %d cells, %e error\n", int(cell_count), sqrtf(result_error));
-#endif
+	return node_count;
+}
 
-	return cell_count;
+size_t meshopt_simplifyScratchBound(size_t index_count, size_t vertex_count, size_t attribute_count, unsigned int options)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(attribute_count <= kMaxAttributes);
+
+	size_t persistent = 0;
+	size_t transient = 0;
+
+	if (options & meshopt_SimplifySparse)
+	{
+		// sparse remap limits the working set to the vertices referenced by the index buffer
+		size_t unique = vertex_count < index_count ? vertex_count : index_count;
+
+		// filter is released before remap is allocated, and revremap is released after remap is filled
+		size_t filter = (vertex_count + 7) / 8;
+		size_t revremap = hashBuckets2(unique) * sizeof(unsigned int);
+
+		persistent += unique * sizeof(unsigned int);
+		transient = filter < revremap ? revremap : filter;
+
+		vertex_count = unique;
+	}
+
+	// adjacency
+	persistent += (vertex_count + 1) * sizeof(unsigned int);
+	persistent += index_count * ((options & meshopt_SimplifyLowMemory) ? sizeof(unsigned int) : sizeof(EdgeAdjacency::Edge));
+
+	// remap & wedge; position hash table is released after remap is built
+	persistent += vertex_count * sizeof(unsigned int) * 2;
+
+	size_t table = hashBuckets2(vertex_count) * sizeof(unsigned int);
+	transient = transient < table ? table : transient;
+
+	// vertex kind, loop & loopback
+	persistent += vertex_count * (sizeof(unsigned char) + sizeof(unsigned int) * 2);
+
+	// positions and attributes
+	persistent += vertex_count * sizeof(Vector3);
+	persistent += vertex_count * attribute_count * sizeof(float);
+
+	// quadrics
+	persistent += vertex_count * sizeof(Quadric);
+
+	if (attribute_count)
+		persistent += vertex_count * (sizeof(Quadric) + attribute_count * sizeof(QuadricGrad));
+
+	// collapses; note that boundEdgeCollapses never exceeds index_count + 3
+	persistent += (index_count + 3) * (sizeof(Collapse) + sizeof(unsigned int));
+	persistent += vertex_count * (sizeof(unsigned int) + sizeof(unsigned char));
+
+	return persistent + transient;
 }
 
 float meshopt_simplifyScale(const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride)
@@ -4,6 +4,224 @@
 #include <assert.h>
 #include <string.h>
 
+// The block below auto-detects SIMD ISA that can be used on the target platform
+#ifndef MESHOPTIMIZER_NO_SIMD
+
+// The SIMD implementation requires SSE2, which can be enabled unconditionally through compiler settings
+#if defined(__SSE2__)
+#define SIMD_SSE
+#endif
+
+// MSVC supports compiling SSE2 code regardless of compile options; we assume all 32-bit CPUs support SSE2
+#if !defined(SIMD_SSE) && defined(_MSC_VER) && !defined(__clang__) && (defined(_M_IX86) || defined(_M_X64))
+#define SIMD_SSE
+#endif
+
+#endif // !MESHOPTIMIZER_NO_SIMD
+
+#ifdef SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace meshopt
+{
+
+// FIFO caches are simulated in groups of this many profiles; each vertex stores timestamps for all FIFO profiles next to each other
+const size_t kVertexCacheLanes = 4;
+
+struct VertexCacheFifoState
+{
+	unsigned int timestamp[kVertexCacheLanes];
+	unsigned int cache_size[kVertexCacheLanes];
+	unsigned int warp_size[kVertexCacheLanes];
+	unsigned int primgroup_size[kVertexCacheLanes];
+	unsigned int warp_offset[kVertexCacheLanes];
+	unsigned int primgroup_offset[kVertexCacheLanes];
+	unsigned int vertices_transformed[kVertexCacheLanes];
+	unsigned int warps_executed[kVertexCacheLanes];
+};
+
+struct VertexCacheLruState
+{
+	unsigned int* cache;
+	unsigned int cache_count;
+	unsigned int cache_size;
+	unsigned int warp_size;
+	unsigned int primgroup_size;
+	unsigned int warp_offset;
+	unsigned int primgroup_offset;
+	unsigned int vertices_transformed;
+	unsigned int warps_executed;
+};
+
+#ifndef SIMD_SSE
+static void simulateFifo(VertexCacheFifoState& state, unsigned int* timestamps, unsigned int a, unsigned int b, unsigned int c)
+{
+	unsigned int* ta = timestamps + a * kVertexCacheLanes;
+	unsigned int* tb = timestamps + b * kVertexCacheLanes;
+	unsigned int* tc = timestamps + c * kVertexCacheLanes;
+
+	for (size_t k = 0; k < kVertexCacheLanes; ++k)
+	{
+		unsigned int misses = (state.timestamp[k] - ta[k] > state.cache_size[k]) + (state.timestamp[k] - tb[k] > state.cache_size[k]) + (state.timestamp[k] - tc[k] > state.cache_size[k]);
+
+		// flush cache if triangle doesn't fit into warp or into the primitive buffer; unlimited sizes are represented as ~0u
+		if (state.primgroup_offset[k] == state.primgroup_size[k] || state.warp_offset[k] + misses > state.warp_size[k])
+		{
+			state.warps_executed[k] += state.warp_offset[k] > 0;
+
+			state.warp_offset[k] = 0;
+			state.primgroup_offset[k] = 0;
+
+			// reset cache
+			state.timestamp[k] += state.cache_size[k] + 1;
+		}
+
+		// update cache and add vertices to warp; the vertices are processed in order as they may repeat
+		unsigned int* t[3] = {ta, tb, tc};
+
+		for (int j = 0; j < 3; ++j)
+			if (state.timestamp[k] - t[j][k] > state.cache_size[k])
+			{
+				t[j][k] = state.timestamp[k]++;
+				state.vertices_transformed[k]++;
+				state.warp_offset[k]++;
+			}
+
+		state.primgroup_offset[k]++;
+	}
+}
+#endif
+
+#ifdef SIMD_SSE
+static void simulateFifo(VertexCacheFifoState& state, unsigned int* timestamps, unsigned int a, unsigned int b, unsigned int c)
+{
+	// SSE2 only has signed comparisons; flipping the sign bit converts unsigned comparisons to signed ones
+	const __m128i bias = _mm_set1_epi32(int(0x80000000));
+
+	__m128i timestamp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.timestamp));
+	__m128i cache_size = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.cache_size));
+	__m128i warp_offset = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.warp_offset));
+	__m128i primgroup_offset = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.primgroup_offset));
+	__m128i vertices_transformed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.vertices_transformed));
+
+	__m128i cache_size_biased = _mm_xor_si128(cache_size, bias);
+
+	__m128i* ta = reinterpret_cast<__m128i*>(timestamps + a * kVertexCacheLanes);
+	__m128i* tb = reinterpret_cast<__m128i*>(timestamps + b * kVertexCacheLanes);
+	__m128i* tc = reinterpret_cast<__m128i*>(timestamps + c * kVertexCacheLanes);
+
+	// miss masks are -1 for each lane that misses, so subtracting them counts misses
+	__m128i ma = _mm_cmpgt_epi32(_mm_xor_si128(_mm_sub_epi32(timestamp, _mm_loadu_si128(ta)), bias), cache_size_biased);
+	__m128i mb = _mm_cmpgt_epi32(_mm_xor_si128(_mm_sub_epi32(timestamp, _mm_loadu_si128(tb)), bias), cache_size_biased);
+	__m128i mc = _mm_cmpgt_epi32(_mm_xor_si128(_mm_sub_epi32(timestamp, _mm_loadu_si128(tc)), bias), cache_size_biased);
+
+	__m128i misses = _mm_sub_epi32(_mm_sub_epi32(_mm_setzero_si128(), ma), _mm_add_epi32(mb, mc));
+
+	// flush cache if triangle doesn't fit into warp or into the primitive buffer; unlimited sizes are represented as ~0u
+	__m128i warp_size = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.warp_size));
+	__m128i primgroup_size = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.primgroup_size));
+
+	__m128i flush_prim = _mm_cmpeq_epi32(primgroup_offset, primgroup_size);
+	__m128i flush_warp = _mm_cmpgt_epi32(_mm_xor_si128(_mm_add_epi32(warp_offset, misses), bias), _mm_xor_si128(warp_size, bias));
+	__m128i flush = _mm_or_si128(flush_prim, flush_warp);
+
+	if (_mm_movemask_epi8(flush))
+	{
+		__m128i warps_executed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.warps_executed));
+		__m128i warp_active = _mm_andnot_si128(_mm_cmpeq_epi32(warp_offset, _mm_setzero_si128()), flush);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state.warps_executed), _mm_sub_epi32(warps_executed, warp_active));
+
+		warp_offset = _mm_andnot_si128(flush, warp_offset);
+		primgroup_offset = _mm_andnot_si128(flush, primgroup_offset);
+
+		// reset cache
+		timestamp = _mm_add_epi32(timestamp, _mm_and_si128(flush, _mm_add_epi32(cache_size, _mm_set1_epi32(1))));
+	}
+
+	// update cache and add vertices to warp; the vertices are processed in order as they may repeat
+	__m128i* t[3] = {ta, tb, tc};
+
+	for (int j = 0; j < 3; ++j)
+	{
+		__m128i ts = _mm_loadu_si128(t[j]);
+		__m128i miss = _mm_cmpgt_epi32(_mm_xor_si128(_mm_sub_epi32(timestamp, ts), bias), cache_size_biased);
+
+		_mm_storeu_si128(t[j], _mm_or_si128(_mm_and_si128(miss, timestamp), _mm_andnot_si128(miss, ts)));
+
+		timestamp = _mm_sub_epi32(timestamp, miss);
+		vertices_transformed = _mm_sub_epi32(vertices_transformed, miss);
+		warp_offset = _mm_sub_epi32(warp_offset, miss);
+	}
+
+	primgroup_offset = _mm_add_epi32(primgroup_offset, _mm_set1_epi32(1));
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state.timestamp), timestamp);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state.warp_offset), warp_offset);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state.primgroup_offset), primgroup_offset);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state.vertices_transformed), vertices_transformed);
+}
+#endif
+
+static unsigned int findLruEntry(const VertexCacheLruState& state, unsigned int index)
+{
+	for (unsigned int i = 0; i < state.cache_count; ++i)
+		if (state.cache[i] == index)
+			return i;
+
+	return ~0u;
+}
+
+static void simulateLru(VertexCacheLruState& state, const unsigned int* indices)
+{
+	unsigned int misses = (findLruEntry(state, indices[0]) == ~0u) + (findLruEntry(state, indices[1]) == ~0u) + (findLruEntry(state, indices[2]) == ~0u);
+
+	// flush cache if triangle doesn't fit into warp or into the primitive buffer; unlimited sizes are represented as ~0u
+	if (state.primgroup_offset == state.primgroup_size || state.warp_offset + misses > state.warp_size)
+	{
+		state.warps_executed += state.warp_offset > 0;
+
+		state.warp_offset = 0;
+		state.primgroup_offset = 0;
+		state.cache_count = 0;
+	}
+
+	// most recently used vertices are stored first
+	for (int j = 0; j < 3; ++j)
+	{
+		unsigned int index = indices[j];
+		unsigned int position = findLruEntry(state, index);
+
+		if (position == ~0u)
+		{
+			position = state.cache_count < state.cache_size ? state.cache_count++ : state.cache_size - 1;
+
+			state.vertices_transformed++;
+			state.warp_offset++;
+		}
+
+		memmove(state.cache + 1, state.cache, position * sizeof(unsigned int));
+		state.cache[0] = index;
+	}
+
+	state.primgroup_offset++;
+}
+
+static meshopt_VertexCacheStatistics getVertexCacheStatistics(unsigned int vertices_transformed, unsigned int warps_executed, size_t index_count, size_t unique_vertex_count)
+{
+	meshopt_VertexCacheStatistics result = {};
+
+	result.vertices_transformed = vertices_transformed;
+	result.warps_executed = warps_executed;
+	result.acmr = index_count == 0 ? 0 : float(vertices_transformed) / float(index_count / 3);
+	result.atvr = unique_vertex_count == 0 ? 0 : float(vertices_transformed) / float(unique_vertex_count);
+
+	return result;
+}
+
+} // namespace meshopt
+
 meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size, unsigned int warp_size, unsigned int primgroup_size)
 {
 	assert(index_count % 3 == 0);
@@ -71,3 +289,134 @@ meshopt_VertexCacheStatistics meshopt_analyzeVertexCache(const unsigned int* ind
 
 	return result;
 }
+
+void meshopt_analyzeVertexCacheMulti(meshopt_VertexCacheStatistics* results, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt_VertexCacheProfile* profiles, size_t profile_count)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+
+	meshopt_Allocator allocator;
+
+	size_t fifo_count = 0;
+	size_t lru_count = 0;
+	size_t lru_entries = 0;
+
+	for (size_t i = 0; i < profile_count; ++i)
+	{
+		assert(profiles[i].cache_size >= 3);
+		assert(profiles[i].warp_size == 0 || profiles[i].warp_size >= 3);
+		assert(profiles[i].replacement == meshopt_VertexCacheFifo || profiles[i].replacement == meshopt_VertexCacheLru);
+
+		if (profiles[i].replacement == meshopt_VertexCacheLru)
+			lru_count++, lru_entries += profiles[i].cache_size;
+		else
+			fifo_count++;
+	}
+
+	// FIFO profiles are simulated in groups; unused lanes of the last group simulate a dummy cache
+	size_t group_count = (fifo_count + kVertexCacheLanes - 1) / kVertexCacheLanes;
+
+	VertexCacheFifoState* fifo = allocator.allocate<VertexCacheFifoState>(group_count);
+	memset(fifo, 0, group_count * sizeof(VertexCacheFifoState));
+
+	VertexCacheLruState* lru = allocator.allocate<VertexCacheLruState>(lru_count);
+	memset(lru, 0, lru_count * sizeof(VertexCacheLruState));
+
+	unsigned int* lru_cache = allocator.allocate<unsigned int>(lru_entries);
+
+	for (size_t i = 0, fifo_offset = 0, lru_offset = 0, lru_cache_offset = 0; i < profile_count; ++i)
+	{
+		const meshopt_VertexCacheProfile& profile = profiles[i];
+
+		unsigned int warp_size = profile.warp_size ? profile.warp_size : ~0u;
+		unsigned int primgroup_size = profile.primgroup_size ? profile.primgroup_size : ~0u;
+
+		if (profile.replacement == meshopt_VertexCacheLru)
+		{
+			VertexCacheLruState& state = lru[lru_offset++];
+
+			state.cache = lru_cache + lru_cache_offset;
+			state.cache_size = profile.cache_size;
+			state.warp_size = warp_size;
+			state.primgroup_size = primgroup_size;
+
+			lru_cache_offset += profile.cache_size;
+		}
+		else
+		{
+			VertexCacheFifoState& state = fifo[fifo_offset / kVertexCacheLanes];
+			size_t lane = fifo_offset % kVertexCacheLanes;
+
+			state.cache_size[lane] = profile.cache_size;
+			state.warp_size[lane] = warp_size;
+			state.primgroup_size[lane] = primgroup_size;
+
+			fifo_offset++;
+		}
+	}
+
+	for (size_t i = fifo_count; i < group_count * kVertexCacheLanes; ++i)
+	{
+		VertexCacheFifoState& state = fifo[i / kVertexCacheLanes];
+		size_t lane = i % kVertexCacheLanes;
+
+		state.cache_size[lane] = 3;
+		state.warp_size[lane] = ~0u;
+		state.primgroup_size[lane] = ~0u;
+	}
+
+	for (size_t i = 0; i < group_count * kVertexCacheLanes; ++i)
+		fifo[i / kVertexCacheLanes].timestamp[i % kVertexCacheLanes] = fifo[i / kVertexCacheLanes].cache_size[i % kVertexCacheLanes] + 1;
+
+	// timestamps for each group are stored separately; within a group, all lanes of a vertex share one 16-byte block
+	unsigned int* timestamps = allocator.allocate<unsigned int>(group_count * vertex_count * kVertexCacheLanes);
+	memset(timestamps, 0, group_count * vertex_count * kVertexCacheLanes * sizeof(unsigned int));
+
+	unsigned char* seen = allocator.allocate<unsigned char>(vertex_count);
+	memset(seen, 0, vertex_count);
+
+	for (size_t i = 0; i < index_count; i += 3)
+	{
+		unsigned int a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+		assert(a < vertex_count && b < vertex_count && c < vertex_count);
+
+		seen[a] = seen[b] = seen[c] = 1;
+
+		for (size_t g = 0; g < group_count; ++g)
+		{
+			unsigned int* group_timestamps = timestamps + g * vertex_count * kVertexCacheLanes;
+
+			simulateFifo(fifo[g], group_timestamps, a, b, c);
+		}
+
+		for (size_t l = 0; l < lru_count; ++l)
+			simulateLru(lru[l], &indices[i]);
+	}
+
+	size_t unique_vertex_count = 0;
+
+	for (size_t i = 0; i < vertex_count; ++i)
+		unique_vertex_count += seen[i];
+
+	for (size_t i = 0, fifo_offset = 0, lru_offset = 0; i < profile_count; ++i)
+	{
+		if (profiles[i].replacement == meshopt_VertexCacheLru)
+		{
+			const VertexCacheLruState& state = lru[lru_offset++];
+
+			results[i] = getVertexCacheStatistics(state.vertices_transformed, state.warps_executed + (state.warp_offset > 0), index_count, unique_vertex_count);
+		}
+		else
+		{
+			const VertexCacheFifoState& state = fifo[fifo_offset / kVertexCacheLanes];
+			size_t lane = fifo_offset % kVertexCacheLanes;
+
+			results[i] = getVertexCacheStatistics(state.vertices_transformed[lane], state.warps_executed[lane] + (state.warp_offset[lane] > 0), index_count, unique_vertex_count);
+
+			fifo_offset++;
+		}
+	}
+}
+
+#undef SIMD_SSE
@@ -13,6 +13,9 @@ namespace meshopt
 const size_t kCacheSizeMax = 16;
 const size_t kValenceMax = 8;
 
+// Parallel optimization splits the mesh into spatially coherent regions of roughly this many triangles
+const size_t kVertexCacheRegionTriangles = 65536;
+
 struct VertexScoreTable
 {
 	float cache[1 + kCacheSizeMax];
@@ -38,15 +41,10 @@ struct TriangleAdjacency
 	unsigned int* data;
 };
 
-static void buildTriangleAdjacency(TriangleAdjacency& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count, meshopt_Allocator& allocator)
+static void fillTriangleAdjacency(TriangleAdjacency& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count)
 {
 	size_t face_count = index_count / 3;
 
-	// allocate arrays
-	adjacency.counts = allocator.allocate<unsigned int>(vertex_count);
-	adjacency.offsets = allocator.allocate<unsigned int>(vertex_count);
-	adjacency.data = allocator.allocate<unsigned int>(index_count);
-
 	// fill triangle counts
 	memset(adjacency.counts, 0, vertex_count * sizeof(unsigned int));
 
@@ -87,6 +85,16 @@ static void buildTriangleAdjacency(TriangleAdjacency& adjacency, const unsigned
 	}
 }
 
+static void buildTriangleAdjacency(TriangleAdjacency& adjacency, const unsigned int* indices, size_t index_count, size_t vertex_count, meshopt_Allocator& allocator)
+{
+	// allocate arrays
+	adjacency.counts = allocator.allocate<unsigned int>(vertex_count);
+	adjacency.offsets = allocator.allocate<unsigned int>(vertex_count);
+	adjacency.data = allocator.allocate<unsigned int>(index_count);
+
+	fillTriangleAdjacency(adjacency, indices, index_count, vertex_count);
+}
+
 static unsigned int getNextVertexDeadEnd(const unsigned int* dead_end, unsigned int& dead_end_top, unsigned int& input_cursor, const unsigned int* live_triangles, size_t vertex_count)
 {
 	// check dead-end stack
@@ -164,52 +172,41 @@ static unsigned int getNextTriangleDeadEnd(unsigned int& input_cursor, const uns
 	return ~0u;
 }
 
-} // namespace meshopt
-
-void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt::VertexScoreTable* table)
+// scratch memory is provided by the caller so that parallel optimization can allocate it for all regions upfront
+struct VertexCacheScratch
 {
-	using namespace meshopt;
-
-	assert(index_count % 3 == 0);
-
-	meshopt_Allocator allocator;
-
-	// guard for empty meshes
-	if (index_count == 0 || vertex_count == 0)
-		return;
-
-	// support in-place optimization
-	if (destination == indices)
-	{
-		unsigned int* indices_copy = allocator.allocate<unsigned int>(index_count);
-		memcpy(indices_copy, indices, index_count * sizeof(unsigned int));
-		indices = indices_copy;
-	}
+	TriangleAdjacency adjacency;
+	unsigned char* emitted_flags;
+	float* vertex_scores;
+	float* triangle_scores;
+};
 
+static void optimizeVertexCacheScratch(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const VertexScoreTable* table, const VertexCacheScratch& scratch)
+{
 	unsigned int cache_size = 16;
 	assert(cache_size <= kCacheSizeMax);
 
 	size_t face_count = index_count / 3;
 
 	// build adjacency information
-	TriangleAdjacency adjacency = {};
-	buildTriangleAdjacency(adjacency, indices, index_count, vertex_count, allocator);
+	TriangleAdjacency adjacency = scratch.adjacency;
+	fillTriangleAdjacency(adjacency, indices, index_count, vertex_count);
 
 	// live triangle counts; note, we alias adjacency.counts as we remove triangles after emitting them so the counts always match
 	unsigned int* live_triangles = adjacency.counts;
 
 	// emitted flags
-	unsigned char* emitted_flags = allocator.allocate<unsigned char>(face_count);
+	unsigned char* emitted_flags = scratch.emitted_flags;
 	memset(emitted_flags, 0, face_count);
 
 	// compute initial vertex scores
-	float* vertex_scores = allocator.allocate<float>(vertex_count);
+	float* vertex_scores = scratch.vertex_scores;
 
 	for (size_t i = 0; i < vertex_count; ++i)
 		vertex_scores[i] = vertexScore(table, -1, live_triangles[i]);
 
 	// compute triangle scores
-	float* triangle_scores = allocator.allocate<float>(face_count);
+	float* triangle_scores = scratch.triangle_scores;
 
 	for (size_t i = 0; i < face_count; ++i)
 	{
@@ -342,6 +339,77 @@ void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned
 	assert(output_triangle == face_count);
 }
 
+struct VertexCacheRegions
+{
+	unsigned int* destination;
+	const unsigned int* local_indices;
+	const unsigned int* local_vertices;
+	const size_t* region_triangles;
+	const size_t* region_vertices;
+
+	// scratch arrays for all regions; each region uses the slices that correspond to its triangle and vertex ranges
+	VertexCacheScratch scratch;
+};
+
+static void optimizeVertexCacheRegionTask(void* context, size_t index)
+{
+	const VertexCacheRegions& r = *static_cast<const VertexCacheRegions*>(context);
+
+	size_t triangle_offset = r.region_triangles[index];
+	size_t index_count = (r.region_triangles[index + 1] - triangle_offset) * 3;
+	size_t vertex_offset = r.region_vertices[index];
+	size_t vertex_count = r.region_vertices[index + 1] - vertex_offset;
+
+	unsigned int* result = r.destination + triangle_offset * 3;
+
+	VertexCacheScratch scratch = {};
+	scratch.adjacency.counts = r.scratch.adjacency.counts + vertex_offset;
+	scratch.adjacency.offsets = r.scratch.adjacency.offsets + vertex_offset;
+	scratch.adjacency.data = r.scratch.adjacency.data + triangle_offset * 3;
+	scratch.emitted_flags = r.scratch.emitted_flags + triangle_offset;
+	scratch.vertex_scores = r.scratch.vertex_scores + vertex_offset;
+	scratch.triangle_scores = r.scratch.triangle_scores + triangle_offset;
+
+	optimizeVertexCacheScratch(result, r.local_indices + triangle_offset * 3, index_count, vertex_count, &kVertexScoreTable, scratch);
+
+	// convert region-local vertex indices back to mesh vertices
+	for (size_t i = 0; i < index_count; ++i)
+		result[i] = r.local_vertices[vertex_offset + result[i]];
+}
+
+} // namespace meshopt
+
+void meshopt_optimizeVertexCacheTable(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, const meshopt::VertexScoreTable* table)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+
+	meshopt_Allocator allocator;
+
+	// guard for empty meshes
+	if (index_count == 0 || vertex_count == 0)
+		return;
+
+	// support in-place optimization
+	if (destination == indices)
+	{
+		unsigned int* indices_copy = allocator.allocate<unsigned int>(index_count);
+		memcpy(indices_copy, indices, index_count * sizeof(unsigned int));
+		indices = indices_copy;
+	}
+
+	VertexCacheScratch scratch = {};
+	scratch.adjacency.counts = allocator.allocate<unsigned int>(vertex_count);
+	scratch.adjacency.offsets = allocator.allocate<unsigned int>(vertex_count);
+	scratch.adjacency.data = allocator.allocate<unsigned int>(index_count);
+	scratch.emitted_flags = allocator.allocate<unsigned char>(index_count / 3);
+	scratch.vertex_scores = allocator.allocate<float>(vertex_count);
+	scratch.triangle_scores = allocator.allocate<float>(index_count / 3);
+
+	optimizeVertexCacheScratch(destination, indices, index_count, vertex_count, table, scratch);
+}
+
 void meshopt_optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count)
 {
 	meshopt_optimizeVertexCacheTable(destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTable);
@@ -352,6 +420,90 @@ void meshopt_optimizeVertexCacheStrip(unsigned int* destination, const unsigned
 	meshopt_optimizeVertexCacheTable(destination, indices, index_count, vertex_count, &meshopt::kVertexScoreTableStrip);
 }
 
+void meshopt_optimizeVertexCacheParallel(unsigned int* destination, const unsigned int* indices, size_t index_count, const float* vertex_positions, size_t vertex_count, size_t vertex_positions_stride, meshopt_TaskScheduler scheduler, void* scheduler_context)
+{
+	using namespace meshopt;
+
+	assert(index_count % 3 == 0);
+	assert(vertex_positions_stride >= 12 && vertex_positions_stride <= 256);
+	assert(vertex_positions_stride % sizeof(float) == 0);
+
+	size_t face_count = index_count / 3;
+	size_t region_count = (face_count + kVertexCacheRegionTriangles - 1) / kVertexCacheRegionTriangles;
+
+	// small meshes are optimized as a whole, which produces the same result as the serial optimizer
+	if (region_count <= 1)
+	{
+		meshopt_optimizeVertexCache(destination, indices, index_count, vertex_count);
+		return;
+	}
+
+	meshopt_Allocator allocator;
+
+	// sort triangles along a space-filling curve so that consecutive triangle ranges form spatially coherent regions
+	// this also makes a copy of the input, which supports in-place optimization
+	unsigned int* local_indices = allocator.allocate<unsigned int>(index_count);
+	meshopt_spatialSortTriangles(local_indices, indices, index_count, vertex_positions, vertex_count, vertex_positions_stride);
+
+	// remap each region to a compact range of local vertices so that per-region memory is proportional to region size
+	unsigned int* local_vertices = allocator.allocate<unsigned int>(index_count);
+
+	unsigned int* vertex_region = allocator.allocate<unsigned int>(vertex_count);
+	memset(vertex_region, -1, vertex_count * sizeof(unsigned int));
+
+	unsigned int* vertex_local = allocator.allocate<unsigned int>(vertex_count);
+
+	size_t* region_triangles = allocator.allocate<size_t>(region_count + 1);
+	size_t* region_vertices = allocator.allocate<size_t>(region_count + 1);
+
+	size_t local_offset = 0;
+
+	for (size_t r = 0; r < region_count; ++r)
+	{
+		size_t begin = face_count * r / region_count;
+		size_t end = face_count * (r + 1) / region_count;
+
+		region_triangles[r] = begin;
+		region_vertices[r] = local_offset;
+
+		for (size_t i = begin * 3; i < end * 3; ++i)
+		{
+			unsigned int v = local_indices[i];
+			assert(v < vertex_count);
+
+			if (vertex_region[v] != r)
+			{
+				vertex_region[v] = unsigned(r);
+				vertex_local[v] = unsigned(local_offset - region_vertices[r]);
+				local_vertices[local_offset++] = v;
+			}
+
+			local_indices[i] = vertex_local[v];
+		}
+	}
+
+	region_triangles[region_count] = face_count;
+	region_vertices[region_count] = local_offset;
+
+	// regions follow the space-filling curve, so each region starts close to where the previous one ended
+	VertexCacheRegions regions = {};
+	regions.destination = destination;
+	regions.local_indices = local_indices;
+	regions.local_vertices = local_vertices;
+	regions.region_triangles = region_triangles;
+	regions.region_vertices = region_vertices;
+
+	// tasks don't allocate memory, so scratch for all regions is allocated upfront
+	regions.scratch.adjacency.counts = allocator.allocate<unsigned int>(local_offset);
+	regions.scratch.adjacency.offsets = allocator.allocate<unsigned int>(local_offset);
+	regions.scratch.adjacency.data = allocator.allocate<unsigned int>(index_count);
+	regions.scratch.emitted_flags = allocator.allocate<unsigned char>(face_count);
+	regions.scratch.vertex_scores = allocator.allocate<float>(local_offset);
+	regions.scratch.triangle_scores = allocator.allocate<float>(face_count);
+
+	meshopt_runTasks(scheduler, scheduler_context, optimizeVertexCacheRegionTask, &regions, region_count);
+}
+
 void meshopt_optimizeVertexCacheFifo(unsigned int* destination, const unsigned int* indices, size_t index_count, size_t vertex_count, unsigned int cache_size)
 {
 	using namespace meshopt;
@@ -65,16 +65,31 @@ uint32_t pcg32_random_r(pcg32_random_t* rng)
 	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
 }
 
-pcg32_random_t rngstate = PCG32_INITIALIZER;
+void pcg32_srandom_r(pcg32_random_t* rng, uint64_t initstate, uint64_t initseq)
+{
+	rng->state = 0U;
+	rng->inc = (initseq << 1u) | 1u;
+	pcg32_random_r(rng);
+	rng->state += initstate;
+	pcg32_random_r(rng);
+}
+
+// each individual gets its own random stream derived from generation and index, so results don't depend on scheduling or thread count
+pcg32_random_t individual_rng(size_t generation, size_t index)
+{
+	pcg32_random_t rng = PCG32_INITIALIZER;
+	pcg32_srandom_r(&rng, rng.state ^ generation, index);
+	return rng;
+}
 
-float rand01()
+float rand01(pcg32_random_t& rng)
 {
-	return pcg32_random_r(&rngstate) / float(1ull << 32);
+	return pcg32_random_r(&rng) / float(1ull << 32);
 }
 
-uint32_t rand32()
+uint32_t rand32(pcg32_random_t& rng)
 {
-	return pcg32_random_r(&rngstate);
+	return pcg32_random_r(&rng);
 }
 
 struct State
@@ -232,12 +247,28 @@ void compute_metric(const State* state, const Mesh& mesh, float result[Profile_C
 		}
 	}
 
+	// simulate all cache profiles in one pass over the index buffer
+	meshopt_VertexCacheProfile cache_profiles[Profile_Count];
+	meshopt_VertexCacheStatistics cache_stats[Profile_Count];
+	size_t cache_profile_count = 0;
+
 	for (int profile = 0; profile < Profile_Count; ++profile)
 	{
 		if (profiles[profile].cache)
 		{
-			meshopt_VertexCacheStatistics stats = meshopt_analyzeVertexCache(&indices[0], indices.size(), mesh.vertex_count, profiles[profile].cache, profiles[profile].warp, profiles[profile].triangle);
-			result[profile] = stats.atvr;
+			meshopt_VertexCacheProfile cp = {unsigned(profiles[profile].cache), unsigned(profiles[profile].warp), unsigned(profiles[profile].triangle), meshopt_VertexCacheFifo};
+			cache_profiles[cache_profile_count++] = cp;
+		}
+	}
+
+	if (cache_profile_count)
+		meshopt_analyzeVertexCacheMulti(cache_stats, &indices[0], indices.size(), mesh.vertex_count, cache_profiles, cache_profile_count);
+
+	for (int profile = 0, cache_profile = 0; profile < Profile_Count; ++profile)
+	{
+		if (profiles[profile].cache)
+		{
+			result[profile] = cache_stats[cache_profile++].atvr;
 		}
 		else
 		{
@@ -249,19 +280,18 @@ void compute_metric(const State* state, const Mesh& mesh, float result[Profile_C
 	}
 }
 
-float fitness_score(const State& state, const std::vector<Mesh>& meshes)
+float fitness_score(const float* metrics, const std::vector<Mesh>& meshes)
 {
 	float result = 0;
 	float count = 0;
 
-	for (auto& mesh : meshes)
+	for (size_t i = 0; i < meshes.size(); ++i)
 	{
-		float metric[Profile_Count];
-		compute_metric(&state, mesh, metric);
+		const float* metric = &metrics[i * Profile_Count];
 
 		for (int profile = 0; profile < Profile_Count; ++profile)
 		{
-			result += mesh.metric_base[profile] / metric[profile] * profiles[profile].weight;
+			result += meshes[i].metric_base[profile] / metric[profile] * profiles[profile].weight;
 			count += profiles[profile].weight;
 		}
 	}
@@ -269,51 +299,72 @@ float fitness_score(const State& state, const std::vector<Mesh>& meshes)
 	return result / count;
 }
 
+void evaluate(std::vector<State>& states, const std::vector<Mesh>& meshes)
+{
+	size_t pair_count = states.size() * meshes.size();
+	std::vector<float> metrics(pair_count * Profile_Count);
+
+	// every (state, mesh) pair is a separate work item; mesh sizes vary a lot, so items are distributed dynamically
+	#pragma omp parallel for schedule(dynamic)
+	for (size_t i = 0; i < pair_count; ++i)
+	{
+		compute_metric(&states[i / meshes.size()], meshes[i % meshes.size()], &metrics[i * Profile_Count]);
+	}
+
+	// fitness is accumulated in a fixed order so that it doesn't depend on thread count
+	for (size_t i = 0; i < states.size(); ++i)
+		states[i].fitness = fitness_score(&metrics[i * meshes.size() * Profile_Count], meshes);
+}
+
 std::vector<State> gen0(size_t count, const std::vector<Mesh>& meshes)
 {
 	std::vector<State> result;
 
 	for (size_t i = 0; i < count; ++i)
 	{
+		pcg32_random_t rng = individual_rng(0, i);
+
 		State state = {};
 
 		for (int j = 0; j < kCacheSizeMax; ++j)
-			state.cache[j] = rand01();
+			state.cache[j] = rand01(rng);
 
 		for (int j = 0; j < kValenceMax; ++j)
-			state.live[j] = rand01();
-
-		state.fitness = fitness_score(state, meshes);
+			state.live[j] = rand01(rng);
 
 		result.push_back(state);
 	}
 
+	evaluate(result, meshes);
+
 	return result;
 }
 
 // https://en.wikipedia.org/wiki/Differential_evolution
 // Good Parameters for Differential Evolution. Magnus Erik Hvass Pedersen, 2010
-std::pair<State, float> genN(std::vector<State>& seed, const std::vector<Mesh>& meshes, float crossover = 0.8803f, float weight = 0.4717f)
+std::pair<State, float> genN(std::vector<State>& seed, const std::vector<Mesh>& meshes, size_t generation, float crossover = 0.8803f, float weight = 0.4717f)
 {
 	std::vector<State> result(seed.size());
 
 	for (size_t i = 0; i < seed.size(); ++i)
 	{
+		pcg32_random_t rng = individual_rng(generation, i);
+
 		for (;;)
 		{
-			int a = rand32() % seed.size();
-			int b = rand32() % seed.size();
-			int c = rand32() % seed.size();
+			int a = rand32(rng) % seed.size();
+			int b = rand32(rng) % seed.size();
+			int c = rand32(rng) % seed.size();
 
 			if (a == b || a == c || b == c || a == int(i) || b == int(i) || c == int(i))
 				continue;
 
-			int rc = rand32() % kCacheSizeMax;
-			int rl = rand32() % kValenceMax;
+			int rc = rand32(rng) % kCacheSizeMax;
+			int rl = rand32(rng) % kValenceMax;
 
 			for (int j = 0; j < kCacheSizeMax; ++j)
 			{
-				float r = rand01();
+				float r = rand01(rng);
 
 				if (r < crossover || j == rc)
 					result[i].cache[j] = std::max(0.f, std::min(1.f, seed[a].cache[j] + weight * (seed[b].cache[j] - seed[c].cache[j])));
@@ -323,7 +374,7 @@ std::pair<State, float> genN(std::vector<State>& seed, const std::vector<Mesh>&
 
 			for (int j = 0; j < kValenceMax; ++j)
 			{
-				float r = rand01();
+				float r = rand01(rng);
 
 				if (r < crossover || j == rl)
 					result[i].live[j] = std::max(0.f, std::min(1.f, seed[a].live[j] + weight * (seed[b].live[j] - seed[c].live[j])));
@@ -335,11 +386,7 @@ std::pair<State, float> genN(std::vector<State>& seed, const std::vector<Mesh>&
 		}
 	}
 
-	#pragma omp parallel for
-	for (size_t i = 0; i < seed.size(); ++i)
-	{
-		result[i].fitness = fitness_score(result[i], meshes);
-	}
+	evaluate(result, meshes);
 
 	State best = {};
 	float bestfit = 0;
@@ -359,12 +406,32 @@ std::pair<State, float> genN(std::vector<State>& seed, const std::vector<Mesh>&
 	return std::make_pair(best, bestfit);
 }
 
-bool load_state(const char* path, std::vector<State>& result)
+// checkpoints start with a header that stores the generation, which determines random streams for the next generation
+const uint32_t kStateMagic = 0x31544356; // VCT1
+
+struct StateHeader
+{
+	uint32_t magic;
+	uint32_t generation;
+};
+
+bool load_state(const char* path, std::vector<State>& result, size_t& generation)
 {
 	FILE* file = fopen(path, "rb");
 	if (!file)
 		return false;
 
+	StateHeader header = {};
+
+	// files without a header only contain state vectors
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != kStateMagic)
+	{
+		header.generation = 0;
+		fseek(file, 0, SEEK_SET);
+	}
+
+	generation = header.generation;
+
 	State state;
 
 	result.clear();
@@ -377,12 +444,20 @@ bool load_state(const char* path, std::vector<State>& result)
 	return true;
 }
 
-bool save_state(const char* path, const std::vector<State>& result)
+bool save_state(const char* path, const std::vector<State>& result, size_t generation)
 {
 	FILE* file = fopen(path, "wb");
 	if (!file)
 		return false;
 
+	StateHeader header = {kStateMagic, uint32_t(generation)};
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1)
+	{
+		fclose(file);
+		return false;
+	}
+
 	for (auto& state : result)
 	{
 		if (fwrite(&state, sizeof(State), 1, file) != 1)
@@ -395,6 +470,31 @@ bool save_state(const char* path, const std::vector<State>& result)
 	return fclose(file) == 0;
 }
 
+bool save_table(const char* path, const State& state, size_t generation, float fitness)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+		return false;
+
+	// the output matches the layout of score tables in src/vcacheoptimizer.cpp; first entries are reserved for vertices that are not in cache or have no live triangles
+	fprintf(file, "// Generated by vcachetuner: generation %d, fitness %f\n", int(generation), fitness);
+	fprintf(file, "static const VertexScoreTable kVertexScoreTable = {\n");
+
+	fprintf(file, "    {0.f");
+	for (int i = 0; i < kCacheSizeMax; ++i)
+		fprintf(file, ", %.3ff", state.cache[i]);
+	fprintf(file, "},\n");
+
+	fprintf(file, "    {0.f");
+	for (int i = 0; i < kValenceMax; ++i)
+		fprintf(file, ", %.3ff", state.live[i]);
+	fprintf(file, "},\n");
+
+	fprintf(file, "};\n");
+
+	return fclose(file) == 0;
+}
+
 void dump_state(const State& state)
 {
 	printf("cache:");
@@ -459,9 +559,12 @@ int main(int argc, char** argv)
 	std::vector<State> pop;
 	size_t gen = 0;
 
-	if (load_state("mutator.state", pop))
+	if (load_state("mutator.state", pop, gen))
 	{
-		printf("Loaded %d state vectors\n", int(pop.size()));
+		printf("Loaded %d state vectors, resuming from generation %d\n", int(pop.size()), int(gen));
+
+		// fitness depends on the mesh set, which may have changed since the checkpoint was saved
+		evaluate(pop, meshes);
 	}
 	else
 	{
@@ -472,7 +575,7 @@ int main(int argc, char** argv)
 
 	for (;;)
 	{
-		auto best = genN(pop, meshes);
+		auto best = genN(pop, meshes, gen + 1);
 		gen++;
 
 		if (gen % 10 == 0)
@@ -487,12 +590,17 @@ int main(int argc, char** argv)
 
 		dump_state(best.first);
 
-		if (save_state("mutator.state-temp", pop) && rename("mutator.state-temp", "mutator.state") == 0)
+		if (save_state("mutator.state-temp", pop, gen) && rename("mutator.state-temp", "mutator.state") == 0)
 		{
 		}
 		else
 		{
 			printf("ERROR: Can't save state\n");
 		}
+
+		if (!save_table("mutator.h", best.first, gen, best.second))
+		{
+			printf("ERROR: Can't save score table\n");
+		}
 	}
 }